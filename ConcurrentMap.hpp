@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace cg {
+
+/**A hash map that many threads can use at once.
+
+The keys are split over \p Shards smaller maps, each with its own shared
+mutex.  Lookups take a shared lock on one shard, so readers never wait on each
+other, and writers only wait on threads that use the same shard.  With more
+shards than threads, most calls never wait at all.
+
+References to values stay valid until the key is erased, since the maps never
+move their nodes.  Guarding what is inside a value is up to the caller.
+\tparam Key The key type.
+\tparam Value The value type.
+\tparam Hasher The hash functor for keys.
+\tparam Shards The amount of shards. Must be a power of 2.*/
+template<typename Key, typename Value, typename Hasher = std::hash<Key>,
+	std::size_t Shards = 64>
+class ConcurrentMap
+{
+public:
+	static_assert(Shards && !(Shards & (Shards - 1)),
+		"The amount of shards must be a power of 2.");
+	/**The type of key.*/
+	using KeyType = Key;
+	/**The type of value.*/
+	using Type = Value;
+	/**The mutex type.*/
+	using Mutex = std::shared_timed_mutex;
+	/**Get the value for a key, adding a default one if it is not there.
+	\param key The key.
+	\return A reference to the value.*/
+	Value& GetOrAdd(const Key& key);
+	/**Get the value for a key.
+	\param key The key.
+	\return A reference to the value.
+	\throw std::out_of_range if the key is not there.*/
+	Value& At(const Key& key);
+	/**Get the value for a key.
+	\param key The key.
+	\return A reference to the value.
+	\throw std::out_of_range if the key is not there.*/
+	const Value& At(const Key& key) const;
+	/**Find the value for a key.
+	\param key The key.
+	\return A pointer to the value, or nullptr if the key is not there.*/
+	Value* Find(const Key& key);
+	/**Determine if a key is in the map.
+	\param key The key.
+	\return True if it is.*/
+	bool Contains(const Key& key) const;
+	/**Remove a key and its value.
+	\param key The key.
+	\return True if it was there.*/
+	bool Erase(const Key& key);
+	/**Get the amount of keys.  Each shard is locked in turn, so other threads
+	may change it before this returns.
+	\return The amount of keys.*/
+	std::size_t Size() const;
+	/**Remove every key.*/
+	void Clear();
+private:
+	/**The size to pad shards to, so two threads on different shards do not
+	fight over one cache line.*/
+	static const std::size_t CacheLine = 64;
+	/**A part of the map.*/
+	struct Shard
+	{
+		/**Guards m_map.*/
+		mutable Mutex m_lock;
+		/**The keys of this shard.*/
+		std::unordered_map<Key, Value, Hasher> m_map;
+		/**Keeps the next shard off this shard's cache line.*/
+		char m_pad[CacheLine];
+	};
+	/**Get the shard a key belongs to.
+	\param key The key.
+	\return The shard.*/
+	Shard& ShardOf(const Key& key);
+	/**Get the shard a key belongs to.
+	\param key The key.
+	\return The shard.*/
+	const Shard& ShardOf(const Key& key) const;
+	/**Pick the shard for a key.  The hash is mixed first, since std::hash of
+	an integer is often the integer itself.
+	\param key The key.
+	\return The index of the shard.*/
+	static std::size_t Pick(const Key& key);
+
+	/**The shards.*/
+	Shard m_shards[Shards];
+};
+
+}
+
+#include "ConcurrentMap_Impl.hpp"
@@ -0,0 +1,114 @@
+
+#pragma once
+
+#include <stdexcept>
+
+#include "ConcurrentMap.hpp"
+
+namespace cg {
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline Value& ConcurrentMap<Key, Value, Hasher, Shards>::GetOrAdd(
+	const Key & key)
+{
+	Shard& shard = ShardOf(key);
+	{
+		std::shared_lock<Mutex> lock(shard.m_lock);
+		auto it = shard.m_map.find(key);
+		if (it != shard.m_map.end())
+			return it->second;
+	}
+	std::unique_lock<Mutex> lock(shard.m_lock);
+	return shard.m_map[key];
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline Value& ConcurrentMap<Key, Value, Hasher, Shards>::At(const Key & key)
+{
+	Shard& shard = ShardOf(key);
+	std::shared_lock<Mutex> lock(shard.m_lock);
+	return shard.m_map.at(key);
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline const Value& ConcurrentMap<Key, Value, Hasher, Shards>::At(
+	const Key & key) const
+{
+	const Shard& shard = ShardOf(key);
+	std::shared_lock<Mutex> lock(shard.m_lock);
+	return shard.m_map.at(key);
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline Value* ConcurrentMap<Key, Value, Hasher, Shards>::Find(const Key & key)
+{
+	Shard& shard = ShardOf(key);
+	std::shared_lock<Mutex> lock(shard.m_lock);
+	auto it = shard.m_map.find(key);
+	return it == shard.m_map.end() ? nullptr : &it->second;
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline bool ConcurrentMap<Key, Value, Hasher, Shards>::Contains(
+	const Key & key) const
+{
+	const Shard& shard = ShardOf(key);
+	std::shared_lock<Mutex> lock(shard.m_lock);
+	return shard.m_map.count(key) != 0;
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline bool ConcurrentMap<Key, Value, Hasher, Shards>::Erase(const Key & key)
+{
+	Shard& shard = ShardOf(key);
+	std::unique_lock<Mutex> lock(shard.m_lock);
+	return shard.m_map.erase(key) != 0;
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline std::size_t ConcurrentMap<Key, Value, Hasher, Shards>::Size() const
+{
+	std::size_t size = 0;
+	for (const Shard& shard : m_shards)
+	{
+		std::shared_lock<Mutex> lock(shard.m_lock);
+		size += shard.m_map.size();
+	}
+	return size;
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline void ConcurrentMap<Key, Value, Hasher, Shards>::Clear()
+{
+	for (Shard& shard : m_shards)
+	{
+		std::unique_lock<Mutex> lock(shard.m_lock);
+		shard.m_map.clear();
+	}
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline typename ConcurrentMap<Key, Value, Hasher, Shards>::Shard &
+ConcurrentMap<Key, Value, Hasher, Shards>::ShardOf(const Key & key)
+{
+	return m_shards[Pick(key)];
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline const typename ConcurrentMap<Key, Value, Hasher, Shards>::Shard &
+ConcurrentMap<Key, Value, Hasher, Shards>::ShardOf(const Key & key) const
+{
+	return m_shards[Pick(key)];
+}
+
+template<typename Key, typename Value, typename Hasher, std::size_t Shards>
+inline std::size_t ConcurrentMap<Key, Value, Hasher, Shards>::Pick(
+	const Key & key)
+{
+	/*fibonacci hashing: the top bits of the product depend on every bit of
+	the hash.*/
+	uint64_t h = (uint64_t)Hasher()(key) * 0x9E3779B97F4A7C15ull;
+	return (std::size_t)(h >> 32) & (Shards - 1);
+}
+
+}
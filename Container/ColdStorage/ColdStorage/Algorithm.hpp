@@ -0,0 +1,460 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "AlgorithmDef.hpp"
+
+namespace cg {
+
+/**Sort a range with a stable merge sort.  Runs of 32 are insertion sorted,
+then merged bottom up through a buffer the size of the range.
+\param first The first element.
+\param last One past the last element.
+\param pred The functor that orders the elements.
+\throw ArrayException::OutOfMemory if the buffer could not be had.*/
+template<typename DataType, typename Predicate>
+void Sort(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last, Predicate pred)
+{
+    SizeType n = (SizeType)(last - first);
+    if (n < 2)
+        return;
+    DataType* buf = (DataType*)std::malloc(n * sizeof(DataType));
+    if (!buf)
+        throw ArrayException::OutOfMemory;
+    impl::MergeSort(first.Addr(), n, buf, pred);
+    std::free(buf);
+}
+/**Sort a range on an executor with a stable merge sort.
+
+The range is cut into about four pieces per thread, which are sorted at the
+same time.  The sorted runs are then merged in pairs, a level at a time,
+between the range and a buffer of the same size.  Each merge is cut into
+pieces too, by finding where each piece of the output starts in the two
+runs, so the last levels keep every thread busy instead of leaving one
+thread to merge the whole range.  Small ranges are sorted on the calling
+thread.
+\param first The first element.
+\param last One past the last element.
+\param pred The functor that orders the elements.  It must not throw.
+\param ex The executor to run on.
+\throw ArrayException::OutOfMemory if the buffer could not be had.*/
+template<typename DataType, typename Predicate>
+void ParallelSort(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last, Predicate pred, Executor& ex)
+{
+    SizeType n = (SizeType)(last - first);
+    SizeType chunks = impl::TaskCount(ex, n);
+    if (chunks < 2)
+    {
+        Sort(first, last, pred);
+        return;
+    }
+    DataType* a = first.Addr();
+    DataType* buf = (DataType*)std::malloc(n * sizeof(DataType));
+    if (!buf)
+        throw ArrayException::OutOfMemory;
+    cg::Array<SizeType, 0> bounds(chunks + 1);
+    for (SizeType c = 0; c <= chunks; ++c)
+        bounds.PushBack(n * c / chunks);
+    /*each chunk uses its own part of the buffer to merge through.*/
+    auto sortChunk = [&](SizeType c) {
+        SizeType lo = bounds[c];
+        impl::MergeSort(a + lo, bounds[c + 1] - lo, buf + lo, pred);
+    };
+    impl::RunTasks(ex, chunks, sortChunk);
+    /*from here on the elements are in one of src or dst, and the other one
+    is raw memory.*/
+    DataType* src = a;
+    DataType* dst = buf;
+    cg::Array<impl::MergePiece, 0> pieces;
+    while (bounds.Size() > 2)
+    {
+        pieces.PopBack(pieces.Size());
+        cg::Array<SizeType, 0> next(bounds.Size() / 2 + 1);
+        for (SizeType r = 0; r + 1 < bounds.Size(); r += 2)
+        {
+            SizeType lo = bounds[r];
+            SizeType mid = bounds[r + 1];
+            SizeType hi = r + 2 < bounds.Size() ? bounds[r + 2] : mid;
+            SizeType count = impl::TaskCount(ex, hi - lo);
+            SizeType i0 = 0;
+            for (SizeType p = 0; p < count; ++p)
+            {
+                SizeType k1 = (hi - lo) * (p + 1) / count;
+                SizeType i1 = impl::CoRank(k1, src + lo, mid - lo,
+                    src + mid, hi - mid, pred);
+                pieces.PushBack(impl::MergePiece{ lo, mid, i0,
+                    (hi - lo) * p / count - i0, i1, k1 - i1 });
+                i0 = i1;
+            }
+            next.PushBack((SizeType)lo);
+        }
+        next.PushBack((SizeType)n);
+        auto mergePiece = [&](SizeType p) {
+            const impl::MergePiece& piece = pieces[p];
+            impl::MoveMerge(src + piece.m_lo + piece.m_i0,
+                piece.m_i1 - piece.m_i0,
+                src + piece.m_mid + piece.m_j0, piece.m_j1 - piece.m_j0,
+                dst + piece.m_lo + piece.m_i0 + piece.m_j0, pred);
+        };
+        impl::RunTasks(ex, pieces.Size(), mergePiece);
+        bounds = Move(next);
+        DataType* swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != a)
+    {
+        auto moveBack = [&](SizeType c) {
+            SizeType lo = n * c / chunks;
+            impl::MoveMerge(buf + lo, n * (c + 1) / chunks - lo, buf, 0,
+                a + lo, pred);
+        };
+        impl::RunTasks(ex, chunks, moveBack);
+    }
+    std::free(buf);
+}
+/**Call a function on every element of a range, on an executor.  The range
+is cut into pieces of at least ParallelGrain elements.
+\param first The first element.
+\param last One past the last element.
+\param func The function. Called as func(DataType&), from many threads at
+once.*/
+template<typename DataType, typename Func>
+void ParallelForEach(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last, Func func, Executor& ex)
+{
+    SizeType n = (SizeType)(last - first);
+    SizeType count = impl::TaskCount(ex, n);
+    DataType* a = first.Addr();
+    auto piece = [&](SizeType p) {
+        DataType* end = a + n * (p + 1) / count;
+        for (DataType* it = a + n * p / count; it != end; ++it)
+            func(*it);
+    };
+    impl::RunTasks(ex, count, piece);
+}
+/**Set each element of an output range to a function of the matching input
+element, on an executor.
+\param first The first input element.
+\param last One past the last input element.
+\param out The first output element.  There must be room for as many as
+there are inputs.  It may be \p first.
+\param func The function. Called as func(const DataType&), from many
+threads at once.
+\return One past the last output element.*/
+template<typename DataType, bool Const, typename OutType, typename Func>
+ArrayIterator<OutType, false, false> ParallelTransform(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last,
+    ArrayIterator<OutType, false, false> out, Func func, Executor& ex)
+{
+    SizeType n = (SizeType)(last - first);
+    SizeType count = impl::TaskCount(ex, n);
+    const DataType* in = first.Addr();
+    OutType* o = out.Addr();
+    auto piece = [&](SizeType p) {
+        SizeType end = n * (p + 1) / count;
+        for (SizeType i = n * p / count; i != end; ++i)
+            o[i] = func(in[i]);
+    };
+    impl::RunTasks(ex, count, piece);
+    return out + n;
+}
+/**Combine the elements of a range, on an executor.  Each piece is combined
+on its own, then the results of the pieces are combined in order, so \p op
+has to be associative but does not have to be commutative.
+\param first The first element.
+\param last One past the last element.
+\param init The value to start with.  It is used once.
+\param op The function. Called as op(T, const DataType&) and op(T, T).
+\return The combined value, or \p init if the range is empty.*/
+template<typename DataType, bool Const, typename T, typename Op>
+T ParallelReduce(ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, T init, Op op, Executor& ex)
+{
+    SizeType n = (SizeType)(last - first);
+    if (n == 0)
+        return init;
+    SizeType count = impl::TaskCount(ex, n);
+    const DataType* a = first.Addr();
+    std::vector<T> results(count, init);
+    auto piece = [&](SizeType p) {
+        SizeType i = n * p / count;
+        SizeType end = n * (p + 1) / count;
+        T result = p == 0 ? op(init, a[i]) : T(a[i]);
+        for (++i; i != end; ++i)
+            result = op(result, a[i]);
+        results[p] = result;
+    };
+    impl::RunTasks(ex, count, piece);
+    T result = results[0];
+    for (SizeType p = 1; p < count; ++p)
+        result = op(result, results[p]);
+    return result;
+}
+/**Find the first element of a sorted range that is not less than a value.
+\param first The first element.
+\param last One past the last element.
+\param value The value to look for.
+\param pred The functor the range is sorted by.
+\return The element, or \p last if every element is less.*/
+template<typename DataType, bool Const, typename Predicate>
+ArrayIterator<DataType, Const, false> LowerBound(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value,
+    Predicate pred)
+{
+    const DataType* a = first.Addr();
+    SizeType low = 0;
+    SizeType high = (SizeType)(last - first);
+    while (low < high)
+    {
+        SizeType mid = (low + high) / 2;
+        if (pred(a[mid], value))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return first + low;
+}
+/**Find the first element of a sorted range that is greater than a value.
+\param first The first element.
+\param last One past the last element.
+\param value The value to look for.
+\param pred The functor the range is sorted by.
+\return The element, or \p last if no element is greater.*/
+template<typename DataType, bool Const, typename Predicate>
+ArrayIterator<DataType, Const, false> UpperBound(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value,
+    Predicate pred)
+{
+    const DataType* a = first.Addr();
+    SizeType low = 0;
+    SizeType high = (SizeType)(last - first);
+    while (low < high)
+    {
+        SizeType mid = (low + high) / 2;
+        if (pred(value, a[mid]))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return first + low;
+}
+/**Determine if a sorted range has an element equal to a value.
+\param first The first element.
+\param last One past the last element.
+\param value The value to look for.
+\param pred The functor the range is sorted by.
+\return True if an element is neither less nor greater than \p value.*/
+template<typename DataType, bool Const, typename Predicate>
+bool BinarySearch(ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value,
+    Predicate pred)
+{
+    auto it = LowerBound(first, last, value, pred);
+    return it != last && !pred(value, *it);
+}
+
+namespace impl {
+
+/**Run func(0) to func(count - 1) on an executor, with func(0) on the
+calling thread, and wait for all of them.
+\param ex The executor.
+\param count The amount of calls.
+\param func The function.
+\throw The first exception a call threw, once every call is done.*/
+template<typename Func>
+void RunTasks(Executor& ex, SizeType count, Func& func)
+{
+    std::vector<std::future<void>> futures;
+    futures.reserve(count);
+    for (SizeType t = 1; t < count; ++t)
+        futures.push_back(ex.Submit([&func, t]() { func(t); }));
+    std::exception_ptr error;
+    try {
+        if (count)
+            func(0);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    /*every task has to be done before func goes out of scope.*/
+    for (auto& future : futures)
+    {
+        try {
+            future.get();
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+/**Get the amount of pieces to cut a range into.
+\param ex The executor that will run them.
+\param amt The amount of elements.
+\return About four per thread, but no piece smaller than ParallelGrain, and
+at least 1.*/
+inline SizeType TaskCount(Executor& ex, SizeType amt)
+{
+    SizeType most = 4 * (ex.ThreadCount() + 1);
+    SizeType count = amt / ParallelGrain;
+    if (count > most)
+        count = most;
+    return count ? count : 1;
+}
+/**Sort a short range by inserting each element into the sorted front.
+\param a The range.
+\param n The amount of elements.
+\param pred The functor that orders the elements.*/
+template<typename DataType, typename Predicate>
+void InsertionSort(DataType* a, SizeType n, Predicate& pred)
+{
+    for (SizeType i = 1; i < n; ++i)
+    {
+        if (!pred(a[i], a[i - 1]))
+            continue;
+        DataType x = Move(a[i]);
+        SizeType j = i;
+        for (; j > 0 && pred(x, a[j - 1]); --j)
+            a[j] = Move(a[j - 1]);
+        a[j] = Move(x);
+    }
+}
+/**Merge two sorted runs that sit next to each other.  The first run is moved
+out to the buffer and merged back, so the writes never pass the reads.
+\param a The first run, followed by the second.
+\param m The length of the first run.
+\param r The length of the second run.
+\param buf Raw memory for at least \p m elements.
+\param pred The functor that orders the elements.*/
+template<typename DataType, typename Predicate>
+void MergeDown(DataType* a, SizeType m, SizeType r, DataType* buf,
+    Predicate& pred)
+{
+    if (!pred(a[m], a[m - 1]))
+        return;
+    for (SizeType i = 0; i < m; ++i)
+        new (buf + i) DataType(Move(a[i]));
+    DataType* b = a + m;
+    SizeType i = 0;
+    SizeType j = 0;
+    SizeType out = 0;
+    while (i < m && j < r)
+    {
+        if (pred(b[j], buf[i]))
+            a[out++] = Move(b[j++]);
+        else
+            a[out++] = Move(buf[i++]);
+    }
+    while (i < m)
+        a[out++] = Move(buf[i++]);
+    for (i = 0; i < m; ++i)
+        buf[i].~DataType();
+}
+/**Sort a range with a bottom up merge sort.
+\param a The range.
+\param n The amount of elements.
+\param buf Raw memory for at least \p n elements.
+\param pred The functor that orders the elements.*/
+template<typename DataType, typename Predicate>
+void MergeSort(DataType* a, SizeType n, DataType* buf, Predicate& pred)
+{
+    const SizeType run = 32;
+    for (SizeType lo = 0; lo < n; lo += run)
+        InsertionSort(a + lo, n - lo < run ? n - lo : run, pred);
+    for (SizeType width = run; width < n; width *= 2)
+        for (SizeType lo = 0; lo + width < n; lo += 2 * width)
+            MergeDown(a + lo, width,
+                n - lo - width < width ? n - lo - width : width, buf, pred);
+}
+/**Find how many elements of the first run are in the first \p k elements
+of the merge of two runs.  Ties go to the first run, as they do in
+MoveMerge.
+\param k The amount of merged elements.
+\param a The first run.
+\param m The length of the first run.
+\param b The second run.
+\param n The length of the second run.
+\param pred The functor that orders the elements.
+\return The amount taken from the first run.  The rest, k minus it, come from
+the second.*/
+template<typename DataType, typename Predicate>
+SizeType CoRank(SizeType k, const DataType* a, SizeType m,
+    const DataType* b, SizeType n, Predicate& pred)
+{
+    SizeType low = k > n ? k - n : 0;
+    SizeType high = k < m ? k : m;
+    while (low < high)
+    {
+        SizeType i = (low + high) / 2;
+        /*a[i] is merged before b[k - i - 1] unless b[k - i - 1] is less.*/
+        if (!pred(b[k - i - 1], a[i]))
+            low = i + 1;
+        else
+            high = i;
+    }
+    return low;
+}
+/**Merge two sorted runs into raw memory.  Each element is moved to \p out
+and then destroyed where it was.
+\param a The first run.
+\param m The length of the first run.
+\param b The second run.
+\param n The length of the second run.
+\param out Raw memory for m + n elements.
+\param pred The functor that orders the elements.*/
+template<typename DataType, typename Predicate>
+void MoveMerge(DataType* a, SizeType m, DataType* b, SizeType n,
+    DataType* out, Predicate& pred)
+{
+    DataType* aEnd = a + m;
+    DataType* bEnd = b + n;
+    while (a != aEnd && b != bEnd)
+    {
+        DataType* from = pred(*b, *a) ? b++ : a++;
+        new (out++) DataType(Move(*from));
+        from->~DataType();
+    }
+    for (; a != aEnd; ++a)
+    {
+        new (out++) DataType(Move(*a));
+        a->~DataType();
+    }
+    for (; b != bEnd; ++b)
+    {
+        new (out++) DataType(Move(*b));
+        b->~DataType();
+    }
+}
+
+}
+
+}
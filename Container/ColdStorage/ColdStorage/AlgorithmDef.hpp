@@ -0,0 +1,124 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <exception>
+#include <future>
+#include <vector>
+
+#include "Array.hpp"
+#include "../../../Executor.hpp"
+
+namespace cg {
+
+/**The least amount of elements the parallel algorithms give one task.
+Smaller pieces cost more to hand to a thread than they save.*/
+const SizeType ParallelGrain = 4096;
+
+template<typename DataType, typename Predicate = Less<DataType>>
+void Sort(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last,
+    Predicate pred = Predicate());
+
+template<typename DataType, typename Predicate = Less<DataType>>
+void ParallelSort(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last,
+    Predicate pred = Predicate(), Executor& ex = Executor::Shared());
+
+template<typename DataType, typename Func>
+void ParallelForEach(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last, Func func,
+    Executor& ex = Executor::Shared());
+
+template<typename DataType, bool Const, typename OutType, typename Func>
+ArrayIterator<OutType, false, false> ParallelTransform(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last,
+    ArrayIterator<OutType, false, false> out, Func func,
+    Executor& ex = Executor::Shared());
+
+template<typename DataType, bool Const, typename T, typename Op>
+T ParallelReduce(ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, T init, Op op,
+    Executor& ex = Executor::Shared());
+
+template<typename DataType, bool Const,
+    typename Predicate = Less<DataType>>
+ArrayIterator<DataType, Const, false> LowerBound(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value,
+    Predicate pred = Predicate());
+
+template<typename DataType, bool Const,
+    typename Predicate = Less<DataType>>
+ArrayIterator<DataType, Const, false> UpperBound(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value,
+    Predicate pred = Predicate());
+
+template<typename DataType, bool Const,
+    typename Predicate = Less<DataType>>
+bool BinarySearch(ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value,
+    Predicate pred = Predicate());
+
+namespace impl {
+
+/**A piece of a merge of two runs, in the parallel sort.*/
+struct MergePiece
+{
+    /**Where the first run starts.*/
+    SizeType m_lo;
+    /**Where the second run starts.*/
+    SizeType m_mid;
+    /**The elements of each run that come before this piece.*/
+    SizeType m_i0, m_j0;
+    /**The elements of each run that come before the next piece.*/
+    SizeType m_i1, m_j1;
+};
+
+template<typename Func>
+void RunTasks(Executor& ex, SizeType count, Func& func);
+
+SizeType TaskCount(Executor& ex, SizeType amt);
+
+template<typename DataType, typename Predicate>
+void InsertionSort(DataType* a, SizeType n, Predicate& pred);
+
+template<typename DataType, typename Predicate>
+void MergeDown(DataType* a, SizeType m, SizeType r, DataType* buf,
+    Predicate& pred);
+
+template<typename DataType, typename Predicate>
+void MergeSort(DataType* a, SizeType n, DataType* buf, Predicate& pred);
+
+template<typename DataType, typename Predicate>
+SizeType CoRank(SizeType k, const DataType* a, SizeType m,
+    const DataType* b, SizeType n, Predicate& pred);
+
+template<typename DataType, typename Predicate>
+void MoveMerge(DataType* a, SizeType m, DataType* b, SizeType n,
+    DataType* out, Predicate& pred);
+
+}
+
+}
@@ -38,8 +38,11 @@ template<typename DataType, cg::SizeType SizeP>
 Storage<DataType, SizeP>::Storage(SelfType&& other)
     : m_cap(SizeP), m_size(other.m_size)
 {
-    for (cg::SizeType i = 0; i < other.m_size; ++i)
-        new (Addr() + i) DataType(Move(other.Addr()[i]));
+    if (IsTriviallyRelocatable<DataType>::value)
+        std::memcpy(Addr(), other.Addr(), sizeof(DataType) * other.m_size);
+    else
+        for (cg::SizeType i = 0; i < other.m_size; ++i)
+            new (Addr() + i) DataType(Move(other.Addr()[i]));
 #if _DEBUG
     other.m_size = 0;
 #endif
@@ -50,8 +53,11 @@ template<typename DataType, cg::SizeType SizeP>
 void Storage<DataType, SizeP>::operator=(SelfType&& other)
 {
     m_size = Move(other.m_size);
-    for (cg::SizeType i = 0; i < other.m_size; ++i)
-        new (Addr() + i) DataType(Move(other.Addr()[i]));
+    if (IsTriviallyRelocatable<DataType>::value)
+        std::memcpy(Addr(), other.Addr(), sizeof(DataType) * other.m_size);
+    else
+        for (cg::SizeType i = 0; i < other.m_size; ++i)
+            new (Addr() + i) DataType(Move(other.Addr()[i]));
 #if _DEBUG
     other.m_size = 0;
 #endif
@@ -109,7 +115,7 @@ void Storage<DataType, SizeP>::Insert(cg::SizeType i, NType&& o)
         throw ArrayException::ArrayIsFull;
     if (m_size != i)
         std::memmove(Addr() + i + 1, Addr() + i,
-            sizeof(NType)*(m_size - i));
+            sizeof(DataType)*(m_size - i));
     new (Addr() + i)U(Forward<NType>(o));
     ++m_size;
 }
@@ -130,6 +136,31 @@ void Storage<DataType, SizeP>::Emplace(cg::SizeType i, Ts&&... nums)
     new (Addr() + i)DataType(Forward<Ts>(nums)...);
     ++m_size;
 }
+/**Copy a run of objects to an index.  The objects after \p i are moved
+once, however many are inserted.
+\param i The place to put the first object.
+\param arr The objects to copy. Must not point into this storage.
+\param amt The amount of objects.*/
+template<typename DataType, cg::SizeType SizeP>
+void Storage<DataType, SizeP>::Insert(cg::SizeType i, const DataType* arr,
+    cg::SizeType amt)
+{
+    if (i > m_size)
+        throw ArrayException::IndexOutOfBounds;
+    if (amt > m_cap - m_size)
+        throw ArrayException::ArrayIsFull;
+    if (amt == 0)
+        return;
+    DataType* at = Addr() + i;
+    if (m_size != i)
+        std::memmove(at + amt, at, sizeof(DataType)*(m_size - i));
+    if (IsTriviallyRelocatable<DataType>::value)
+        std::memcpy(at, arr, sizeof(DataType) * amt);
+    else
+        for (cg::SizeType k = 0; k < amt; ++k)
+            new (at + k) DataType(arr[k]);
+    m_size += amt;
+}
 /**Get the address of the data.
 \param i the offset.
 \return The address of the data.*/
@@ -168,7 +199,7 @@ m_data(nullptr)
 \param aSize The size of the array.*/
 template<typename DataType>
 Storage<DataType, 0>::Storage(const DataType* arr, cg::SizeType aSize)
-    :m_cap(0), m_size(0)
+    :m_cap(0), m_size(0), m_data(nullptr)
 {
     ExpandTo(aSize);
     auto end = arr + aSize;
@@ -179,12 +210,13 @@ Storage<DataType, 0>::Storage(const DataType* arr, cg::SizeType aSize)
 \param other The thing to move.*/
 template<typename DataType>
 Storage<DataType, 0>::Storage(SelfType&& other)
-    :m_cap(other.m_cap), m_data(other.m_data), m_size(other.m_size)
+    :m_cap(other.m_cap), m_data(other.m_data), m_size(other.m_size),
+    m_growth(other.m_growth)
 {
-#ifdef _DEBUG
+    /*the other one frees m_data when it dies, so it has to let go.*/
     other.m_data = nullptr;
     other.m_size = 0;
-#endif
+    other.m_cap = 0;
 };
 /**Create the int with initial values.
 
@@ -197,26 +229,30 @@ All values will be inserted to the storage.
 \param vals The values to insert.*/
 template<typename DataType>
 Storage<DataType, 0>::Storage(std::initializer_list<DataType>&& vals)
+    :m_cap(0), m_size(0), m_data(nullptr)
 {
     cg::SizeType sz = vals.size();
     ExpandTo(sz);
     for (cg::SizeType i = 0; i < sz; ++i)
         new (Addr() + i) DataType(Move(*(vals.begin() + i)));
     m_size = sz;
-    m_cap = sz;
 }
 /**Move op
 \param other The thing to move.*/
 template<typename DataType>
 void Storage<DataType, 0>::operator=(SelfType&& other)
 {
+    if (this == &other)
+        return;
+    if (m_data)
+        free(m_data);
     m_data = other.m_data;
-#ifdef _DEBUG
-    other.m_data = nullptr;
-    other.m_size = 0;
-#endif
     m_size = other.m_size;
     m_cap = other.m_cap;
+    m_growth = other.m_growth;
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_cap = 0;
 }
 /**Clean up the data.*/
 template<typename DataType>
@@ -243,10 +279,10 @@ void Storage<DataType, 0>::Insert(cg::SizeType i, NType&& o)
     if (i > m_size)
         throw ArrayException::IndexOutOfBounds;
     if (m_size == m_cap)
-        ExpandTo(m_cap + ExpandAmount);
+        ExpandTo(Grown(m_size + 1));
     if (m_size != i)
         std::memmove(Addr() + i + 1, Addr() + i,
-            sizeof(NType)*(m_size - i));
+            sizeof(DataType)*(m_size - i));
     new (Addr() + i)U(Forward<NType>(o));
     ++m_size;
 }
@@ -260,37 +296,100 @@ void Storage<DataType, 0>::Emplace(cg::SizeType i, Ts&&... nums)
     if (i > m_size)
         throw ArrayException::IndexOutOfBounds;
     if (m_size == m_cap)
-        ExpandTo(m_cap + ExpandAmount);
+        ExpandTo(Grown(m_size + 1));
     if (m_size != i)
         std::memmove(Addr() + i + 1, Addr() + i,
             sizeof(DataType)*(m_size - i));
     new (Addr() + i)DataType(Forward<Ts>(nums)...);
     ++m_size;
 }
+/**Copy a run of objects to an index.  The storage grows at most once and the
+objects after \p i are moved once, however many are inserted.
+\param i The place to put the first object.
+\param arr The objects to copy. Must not point into this storage.
+\param amt The amount of objects.*/
+template<typename DataType>
+void Storage<DataType, 0>::Insert(cg::SizeType i, const DataType* arr,
+    cg::SizeType amt)
+{
+    if (i > m_size)
+        throw ArrayException::IndexOutOfBounds;
+    if (amt == 0)
+        return;
+    if (m_size + amt > m_cap)
+        ExpandTo(Grown(m_size + amt));
+    DataType* at = m_data + i;
+    if (m_size != i)
+        std::memmove(at + amt, at, sizeof(DataType)*(m_size - i));
+    if (IsTriviallyRelocatable<DataType>::value)
+        std::memcpy(at, arr, sizeof(DataType) * amt);
+    else
+        for (cg::SizeType k = 0; k < amt; ++k)
+            new (at + k) DataType(arr[k]);
+    m_size += amt;
+}
+/**Set how fast the storage grows when it fills up.
+\param factor The capacity is multiplied by this. Must be more than 1.
+\throw ArrayException::InvalidParameter if \p factor is not more than 1.*/
+template<typename DataType>
+void Storage<DataType, 0>::GrowthFactor(float factor)
+{
+    if (!(factor > 1.0f))
+        throw ArrayException::InvalidParameter;
+    m_growth = factor;
+}
+/**Get how fast the storage grows when it fills up.
+\return The factor the capacity is multiplied by.*/
+template<typename DataType>
+float Storage<DataType, 0>::GrowthFactor() const
+{
+    return m_growth;
+}
 ///////////////////////////////////////////////////////////////////////////
 /**Expand the array to X amount of elements.
-\param amt The amount to hold. If m_cap is >=, nothing happens.*/
+\param amt The amount to hold. If m_cap is >=, nothing happens.
+\throw ArrayException::OutOfMemory if the memory could not be had. The
+array is left as it was.*/
 template<typename DataType>
 void Storage<DataType, 0>::ExpandTo(cg::SizeType amt)
 {
     if (m_cap >= amt)
         return;
-    if (!m_data)
+    DataType* nData;
+    if (IsTriviallyRelocatable<DataType>::value || !m_data)
+    {
+        /*realloc can often grow in place, and is a memcpy when it can not.*/
+        nData = (DataType*)std::realloc(m_data, sizeof(DataType)*amt);
+        if (!nData)
+            throw ArrayException::OutOfMemory;
+    }
+    else
     {
         /**Dont initialize...*/
-        m_data = (DataType*)std::malloc(sizeof(DataType)*amt);
-        m_cap = amt;
-        return;
+        nData = (DataType*)std::malloc(sizeof(DataType)*amt);
+        if (!nData)
+            throw ArrayException::OutOfMemory;
+        for (SizeType i = 0; i < m_size; ++i)
+        {
+            new (nData + i) DataType(Move(m_data[i]));
+            m_data[i].~DataType();
+        }
+        free(m_data);
     }
-    /**Dont initialize...*/
-    DataType* nData = (DataType*)std::malloc(sizeof(DataType)*amt);
-    //std::memmove(nData, Addr(), sizeof(DataType) * m_size);
-    for (SizeType i = 0; i < m_size; ++i)
-        new (nData + i) DataType(Move(m_data[i]));
-    m_cap = amt;
-
-    free(m_data);
     m_data = nData;
+    m_cap = amt;
+}
+/**Get the capacity to grow to.  Growing by a factor instead of a fixed
+amount means n pushes copy O(n) elements in total, not O(n^2).
+\param amt The least amount that has to fit.
+\return The new capacity.*/
+template<typename DataType>
+cg::SizeType Storage<DataType, 0>::Grown(cg::SizeType amt) const
+{
+    cg::SizeType cap = (cg::SizeType)(m_cap * m_growth);
+    if (cap < m_cap + ExpandAmount)
+        cap = m_cap + ExpandAmount;
+    return cap < amt ? amt : cap;
 }
 /**Get the address of the data.
 \param i the offset.
@@ -311,6 +410,257 @@ const DataType* Storage<DataType, 0>::Addr(cg::SizeType i)const
     return m_data + i;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////SPILL HERE//////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**default ctor
+\param cap The initial capacity. Nothing is allocated unless it is more than
+SizeP.*/
+template<typename DataType, cg::SizeType SizeP>
+Storage<DataType, SizeP, true>::Storage(cg::SizeType cap)
+    :m_data((DataType*)m_inline), m_cap(SizeP), m_size(0)
+{
+    ExpandTo(cap);
+}
+/**Create with an array of things.
+\param arr The array to add.
+\param aSize The size of the array.*/
+template<typename DataType, cg::SizeType SizeP>
+Storage<DataType, SizeP, true>::Storage(const DataType* arr,
+    cg::SizeType aSize)
+    :m_data((DataType*)m_inline), m_cap(SizeP), m_size(0)
+{
+    Insert(0, arr, aSize);
+}
+/**Move ctor
+\param other The thing to move.*/
+template<typename DataType, cg::SizeType SizeP>
+Storage<DataType, SizeP, true>::Storage(SelfType&& other)
+    :m_data((DataType*)m_inline), m_cap(SizeP), m_size(0)
+{
+    TakeFrom(other);
+}
+/**Create the int with initial values.
+\param vals The values to insert.*/
+template<typename DataType, cg::SizeType SizeP>
+Storage<DataType, SizeP, true>::Storage(
+    std::initializer_list<DataType>&& vals)
+    :m_data((DataType*)m_inline), m_cap(SizeP), m_size(0)
+{
+    cg::SizeType sz = vals.size();
+    ExpandTo(sz);
+    for (cg::SizeType i = 0; i < sz; ++i)
+        new (Addr() + i) DataType(Move(*(vals.begin() + i)));
+    m_size = sz;
+}
+/**Move op
+\param other The thing to move.*/
+template<typename DataType, cg::SizeType SizeP>
+void Storage<DataType, SizeP, true>::operator=(SelfType&& other)
+{
+    if (this == &other)
+        return;
+    if (!IsInline())
+        free(m_data);
+    m_data = (DataType*)m_inline;
+    m_cap = SizeP;
+    m_size = 0;
+    TakeFrom(other);
+}
+/**Clean up the data.*/
+template<typename DataType, cg::SizeType SizeP>
+Storage<DataType, SizeP, true>::~Storage()
+{
+    if (!IsInline())
+        free(m_data);
+}
+/**Determine if another element can be inserted.
+\return True if an insert now would NOT throw an exception.*/
+template<typename DataType, cg::SizeType SizeP>
+bool Storage<DataType, SizeP, true>::CanInsert() const
+{
+    return true;
+}
+/**Push an object to an index.
+\param i The place to put the object.
+\param o The thing to push.*/
+template<typename DataType, cg::SizeType SizeP>
+template<typename NType>
+void Storage<DataType, SizeP, true>::Insert(cg::SizeType i, NType&& o)
+{
+    using U = std::decay_t<NType>;
+    if (i > m_size)
+        throw ArrayException::IndexOutOfBounds;
+    if (m_size == m_cap)
+        ExpandTo(Grown(m_size + 1));
+    if (m_size != i)
+        std::memmove(m_data + i + 1, m_data + i,
+            sizeof(DataType)*(m_size - i));
+    new (m_data + i)U(Forward<NType>(o));
+    ++m_size;
+}
+/**Emplace an object to an index.
+\param i The place to put the object.
+\param nums The args to send to the ctor of type T.*/
+template<typename DataType, cg::SizeType SizeP>
+template<typename...Ts>
+void Storage<DataType, SizeP, true>::Emplace(cg::SizeType i, Ts&&... nums)
+{
+    if (i > m_size)
+        throw ArrayException::IndexOutOfBounds;
+    if (m_size == m_cap)
+        ExpandTo(Grown(m_size + 1));
+    if (m_size != i)
+        std::memmove(m_data + i + 1, m_data + i,
+            sizeof(DataType)*(m_size - i));
+    new (m_data + i)DataType(Forward<Ts>(nums)...);
+    ++m_size;
+}
+/**Copy a run of objects to an index.  The storage grows at most once and the
+objects after \p i are moved once, however many are inserted.
+\param i The place to put the first object.
+\param arr The objects to copy. Must not point into this storage.
+\param amt The amount of objects.*/
+template<typename DataType, cg::SizeType SizeP>
+void Storage<DataType, SizeP, true>::Insert(cg::SizeType i,
+    const DataType* arr, cg::SizeType amt)
+{
+    if (i > m_size)
+        throw ArrayException::IndexOutOfBounds;
+    if (amt == 0)
+        return;
+    if (m_size + amt > m_cap)
+        ExpandTo(Grown(m_size + amt));
+    DataType* at = m_data + i;
+    if (m_size != i)
+        std::memmove(at + amt, at, sizeof(DataType)*(m_size - i));
+    if (IsTriviallyRelocatable<DataType>::value)
+        std::memcpy(at, arr, sizeof(DataType) * amt);
+    else
+        for (cg::SizeType k = 0; k < amt; ++k)
+            new (at + k) DataType(arr[k]);
+    m_size += amt;
+}
+/**Set how fast the storage grows once it is on the heap.
+\param factor The capacity is multiplied by this. Must be more than 1.
+\throw ArrayException::InvalidParameter if \p factor is not more than 1.*/
+template<typename DataType, cg::SizeType SizeP>
+void Storage<DataType, SizeP, true>::GrowthFactor(float factor)
+{
+    if (!(factor > 1.0f))
+        throw ArrayException::InvalidParameter;
+    m_growth = factor;
+}
+/**Get how fast the storage grows once it is on the heap.
+\return The factor the capacity is multiplied by.*/
+template<typename DataType, cg::SizeType SizeP>
+float Storage<DataType, SizeP, true>::GrowthFactor() const
+{
+    return m_growth;
+}
+/**Determine if the elements are still inline.
+\return False if the storage has spilled to the heap.*/
+template<typename DataType, cg::SizeType SizeP>
+bool Storage<DataType, SizeP, true>::IsInline() const
+{
+    return m_data == (const DataType*)m_inline;
+}
+/**Move the elements of another storage into this one, which must be empty
+and inline.  A heap buffer is taken over, inline elements are moved one by
+one.  \p other is left empty and inline.
+\param other The storage to take from.*/
+template<typename DataType, cg::SizeType SizeP>
+void Storage<DataType, SizeP, true>::TakeFrom(SelfType& other)
+{
+    m_growth = other.m_growth;
+    if (!other.IsInline())
+    {
+        m_data = other.m_data;
+        m_cap = other.m_cap;
+        m_size = other.m_size;
+        other.m_data = (DataType*)other.m_inline;
+        other.m_cap = SizeP;
+        other.m_size = 0;
+        return;
+    }
+    if (IsTriviallyRelocatable<DataType>::value)
+        std::memcpy(m_data, other.m_data, sizeof(DataType) * other.m_size);
+    else
+        for (cg::SizeType i = 0; i < other.m_size; ++i)
+        {
+            new (m_data + i) DataType(Move(other.m_data[i]));
+            other.m_data[i].~DataType();
+        }
+    m_size = other.m_size;
+    other.m_size = 0;
+}
+///////////////////////////////////////////////////////////////////////////
+/**Expand the storage to X amount of elements.  The first expand past SizeP
+moves everything from inline to the heap.
+\param amt The amount to hold. If m_cap is >=, nothing happens.
+\throw ArrayException::OutOfMemory if the memory could not be had. The
+storage is left as it was.*/
+template<typename DataType, cg::SizeType SizeP>
+void Storage<DataType, SizeP, true>::ExpandTo(cg::SizeType amt)
+{
+    if (m_cap >= amt)
+        return;
+    DataType* nData;
+    if (IsTriviallyRelocatable<DataType>::value && !IsInline())
+    {
+        nData = (DataType*)std::realloc(m_data, sizeof(DataType)*amt);
+        if (!nData)
+            throw ArrayException::OutOfMemory;
+    }
+    else
+    {
+        /**Dont initialize...*/
+        nData = (DataType*)std::malloc(sizeof(DataType)*amt);
+        if (!nData)
+            throw ArrayException::OutOfMemory;
+        if (IsTriviallyRelocatable<DataType>::value)
+            std::memcpy(nData, m_data, sizeof(DataType) * m_size);
+        else
+            for (SizeType i = 0; i < m_size; ++i)
+            {
+                new (nData + i) DataType(Move(m_data[i]));
+                m_data[i].~DataType();
+            }
+        if (!IsInline())
+            free(m_data);
+    }
+    m_data = nData;
+    m_cap = amt;
+}
+/**Get the capacity to grow to.
+\param amt The least amount that has to fit.
+\return The new capacity.*/
+template<typename DataType, cg::SizeType SizeP>
+cg::SizeType Storage<DataType, SizeP, true>::Grown(cg::SizeType amt) const
+{
+    cg::SizeType cap = (cg::SizeType)(m_cap * m_growth);
+    if (cap < m_cap + ExpandAmount)
+        cap = m_cap + ExpandAmount;
+    return cap < amt ? amt : cap;
+}
+/**Get the address of the data.
+\param i the offset.
+\return The address of the data.*/
+template<typename DataType, cg::SizeType SizeP>
+DataType* Storage<DataType, SizeP, true>::Addr(cg::SizeType i)
+{
+    return m_data + i;
+}
+/**Get the address of the data.
+\param i the offset.
+\return The address of the data.*/
+template<typename DataType, cg::SizeType SizeP>
+const DataType* Storage<DataType, SizeP, true>::Addr(cg::SizeType i)const
+{
+    return m_data + i;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////LIST HERE//////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -318,26 +668,27 @@ const DataType* Storage<DataType, 0>::Addr(cg::SizeType i)const
     /**Create the list.
     \param initCap The initial capacity to start with.  Not relevent for
     SizeP > 0.*/
-template<typename DataType, cg::SizeType SizeP>
-Array<DataType, SizeP>::Array(cg::SizeType initCap) : Storage(initCap) {};
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+Array<DataType, SizeP, Spill>::Array(cg::SizeType initCap)
+    : Storage(initCap) {};
 /**Create the list with cap of 8.*/
-template<typename DataType, cg::SizeType SizeP>
-Array<DataType, SizeP>::Array() : Storage(8) {};
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+Array<DataType, SizeP, Spill>::Array() : Storage(InitialCap) {};
 /**Create with an array of things.
 \param arr The array to add.
 \param aSize The size of the array.*/
-template<typename DataType, cg::SizeType SizeP>
-Array<DataType, SizeP>::Array(const DataType* arr, cg::SizeType aSize)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+Array<DataType, SizeP, Spill>::Array(const DataType* arr, cg::SizeType aSize)
     :Storage(arr, aSize) {}
 /**Move ctor
 \param other The thing to move.*/
-template<typename DataType, cg::SizeType SizeP>
-Array<DataType, SizeP>::Array(SelfType&& other)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+Array<DataType, SizeP, Spill>::Array(SelfType&& other)
     : Storage(Move(other)) {};
 /**Move assign.
 \param other The thing to move.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::operator=(SelfType&& other)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::operator=(SelfType&& other)
 {
     Storage::operator=(Move(other));
 }
@@ -350,43 +701,46 @@ If SizeP == 0
 All values will be inserted to the storage.
 
 \param vals The values to insert.*/
-template<typename DataType, cg::SizeType SizeP>
-Array<DataType, SizeP>::Array(std::initializer_list<DataType>&& vals)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+Array<DataType, SizeP, Spill>::Array(std::initializer_list<DataType>&& vals)
     :Storage(Forward<std::initializer_list<DataType>>(vals))
 {
 
 }
 /**Copy from another array.
 \param other The other array to copy.*/
-template<typename DataType, cg::SizeType SizeP>
-template<typename DataType2, cg::SizeType SizeP2>
-Array<DataType, SizeP>::Array(const Array<DataType2, SizeP2>& other)
-    :Storage(ExpandAmount) /*storage is set with expandamount incase its heap
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+template<typename DataType2, cg::SizeType SizeP2, bool Spill2>
+Array<DataType, SizeP, Spill>::Array(
+    const Array<DataType2, SizeP2, Spill2>& other)
+    :Storage(InitialCap) /*storage is set with InitialCap incase its heap
                            allocated. If not,  it does not  matter anyway.*/
 {
     *this = other;
 }
 /**Copy from another array.
 \param other The other array to copy.*/
-template<typename DataType, cg::SizeType SizeP>
-Array<DataType, SizeP>::Array(const SelfType& other)
-    :Storage(ExpandAmount) /*storage is set with expandamount incase its heap
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+Array<DataType, SizeP, Spill>::Array(const SelfType& other)
+    :Storage(InitialCap) /*storage is set with InitialCap incase its heap
                            allocated. If not,  it does not  matter anyway.*/
 {
     *this = other;
 }
 /**Copy from another array.
 \param other The other array to copy.*/
-template<typename DataType, cg::SizeType SizeP>
-template<typename DataType2, cg::SizeType SizeP2>
-Array<DataType, SizeP>&
-Array<DataType, SizeP>::operator=(const Array<DataType2, SizeP2>& other)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+template<typename DataType2, cg::SizeType SizeP2, bool Spill2>
+Array<DataType, SizeP, Spill>&
+Array<DataType, SizeP, Spill>::operator=(
+    const Array<DataType2, SizeP2, Spill2>& other)
 {
     const static bool Check1 = SizeP2 == 0 && SizeP == 0;
     const static bool Check2 = SizeP2 <= SizeP;
-    const static bool Check3 = SizeP == 0;
+    const static bool Check3 = SizeP == 0 || Spill;
     static_assert(Check1 || Check2 || Check3, "The array sizes are"
         " incompatible.");
+    m_size = 0;
     auto beg = other.Begin();
     auto end = other.End();
     for (; beg != end; ++beg)
@@ -395,21 +749,21 @@ Array<DataType, SizeP>::operator=(const Array<DataType2, SizeP2>& other)
 }
 /**Copy from another array.
 \param other The other array to copy.*/
-template<typename DataType, cg::SizeType SizeP>
-Array<DataType, SizeP>&
-Array<DataType, SizeP>::operator=(const SelfType& other)
-{
-    auto beg = other.Begin();
-    auto end = other.End();
-    for (; beg != end; ++beg)
-        PushBack(Forward<DataType>(DataType(*beg)));
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+Array<DataType, SizeP, Spill>&
+Array<DataType, SizeP, Spill>::operator=(const SelfType& other)
+{
+    if (this == &other)
+        return *this;
+    m_size = 0;
+    Append(other);
     return *this;
 }
 /**Create the object with a begin and end.
 \param beg The first poitner.
 \param end One-past-last pointer.*/
-template<typename DataType, cg::SizeType SizeP>
-Array<DataType, SizeP>::Array(DataType* beg, DataType* end)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+Array<DataType, SizeP, Spill>::Array(DataType* beg, DataType* end)
 {
     cg::SizeType sz = end - beg;
     if (sz < 1)
@@ -420,8 +774,8 @@ Array<DataType, SizeP>::Array(DataType* beg, DataType* end)
 /**Set all available space. This will fill memory that is allocated, but
 not marked as "used".
 \param x The thing to set the space too.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::FillUnused(const DataType& x)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::FillUnused(const DataType& x)
 {
     auto p = Begin().Addr();
     for (cg::SizeType i = m_size; i < m_cap; ++i)
@@ -429,40 +783,59 @@ void Array<DataType, SizeP>::FillUnused(const DataType& x)
 }
 /**Get the size of the storage.
 \return The amount of elements.*/
-template<typename DataType, cg::SizeType SizeP>
-cg::SizeType Array<DataType, SizeP>::Size() const
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+cg::SizeType Array<DataType, SizeP, Spill>::Size() const
 {
     return m_size;
 }
 /**Emplace an object to the back of the list.
 \param o The object.*/
-template<typename DataType, cg::SizeType SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
 template<typename...Ts>
-void Array<DataType, SizeP>::EmplaceBack(Ts&&... o)
+void Array<DataType, SizeP, Spill>::EmplaceBack(Ts&&... o)
 {
     Emplace(m_size, Forward<Ts>(o)...);
 }
 /**Emplace an object to the back of the list.
 \param o The object.*/
-template<typename DataType, cg::SizeType SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
 template<typename...Ts>
-void Array<DataType, SizeP>::EmplaceFront(Ts&&... o)
+void Array<DataType, SizeP, Spill>::EmplaceFront(Ts&&... o)
 {
     Emplace(0, Forward<Ts>(o)...);
 }
+/**Copy a run of objects to the back of the list with one grow and one copy.
+\param arr The objects to copy. Must not point into this list.
+\param amt The amount of objects.*/
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::Append(const DataType* arr,
+    cg::SizeType amt)
+{
+    Storage<DataType, SizeP, Spill>::Insert(m_size, arr, amt);
+}
+/**Copy another list to the back of this one with one grow and one copy.
+\param other The list to copy. Must not be this list.*/
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+template<cg::SizeType SizeP2, bool Spill2>
+void Array<DataType, SizeP, Spill>::Append(
+    const Array<DataType, SizeP2, Spill2>& other)
+{
+    Storage<DataType, SizeP, Spill>::Insert(m_size, other.Begin().Addr(),
+        other.Size());
+}
 /**Emplace an element after the position \p it.  \p it will point to the same
 element as it did before.
 \param it The iterator to emplace at.
 \param ts A parameter pack of arguments to send to the constructor
 of \p DataType.
 \return An iterator the the new element.*/
-template<typename DataType, cg::SizeType SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
 template<typename ...Ts>
-inline typename Array<DataType, SizeP>::ReverseIterator
-Array<DataType, SizeP>::EmplaceAfter(ReverseIterator& it, Ts && ...ts)
+inline typename Array<DataType, SizeP, Spill>::ReverseIterator
+Array<DataType, SizeP, Spill>::EmplaceAfter(ReverseIterator& it, Ts && ...ts)
 {
     SizeType position = m_size - (RBegin() - it) - 1;
-    Storage<DataType, SizeP>::Emplace(position, Forward<Ts>(ts)...);
+    Storage<DataType, SizeP, Spill>::Emplace(position, Forward<Ts>(ts)...);
     //move it back to its element.
     it = cg::ArrayIterator<DataType, false, true>(Addr() + (position + 1));
     auto ret = cg::ArrayIterator<DataType, false, true>(Addr() + position);
@@ -474,13 +847,13 @@ element as it did before.
 \param ts A parameter pack of arguments to send to the constructor
 of \p DataType.
 \return An iterator the the new element.*/
-template<typename DataType, cg::SizeType SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
 template<typename ...Ts>
-inline typename Array<DataType, SizeP>::Iterator
-Array<DataType, SizeP>::EmplaceAfter(Iterator& it, Ts && ...ts)
+inline typename Array<DataType, SizeP, Spill>::Iterator
+Array<DataType, SizeP, Spill>::EmplaceAfter(Iterator& it, Ts && ...ts)
 {
     SizeType position = (it - Begin()) + 1;
-    Storage<DataType, SizeP>::Emplace(position, Forward<Ts>(ts)...);
+    Storage<DataType, SizeP, Spill>::Emplace(position, Forward<Ts>(ts)...);
     //move it back to its element.
     it = cg::ArrayIterator<DataType, false, false>(Addr() + (position - 1));
     auto ret = cg::ArrayIterator<DataType, false, false>(Addr() + position);
@@ -492,13 +865,13 @@ element as it did before.
 \param ts A parameter pack of arguments to send to the constructor
 of \p DataType.
 \return An iterator the the new element.*/
-template<typename DataType, cg::SizeType SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
 template<typename ...Ts>
-inline typename Array<DataType, SizeP>::ReverseIterator
-Array<DataType, SizeP>::Emplace(ReverseIterator& it, Ts && ...ts)
+inline typename Array<DataType, SizeP, Spill>::ReverseIterator
+Array<DataType, SizeP, Spill>::Emplace(ReverseIterator& it, Ts && ...ts)
 {
     SizeType position = m_size - (RBegin() - it);
-    Storage<DataType, SizeP>::Emplace(position, Forward<Ts>(ts)...);
+    Storage<DataType, SizeP, Spill>::Emplace(position, Forward<Ts>(ts)...);
     //move it back to its element.
     it = cg::ArrayIterator<DataType, false, true>(Addr() + (position - 1));
     auto ret = cg::ArrayIterator<DataType, false, true>(Addr() + position);
@@ -510,13 +883,13 @@ element as it did before.
 \param ts A parameter pack of arguments to send to the constructor
 of \p DataType.
 \return An iterator the the new element.*/
-template<typename DataType, cg::SizeType SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
 template<typename ...Ts>
-inline typename Array<DataType, SizeP>::Iterator
-Array<DataType, SizeP>::Emplace(Iterator& it, Ts && ...ts)
+inline typename Array<DataType, SizeP, Spill>::Iterator
+Array<DataType, SizeP, Spill>::Emplace(Iterator& it, Ts && ...ts)
 {
     SizeType position = (it - Begin());
-    Storage<DataType, SizeP>::Emplace(position, Forward<Ts>(ts)...);
+    Storage<DataType, SizeP, Spill>::Emplace(position, Forward<Ts>(ts)...);
     //move it back to its element.
     it = cg::ArrayIterator<DataType, false, false>(Addr() + (position + 1));
     auto ret = cg::ArrayIterator<DataType, false, false>(Addr() + position);
@@ -524,23 +897,23 @@ Array<DataType, SizeP>::Emplace(Iterator& it, Ts && ...ts)
 }
 /**Push an object to the back of the list.
 \param o The object.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::PushBack(DataType&& o)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::PushBack(DataType&& o)
 {
     Insert(m_size, Forward<DataType>(o));
 }
 /**Push an object to the front of the list.
 \param o The object.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::PushFront(DataType&& o)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::PushFront(DataType&& o)
 {
     Insert(0, Forward<DataType>(o));
 }
 /**Push an object at the provided index.
 \param i the index to be the index of the pushed item.
 \param d The item to push.*/
-template<typename DataType, cg::SizeType SizeP>
-inline void Array<DataType, SizeP>::Push(cg::SizeType i, DataType&& d)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline void Array<DataType, SizeP, Spill>::Push(cg::SizeType i, DataType&& d)
 {
     Insert(i, Forward<DataType>(d));
 }
@@ -549,9 +922,9 @@ to the same element it started with when finished.
 \param it The iterator that is the position to push to.
 \param d The data to push.
 \return An iterator to the new element.*/
-template<typename DataType, cg::SizeType SizeP>
-inline typename Array<DataType, SizeP>::ReverseIterator
-cg::Array<DataType, SizeP>::Push(ReverseIterator& it, DataType && d)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline typename Array<DataType, SizeP, Spill>::ReverseIterator
+cg::Array<DataType, SizeP, Spill>::Push(ReverseIterator& it, DataType && d)
 {
     SizeType position = m_size - (RBegin() - it);
     Push(position, Forward<DataType>(d));
@@ -565,9 +938,9 @@ to the same element it started with when finished.
 \param it The iterator that is the position to push to.
 \param d The data to push.
 \return An iterator to the new element.*/
-template<typename DataType, cg::SizeType SizeP>
-inline typename Array<DataType, SizeP>::Iterator
-cg::Array<DataType, SizeP>::Push(Iterator& it, DataType && d)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline typename Array<DataType, SizeP, Spill>::Iterator
+cg::Array<DataType, SizeP, Spill>::Push(Iterator& it, DataType && d)
 {
     SizeType position = (it - Begin());
     Push(position, Forward<DataType>(d));
@@ -581,9 +954,9 @@ to the same element it started with when finished.
 \param it The iterator to insert after.
 \param d The item to push.
 \return an iterator pointing to the newly inserted element.*/
-template<typename DataType, cg::SizeType SizeP>
-inline typename Array<DataType, SizeP>::Iterator
-Array<DataType, SizeP>::PushAfter(Iterator& it, DataType&& d)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline typename Array<DataType, SizeP, Spill>::Iterator
+Array<DataType, SizeP, Spill>::PushAfter(Iterator& it, DataType&& d)
 {
     SizeType position = (it - Begin()) + 1;
     Push(position, Forward<DataType>(d));
@@ -597,9 +970,9 @@ to the same element it started with when finished.
 \param it The iterator to insert after.
 \param d The item to push.
 \return an iterator pointing to the newly inserted element.*/
-template<typename DataType, cg::SizeType SizeP>
-inline typename Array<DataType, SizeP>::ReverseIterator
-Array<DataType, SizeP>::PushAfter(ReverseIterator& it, DataType&& d)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline typename Array<DataType, SizeP, Spill>::ReverseIterator
+Array<DataType, SizeP, Spill>::PushAfter(ReverseIterator& it, DataType&& d)
 {
     SizeType position = m_size - (RBegin() - it) - 1;
     Push(position, Forward<DataType>(d));
@@ -611,8 +984,8 @@ Array<DataType, SizeP>::PushAfter(ReverseIterator& it, DataType&& d)
 /**Get an element.
 \param i The index to get.
 \return The object at i.*/
-template<typename DataType, cg::SizeType SizeP>
-DataType& Array<DataType, SizeP>::Get(cg::SizeType i)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+DataType& Array<DataType, SizeP, Spill>::Get(cg::SizeType i)
 {
     if (i >= m_size)
         throw ArrayException::IndexOutOfBounds;
@@ -621,8 +994,8 @@ DataType& Array<DataType, SizeP>::Get(cg::SizeType i)
 /**Get an element without any dereference layer.
 \param i The index to get.
 \return The object at i.*/
-template<typename DataType, cg::SizeType SizeP>
-const DataType& Array<DataType, SizeP>::Get(cg::SizeType i) const
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+const DataType& Array<DataType, SizeP, Spill>::Get(cg::SizeType i) const
 {
     if (i >= m_size)
         throw ArrayException::IndexOutOfBounds;
@@ -631,8 +1004,8 @@ const DataType& Array<DataType, SizeP>::Get(cg::SizeType i) const
 /**Get an element.
 \param i The index to get.
 \return The object at i.*/
-template<typename DataType, cg::SizeType SizeP>
-DataType& Array<DataType, SizeP>::operator[](cg::SizeType i)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+DataType& Array<DataType, SizeP, Spill>::operator[](cg::SizeType i)
 {
     if (i > m_size)
         throw ArrayException::IndexOutOfBounds;
@@ -641,8 +1014,8 @@ DataType& Array<DataType, SizeP>::operator[](cg::SizeType i)
 /**Get an element.
 \param i The index to get.
 \return The object at i.*/
-template<typename DataType, cg::SizeType SizeP>
-const DataType& Array<DataType, SizeP>::operator[](cg::SizeType i) const
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+const DataType& Array<DataType, SizeP, Spill>::operator[](cg::SizeType i) const
 {
     if (i >= m_size)
         throw ArrayException::IndexOutOfBounds;
@@ -650,85 +1023,93 @@ const DataType& Array<DataType, SizeP>::operator[](cg::SizeType i) const
 }
 /**Get the begin iterator.
 \return An iterator to the front of the list.*/
-template<typename DataType, cg::SizeType SizeP>
-typename Array<DataType, SizeP>::Iterator Array<DataType, SizeP>::Begin()
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+typename Array<DataType, SizeP, Spill>::Iterator
+Array<DataType, SizeP, Spill>::Begin()
 {
     return Iterator(Addr());
 }
 /**Get the begin iterator.
 \return An iterator to the front of the list.*/
-template<typename DataType, cg::SizeType SizeP>
-typename Array<DataType, SizeP>::ConstIterator Array<DataType, SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+typename Array<DataType, SizeP, Spill>::ConstIterator
+Array<DataType, SizeP, Spill>
 ::Begin()const
 {
     return ConstIterator(Addr());
 }
 /**Get the begin iterator.
 \return An iterator to the front of the list.*/
-template<typename DataType, cg::SizeType SizeP>
-typename Array<DataType, SizeP>::ReverseIterator Array<DataType, SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+typename Array<DataType, SizeP, Spill>::ReverseIterator
+Array<DataType, SizeP, Spill>
 ::RBegin()
 {
     return ReverseIterator(Addr() + (m_size - 1));
 }
 /**Get the begin iterator.
 \return An iterator to the front of the list.*/
-template<typename DataType, cg::SizeType SizeP>
-typename Array<DataType, SizeP>::ConstReverseIterator Array<DataType, SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+typename Array<DataType, SizeP, Spill>::ConstReverseIterator
+Array<DataType, SizeP, Spill>
 ::RBegin() const
 {
     return ConstReverseIterator(Addr() + (m_size - 1));
 }
 /**Get an iterator to the end+1 of the list.
 \return An iterator to End+1*/
-template<typename DataType, cg::SizeType SizeP>
-typename Array<DataType, SizeP>::Iterator Array<DataType, SizeP>::End()
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+typename Array<DataType, SizeP, Spill>::Iterator
+Array<DataType, SizeP, Spill>::End()
 {
     return Iterator(Addr() + m_size);
 }
 /**Get an iterator to the end+1 of the list.
 \return An iterator to End+1*/
-template<typename DataType, cg::SizeType SizeP>
-typename Array<DataType, SizeP>::ConstIterator Array<DataType, SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+typename Array<DataType, SizeP, Spill>::ConstIterator
+Array<DataType, SizeP, Spill>
 ::End() const
 {
     return ConstIterator(Addr() + m_size);
 }
 /**Get an iterator to the end+1 of the list.
 \return An iterator to End+1*/
-template<typename DataType, cg::SizeType SizeP>
-typename Array<DataType, SizeP>::ReverseIterator Array<DataType, SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+typename Array<DataType, SizeP, Spill>::ReverseIterator
+Array<DataType, SizeP, Spill>
 ::REnd()
 {
     return ReverseIterator(Addr() - 1);
 }
 /**Get an iterator to the end+1 of the list.
 \return An iterator to End+1*/
-template<typename DataType, cg::SizeType SizeP>
-typename Array<DataType, SizeP>::ConstReverseIterator Array<DataType, SizeP>
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+typename Array<DataType, SizeP, Spill>::ConstReverseIterator
+Array<DataType, SizeP, Spill>
 ::REnd() const
 {
     return ConstReverseIterator(Addr() - 1);
 }
 /**Erase a unit from the storage.
 \param i The index to erase.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::Erase(cg::SizeType i)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::Erase(cg::SizeType i)
 {
-    Array<DataType, SizeP>::Erase(i, 1);
+    Array<DataType, SizeP, Spill>::Erase(i, 1);
 }
 /**Erase a unit from the storage.
 \param i The index to erase.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::Pop(cg::SizeType i)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::Pop(cg::SizeType i)
 {
     Erase(i);
 }
 /**Erase a unit from the storage.
 \param i The index to erase.
 \param s The amount to erase in elements.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::Erase(cg::SizeType i, cg::SizeType s)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::Erase(cg::SizeType i, cg::SizeType s)
 {
     if (!Addr())
         throw ArrayException::ListEmpty;
@@ -739,70 +1120,70 @@ void Array<DataType, SizeP>::Erase(cg::SizeType i, cg::SizeType s)
 /**Erase a unit from the storage.
 \param i The index to erase.
 \param s The amount to erase in elements.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::Pop(cg::SizeType i, cg::SizeType s)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::Pop(cg::SizeType i, cg::SizeType s)
 {
     Erase(i, s);
 }
 /**Pop off the last element.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::PopBack()
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::PopBack()
 {
     Erase(m_size - 1);
 }
 /**Pop off the last element.
 \param amt The amount to pop at the end.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::PopBack(cg::SizeType amt)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::PopBack(cg::SizeType amt)
 {
     Erase(m_size - amt, amt);
 }
 /**Pop the front element.*/
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::PopFront()
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::PopFront()
 {
     Erase(0);
 }
 /**Pop the front element.
 \param amt The amount to pop at the front */
-template<typename DataType, cg::SizeType SizeP>
-void Array<DataType, SizeP>::PopFront(cg::SizeType amt)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+void Array<DataType, SizeP, Spill>::PopFront(cg::SizeType amt)
 {
     Erase(0, amt);
 }
 /**Determine the total cap of the list.
 \return The max amout for this list, or 0 for no maximum.*/
-template<typename DataType, cg::SizeType SizeP>
-cg::SizeType Array<DataType, SizeP>::MaxSize() const
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+cg::SizeType Array<DataType, SizeP, Spill>::MaxSize() const
 {
-    return SizeP;
+    return Spill ? 0 : SizeP;
 }
 
 /**Get the item at the back of the list.
 \return The item at the back of the list.*/
-template<typename DataType, cg::SizeType SizeP>
-inline const DataType & Array<DataType, SizeP>::Back() const
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline const DataType & Array<DataType, SizeP, Spill>::Back() const
 {
     return Addr()[Size() - 1];
 }
 /**Get the item at the back of the list.
 \return The item at the back of the list.*/
-template<typename DataType, cg::SizeType SizeP>
-inline DataType & Array<DataType, SizeP>::Back()
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline DataType & Array<DataType, SizeP, Spill>::Back()
 {
     return Addr()[Size() - 1];
 }
 /**Get the item at the front of the list.
 \return The item at the front of the list.*/
-template<typename DataType, cg::SizeType SizeP>
-inline const DataType & Array<DataType, SizeP>::Front() const
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline const DataType & Array<DataType, SizeP, Spill>::Front() const
 {
     return Addr()[0];
 }
 /**Get the item at the front of the list.
 \return The item at the front of the list.*/
-template<typename DataType, cg::SizeType SizeP>
-inline DataType & Array<DataType, SizeP>::Front()
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline DataType & Array<DataType, SizeP, Spill>::Front()
 {
     return Addr()[0];
 }
@@ -810,16 +1191,17 @@ inline DataType & Array<DataType, SizeP>::Front()
 \param amt The amount to reserve.
 \return True if the array can hold at least \p amt. False if the array cannot
 hold \p amt for any reason (like it has a compiletime size restriction).*/
-template<typename DataType, cg::SizeType SizeP>
-inline bool Array<DataType, SizeP>::Reserve(SizeType amt)
+template<typename DataType, cg::SizeType SizeP, bool Spill>
+inline bool Array<DataType, SizeP, Spill>::Reserve(SizeType amt)
 {
     if (MaxSize() != 0 && MaxSize() < amt)
         return false;
-    Storage<DataType, SizeP>::ExpandTo(amt);
+    Storage<DataType, SizeP, Spill>::ExpandTo(amt);
     return true;
 }
 
 template class Array<int, 0>;
 template class Array<int, 1>;
+template class Array<int, 4, true>;
 
 }
\ No newline at end of file
@@ -21,6 +21,12 @@ along with _PROJECT_NAME_.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+
 #include "ArrayIterator.hpp"
 
 
@@ -36,6 +42,20 @@ enum class ArrayException {
     InvalidParameter,
     /**The list is empty.*/
     ListEmpty,
+    /**Memory could not be had.*/
+    OutOfMemory,
+};
+
+/**Determine if a type can be moved to new memory with a plain memcpy, and
+the old bytes dropped without calling a destructor.  True for trivially
+copyable types.  Specialize it for other types that own nothing that points
+back at themselves, so Array can move them with realloc and memcpy too.
+\tparam T The type.*/
+template<typename T>
+struct IsTriviallyRelocatable
+{
+    /**True if T can be moved bitwise.*/
+    static const bool value = std::is_trivially_copyable<T>::value;
 };
 
 
@@ -43,12 +63,21 @@ enum class ArrayException {
 ////////////////////////////////////////////////////STACK HERE/////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**The data holding portion of the Array.
+\tparam DataType The type of data to use.
+\tparam Size, The size of the list on the stack, or ZERO to be heap-expanding.
+\tparam Spill True to keep the first \p Size elements on the stack and move
+to the heap when more are added.
+*/
+template<typename DataType, cg::SizeType SizeP, bool Spill = false>
+class Storage;
+
 /**The data holding portion of the Array.
 \tparam DataType The type of data to use.
 \tparam Size, The size of the list on the stack, or ZERO to be heap-expanding.
 */
 template<typename DataType, cg::SizeType SizeP>
-class Storage
+class Storage<DataType, SizeP, false>
 {
 public:
     /**The type of this object.*/
@@ -71,6 +100,8 @@ public:
     template<typename NType>
     void Insert(cg::SizeType i, NType&& o);
 
+    void Insert(cg::SizeType i, const DataType* arr, cg::SizeType amt);
+
     template<typename...Ts>
     void Emplace(cg::SizeType i, Ts&&... nums);
 protected:
@@ -107,7 +138,7 @@ class Storage<DataType, 0>
 public:
     /**The type of this object.*/
     using SelfType = typename Storage<DataType, 0>;
-    /**The amount to expand when re allocating.*/
+    /**The least amount to expand by when re allocating.*/
     const static cg::SizeType ExpandAmount = 8;
 
     Storage(cg::SizeType cap = 0);
@@ -127,11 +158,19 @@ public:
     template<typename NType>
     void Insert(cg::SizeType i, NType&& o);
 
+    void Insert(cg::SizeType i, const DataType* arr, cg::SizeType amt);
+
     template<typename...Ts>
     void Emplace(cg::SizeType i, Ts&&... nums);
+
+    void GrowthFactor(float factor);
+
+    float GrowthFactor() const;
 private:
     /**The storage area.*/
     DataType* m_data;
+    /**The capacity is multiplied by this when the storage fills up.*/
+    float m_growth = 2.0f;
 protected:
     /**Stop copying*/
     Storage(const SelfType&) = delete;
@@ -144,6 +183,84 @@ protected:
 
     void ExpandTo(cg::SizeType amt);
 
+    cg::SizeType Grown(cg::SizeType amt) const;
+
+    DataType* Addr(cg::SizeType i = 0);
+
+    const DataType* Addr(cg::SizeType i = 0)const;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////SPILL HERE//////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**The data holding portion of the Array.  The first SizeP elements are kept
+inline, so small lists never allocate.  When one more is added, everything
+moves to the heap and it grows like the heap storage from then on.
+\tparam DataType The type of data to use.
+\tparam Size, The amount of elements to keep inline.
+*/
+template<typename DataType, cg::SizeType SizeP>
+class Storage<DataType, SizeP, true>
+{
+public:
+    static_assert(SizeP > 0, "A spilling storage needs an inline size.");
+    /**The type of this object.*/
+    using SelfType = typename Storage<DataType, SizeP, true>;
+    /**The least amount to expand by when re allocating.*/
+    const static cg::SizeType ExpandAmount = 8;
+
+    Storage(cg::SizeType cap = 0);
+
+    Storage(const DataType* arr, cg::SizeType aSize);
+
+    Storage(SelfType&& other);
+
+    Storage(std::initializer_list<DataType>&& vals);
+
+    void operator=(SelfType&& other);
+
+    virtual ~Storage();
+
+    bool CanInsert() const;
+
+    template<typename NType>
+    void Insert(cg::SizeType i, NType&& o);
+
+    void Insert(cg::SizeType i, const DataType* arr, cg::SizeType amt);
+
+    template<typename...Ts>
+    void Emplace(cg::SizeType i, Ts&&... nums);
+
+    void GrowthFactor(float factor);
+
+    float GrowthFactor() const;
+
+    bool IsInline() const;
+private:
+    /**The elements. Points at m_inline until the storage spills.*/
+    DataType* m_data;
+    /**The capacity is multiplied by this when the storage fills up.*/
+    float m_growth = 2.0f;
+    /**The inline storage area.  Units of char so that the values are not
+    initialized.*/
+    alignas(DataType) char m_inline[SizeP * sizeof(DataType)];
+
+    void TakeFrom(SelfType& other);
+protected:
+    /**Stop copying*/
+    Storage(const SelfType&) = delete;
+    /**Stop copying*/
+    void operator=(const SelfType&) = delete;
+    /**The maximum capacity of the storage*/
+    cg::SizeType m_cap;
+    /**The size of used up slots*/
+    cg::SizeType m_size;
+
+    void ExpandTo(cg::SizeType amt);
+
+    cg::SizeType Grown(cg::SizeType amt) const;
+
     DataType* Addr(cg::SizeType i = 0);
 
     const DataType* Addr(cg::SizeType i = 0)const;
@@ -155,13 +272,15 @@ protected:
 
 /**An array based list.
 \tparam DataType The type of data.
-\tparam SizeP THe size of the array. `0` to be auto-expanding.*/
-template<typename DataType, cg::SizeType SizeP>
-class Array : public Storage<DataType, SizeP>
+\tparam SizeP THe size of the array. `0` to be auto-expanding.
+\tparam Spill True to keep up to \p SizeP elements inline and spill to the
+heap past that, instead of throwing ArrayIsFull.*/
+template<typename DataType, cg::SizeType SizeP, bool Spill = false>
+class Array : public Storage<DataType, SizeP, Spill>
 {
 public:
     /**The type of this object.*/
-    using SelfType = typename Array<DataType, SizeP>;
+    using SelfType = typename Array<DataType, SizeP, Spill>;
     /**A reverse moving iterator type*/
     using ReverseIterator = ArrayIterator<DataType, false, true>;
     /**The standard forward iterator*/
@@ -172,6 +291,8 @@ public:
     using ConstIterator = ArrayIterator<DataType, true, false>;
     /**The amount to expand when re allocating.*/
     const static cg::SizeType ExpandAmount = 8;
+    /**The capacity a default made list starts with.*/
+    const static cg::SizeType InitialCap = Spill ? SizeP : ExpandAmount;
 
     Array(cg::SizeType initCap);
 
@@ -185,15 +306,15 @@ public:
 
     Array(std::initializer_list<DataType>&& vals);
 
-    template<typename DataType2, cg::SizeType SizeP2>
-    Array(const Array<DataType2, SizeP2>& other);
+    template<typename DataType2, cg::SizeType SizeP2, bool Spill2>
+    Array(const Array<DataType2, SizeP2, Spill2>& other);
 
     Array(const SelfType& other);
 
-    template<typename DataType2, cg::SizeType SizeP2>
-    Array<DataType, SizeP>& operator=(const Array<DataType2, SizeP2>& other);
+    template<typename DataType2, cg::SizeType SizeP2, bool Spill2>
+    SelfType& operator=(const Array<DataType2, SizeP2, Spill2>& other);
 
-    Array<DataType, SizeP>& operator=(const SelfType& other);
+    SelfType& operator=(const SelfType& other);
 
     Array(DataType* beg, DataType* end);
 
@@ -208,6 +329,11 @@ public:
     template<typename...Ts>
     void EmplaceFront(Ts&&... o);
 
+    void Append(const DataType* arr, cg::SizeType amt);
+
+    template<cg::SizeType SizeP2, bool Spill2>
+    void Append(const Array<DataType, SizeP2, Spill2>& other);
+
     void PushBack(DataType&& o);
 
     void PushFront(DataType&& o);
@@ -18,310 +18,541 @@ You should have received a copy of the GNU General Public License
 along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
 
 */
+
 #pragma once
 
 #include "ArrayHeapDef.hpp"
 
 namespace cg {
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    const Predicate ArrayHeap<DataType, KeyType, Size, Predicate>::pred;
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    const Predicate
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::pred;
 
 /**Create with an initial amount of levels. If the template parameter \p Size
 is non-zero, \p init will be meaningless, as the amount of levels are set at
 compile time.
 \param init The amount of levels to be immediatly reserved.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline ArrayHeap<DataType, KeyType, Size, Predicate>::ArrayHeap(
-        SizeType init) :m_data(RTPower(2, init) - 1)
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::ArrayHeap(
+        SizeType init) :m_store((RTPower(Arity, init) - 1) / (Arity - 1))
 {
 
+}
+/**Create with a range of pairs in O(n).  The item at offset i gets handle i.
+\param first The first pair.
+\param last One past the last pair.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    template<typename Iter>
+    inline
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::ArrayHeap(
+        Iter first, Iter last) :m_store(SizeType(0))
+{
+    Heapify(first, last);
 }
 /**Emplace an object on the tree. Will automatically rearrange the tree to be
 balanced and complete.
-\param ts The arguments to forward to the constructor.*/
+\param key The key.
+\param ts The arguments to forward to the constructor.
+\return The handle of the new item.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
     template<typename ...Ts>
-inline void ArrayHeap<DataType, KeyType, Size, Predicate>::Emplace(
+inline typename
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Handle
+ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Emplace(
     KeyType&& key, Ts && ...ts)
 {
-    if (Full())
-        throw ArrayheapException::FullArray;
-    m_data.PushBack(PairType());
-    new (&m_data.Back().m_a) DataType(Forward<Ts>(ts)...);
-    m_data.Back().m_b = Forward<KeyType>(key);
-    FixUp(m_data.Size() - 1);
+    return Insert(PairType(DataType(Forward<Ts>(ts)...),
+        Forward<KeyType>(key)));
 }
 /**Push an object to the tree. Will automatically rearrange the tree to be
 balanced and complete.
-\param o The object to push.*/
+\param key The key.
+\param o The object to push.
+\return The handle of the new item.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline void
-    ArrayHeap<DataType, KeyType, Size, Predicate>::Push(
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Handle
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Push(
         KeyType&& key, DataType && o)
 {
-    if (Full())
-        throw ArrayheapException::FullArray;
-    m_data.PushBack(MakePair(Forward<DataType>(o), Forward<KeyType>(key)));
-    FixUp(m_data.Size() - 1);
+    return Insert(PairType(Forward<DataType>(o), Forward<KeyType>(key)));
 }
 /**insert a pair into the tree.
-\param p The pair to insert.*/
+\param p The pair to insert.
+\return The handle of the new item.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline void ArrayHeap<DataType, KeyType, Size, Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Handle
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
     ::Push(PairType && p)
 {
-    if (Full())
+    return Insert(Forward<PairType>(p));
+}
+/**Add a range of pairs and rebuild the tree once, bottom up, in O(n) for n
+items in the heap, instead of O(n log n) for n pushes.  If the heap was empty,
+the item at offset i of the range gets handle i.
+\param first The first pair.
+\param last One past the last pair.
+\throw ArrayheapException::FullArray if the items do not fit. The ones that
+did fit are kept.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    template<typename Iter>
+inline void
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Heapify(
+    Iter first, Iter last)
+{
+    if (Empty())
+        Clear();
+    bool full = false;
+    for (; first != last; ++first)
+    {
+        if (Full())
+        {
+            full = true;
+            break;
+        }
+        Handle h = NewHandle(m_store.Size());
+        m_store.PushBack(PairType(*first), h);
+        m_handles.PushBack(Handle(h));
+    }
+    /*every node past the parent of the last one is a leaf already.*/
+    SizeType n = m_store.Size();
+    if (n > 1)
+        for (SizeType i = Parent(n - 1) + 1; i-- > 0;)
+            FixDown(i);
+    if (full)
         throw ArrayheapException::FullArray;
-    m_data.PushBack(Forward<PairType>(p));
-    FixUp(m_data.Size() - 1);
 }
 /**Pop the top item off the heap.*/
-template<typename DataType, typename KeyType, SizeType Size, typename Predicate>
-inline void ArrayHeap<DataType, KeyType, Size, Predicate>::Pop()
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+inline void ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Pop()
 {
     if (Empty())
         throw ArrayheapException::EmptyArray;
-    Swap(m_data.Front(), m_data.Back());
-    m_data.PopBack();
-    if (!Empty())
-        FixDown(0);
+    RemoveAt(0);
+}
+/**Remove an item from anywhere in the heap.
+\param h The handle of the item.
+\throw ArrayheapException::BadHandle if \p h is not in the heap.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+inline void ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Erase(Handle h)
+{
+    RemoveAt(SlotOf(h));
+}
+/**Change the key of an item. The item moves up or down to where the new key
+belongs, so this is decrease-key and increase-key both.
+\param h The handle of the item.
+\param key The new key.
+\throw ArrayheapException::BadHandle if \p h is not in the heap.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+inline void ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::ChangeKey(Handle h, KeyType&& key)
+{
+    SizeType i = SlotOf(h);
+    m_store.KeyAt(i) = Forward<KeyType>(key);
+    Restore(i);
+}
+/**Determine if a handle names an item in the heap.
+\param h The handle.
+\return True if the item has not been popped or erased.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+inline bool
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Contains(
+    Handle h) const
+{
+    return h < m_where.Size() && !(m_where[h] & FreeBit);
+}
+/**Get the data of an item.
+\param h The handle of the item.
+\return A reference to the data.
+\throw ArrayheapException::BadHandle if \p h is not in the heap.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+inline DataType & ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Get(Handle h)
+{
+    return m_store.DataAt(SlotOf(h), h);
+}
+/**Get the data of an item.
+\param h The handle of the item.
+\return A reference to the data.
+\throw ArrayheapException::BadHandle if \p h is not in the heap.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+inline const DataType &
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Get(Handle h) const
+{
+    return m_store.DataAt(SlotOf(h), h);
+}
+/**Get the key of an item.
+\param h The handle of the item.
+\return A const reference to the key.
+\throw ArrayheapException::BadHandle if \p h is not in the heap.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+inline const KeyType &
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::GetKey(Handle h) const
+{
+    return KeyAt(SlotOf(h));
 }
 /**Get the data of the top element.
 \return A reference to the data on top of the heap.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline DataType & ArrayHeap<DataType, KeyType, Size, Predicate>::Top()
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline DataType &
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Top()
 {
-    return m_data[0].m_a;
+    return m_store.DataAt(0, m_handles[0]);
 }
 /**Get the data of the top element.
 \return A reference to the data on top of the heap.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline const DataType & ArrayHeap<DataType, KeyType, Size, Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline const DataType &
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
     ::Top() const
 {
-    return m_data[0].m_a;
+    return m_store.DataAt(0, m_handles[0]);
 }
 /**Get the key of the top element.
 \return A const reference to the key on top of the heap.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline const KeyType & ArrayHeap<DataType, KeyType, Size, Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline const KeyType &
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
     ::TopKey() const
 {
-    return m_data[0].m_b;
+    return m_store.KeyAt(0);
+}
+/**Get the handle of the top element.
+\return The handle of the item on top of the heap.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Handle
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::TopHandle() const
+{
+    return m_handles[0];
 }
 /**Determine if the heap is empty or not.
 \return True if the heap is empty.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline bool ArrayHeap<DataType, KeyType, Size, Predicate>::Empty() const
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline bool ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Empty() const
 {
-    return m_data.Size() == 0;
+    return m_store.Size() == 0;
 }
 /**Determine if the heap is full or not.
 \return True if the heap is full.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline bool ArrayHeap<DataType, KeyType, Size, Predicate>::Full() const
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline bool ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Full() const
 {
-    return m_data.Size() == Size && Size != 0;
+    return Size != 0 && m_store.Size() == TreeSize<Size, Arity>::value;
+}
+/**Get the amount of items in the heap.
+\return The amount of items.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline SizeType ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Count() const
+{
+    return m_store.Size();
+}
+/**Remove every item. All handles are let go.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline void
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Clear()
+{
+    m_store.Clear();
+    if (m_handles.Size())
+        m_handles.PopBack(m_handles.Size());
+    if (m_where.Size())
+        m_where.PopBack(m_where.Size());
+    m_freeHandle = NoHandle;
 }
 /**Show the keys of the items in the heap.
 \param out A stream to take output.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
     template<typename OutStream>
-inline void ArrayHeap<DataType, KeyType, Size, Predicate>::ShowKeys(
+inline void
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::ShowKeys(
     OutStream & out) const
 {
     SizeType printed = 0;
-    SizeType pow = 0;
-    while (printed < m_data.Size())
+    SizeType amt = 1;
+    while (printed < m_store.Size())
     {
-        int amt = 1 << pow;
-        for (SizeType i = 0; i < amt && printed < m_data.Size(); ++i)
+        for (SizeType i = 0; i < amt && printed < m_store.Size(); ++i)
         {
             out << KeyAt(printed++) << " ";
         }
         out << "\n";
-        ++pow;
+        amt *= Arity;
     }
 }
-/**Fix the tree into its proper binary search relationship after inserting an
-item.
-\param index The index for which to start.*/
+/**Add a pair at the bottom and move it up to its place.
+\param p The pair.
+\return The handle of the new item.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline void ArrayHeap<DataType, KeyType, Size, Predicate>::FixUp(
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Handle
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Insert(PairType && p)
+{
+    if (Full())
+        throw ArrayheapException::FullArray;
+    Handle h = NewHandle(m_store.Size());
+    m_store.PushBack(Forward<PairType>(p), h);
+    m_handles.PushBack(Handle(h));
+    FixUp(m_store.Size() - 1);
+    return h;
+}
+/**Move the item at \p index up while it belongs above its parent.  The item
+is held aside and the parents slide down into the hole, so each level costs
+one move instead of a swap.
+\param index The index for which to start.
+\return The index the item ended up at.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline SizeType
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::FixUp(
         SizeType index)
 {
-    if (index == 0)
-        return;
-    KeyType n = KeyAt(index);
-    SizeType pIndex = Parent(index);
-    KeyType p = KeyAt(pIndex);
-    //swap if the node should occure before its parent.
-    bool swapIt = pred(n, p);
-    if (swapIt)
-    {
-        Swap(m_data[index], m_data[pIndex]);
-        FixUp(pIndex);
-    }
+    if (index == 0 || !pred(KeyAt(index), KeyAt(Parent(index))))
+        return index;
+    Held item = m_store.Take(index);
+    Handle h = m_handles[index];
+    do {
+        SizeType p = Parent(index);
+        Place(index, p);
+        index = p;
+    } while (index != 0
+        && pred(StoreType::KeyOf(item), KeyAt(Parent(index))));
+    m_store.Put(index, Move(item));
+    m_handles[index] = h;
+    m_where[h] = index;
+    return index;
 }
-/**Fix the tree into its proper binary search relationship after popping an
-item.
+/**Move the item at \p index down while one of its children belongs above
+it.  The best of the Arity children is found with one pass over them, since
+they sit next to each other.
 \param index The index for which to start.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline void ArrayHeap<DataType, KeyType, Size, Predicate>::FixDown(
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline void
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::FixDown(
         SizeType index)
 {
-    SizeType l = LeftChild(index);
-    SizeType r = RightChild(index);
-    KeyType lk = KeyAt(l);
-    KeyType rk = KeyAt(r);
-    SizeType swapIndex = 0;
-    if (l && r)
-        swapIndex = pred(lk, rk) ? l : r;
-    else if (r)
-        swapIndex = r;
-    else if (l)
-        swapIndex = l;
-    else
+    SizeType n = m_store.Size();
+    SizeType first = FirstChild(index);
+    if (first >= n)
         return;
-    KeyType k = KeyAt(index);
-    KeyType sk = KeyAt(swapIndex);
-    bool doIt = pred(sk, k);
-    if (doIt)
+    Held item = m_store.Take(index);
+    Handle h = m_handles[index];
+    while (first < n)
     {
-        Swap(m_data[index], m_data[swapIndex]);
-        FixDown(swapIndex);
+        SizeType last = first + Arity < n ? first + Arity : n;
+        SizeType best = first;
+        for (SizeType c = first + 1; c < last; ++c)
+            if (pred(KeyAt(c), KeyAt(best)))
+                best = c;
+        if (!pred(KeyAt(best), StoreType::KeyOf(item)))
+            break;
+        Place(index, best);
+        index = best;
+        first = FirstChild(index);
     }
+    m_store.Put(index, Move(item));
+    m_handles[index] = h;
+    m_where[h] = index;
 }
-/**Quick reference to the key at an index.
-\param index The index for which to get the key.*/
+/**Move the item at \p index to where its key belongs.
+\param index The index of the item.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate> inline const KeyType &
-    ArrayHeap<DataType, KeyType, Size, Predicate>::KeyAt(SizeType index)const
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline void
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Restore(
+        SizeType index)
 {
-    return m_data[index].m_b;
+    if (FixUp(index) == index)
+        FixDown(index);
 }
-/**Determine the index of the left child of the object at \p index
-@param index The index for which to get the child.
-@return The index of the child of the object at \p index, or ZERO if there is
-no child.*/
+/**Remove the item at an index. The last item fills the hole and is moved to
+where it belongs.
+\param index The index of the item.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline SizeType
-    ArrayHeap<DataType, KeyType, Size, Predicate>::LeftChild(SizeType index)
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline void
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::RemoveAt(
+        SizeType index)
 {
-    SizeType newIndex = (2 * index) + 1;
-    return newIndex < m_data.Size() ? newIndex : 0;
+    Handle h = m_handles[index];
+    m_store.Release(h);
+    FreeHandle(h);
+    SizeType last = m_store.Size() - 1;
+    if (index != last)
+        Place(index, last);
+    m_store.PopBack();
+    m_handles.PopBack();
+    if (index != last)
+        Restore(index);
 }
-/**Determine the index of the right child of the object at \p index
-@param index The index for which to get the child.
-@return The index of the child of the object at \p index, or ZERO if there is
-no child.*/
+/**Move the item in one slot to another and keep its handle pointing at it.
+\param to The slot to fill.
+\param from The slot to take from.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline SizeType
-    ArrayHeap<DataType, KeyType, Size, Predicate>::RightChild(SizeType index)
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline void
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Place(
+        SizeType to, SizeType from)
 {
-    SizeType newIndex = (2 * index) + 2;
-    return newIndex < m_data.Size() ? newIndex : 0;
+    m_store.MoveTo(to, from);
+    Handle h = m_handles[from];
+    m_handles[to] = h;
+    m_where[h] = to;
 }
-/**Determine the index of the parent of the object at \p index
-\param index The index for which to get the parent.
-\return The index of the parent of the object at \p index, or ZERO if there is
-no parent (happens when index is root index (0) ).*/
+/**Get an unused handle, reusing a free one if there is one.
+\param slot The slot the item is in.
+\return The handle.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline SizeType
-    ArrayHeap<DataType, KeyType, Size, Predicate>::Parent(SizeType index)
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Handle
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::NewHandle(SizeType slot)
 {
-    return (index - 1) / 2;
+    if (m_freeHandle == NoHandle)
+    {
+        m_where.PushBack(SizeType(slot));
+        return m_where.Size() - 1;
+    }
+    Handle h = m_freeHandle;
+    m_freeHandle = m_where[h] & ~FreeBit;
+    m_where[h] = slot;
+    return h;
 }
-/**Determine if an index is the left child of another index.
-\param index The index of the child in question.
-\param parant The parent index to test.
-\return True if \p index is the left child of \p paretn.*/
+/**Put a handle on the free list.
+\param h The handle.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline bool ArrayHeap<DataType, KeyType, Size, Predicate>
-    ::IsLeftChild(SizeType index, SizeType parent)
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline void ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::FreeHandle(Handle h)
 {
-    return SizeType();
+    m_where[h] = m_freeHandle | FreeBit;
+    m_freeHandle = h;
 }
-/**Determine if an index is the right child of another index.
-\param index The index of the child in question.
-\param parant The parent index to test.
-\return True if \p index is the right child of \p paretn.*/
+/**Get the slot of the item a handle names.
+\param h The handle.
+\return The index of the item in m_store.
+\throw ArrayheapException::BadHandle if \p h is not in the heap.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline bool ArrayHeap<DataType, KeyType, Size, Predicate>
-    ::IsRightChild(SizeType index, SizeType parent)
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline SizeType ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::SlotOf(Handle h) const
 {
-    return SizeType();
+    if (!Contains(h))
+        throw ArrayheapException::BadHandle;
+    return m_where[h];
 }
-/**Determine if an index is the parent of another index.
-\param index The parent in question.
-\param child The child index is question.*/
+/**Quick reference to the key at an index.
+\param index The index for which to get the key.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline bool ArrayHeap<DataType, KeyType, Size, Predicate>::IsParent(
-        SizeType index, SizeType child)
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline const KeyType &
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::KeyAt(SizeType index)const
+{
+    return m_store.KeyAt(index);
+}
+/**Determine the index of the first child of the object at \p index.  The
+children are the Arity indexes starting there.
+@param index The index for which to get the child.
+@return The index of the first child. It may be past the end.*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline SizeType
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::FirstChild(SizeType index)
+{
+    return Arity * index + 1;
+}
+/**Determine the index of the parent of the object at \p index
+\param index The index for which to get the parent.
+\return The index of the parent of the object at \p index. Not valid for the
+root index (0).*/
+template<typename DataType, typename KeyType, SizeType Size,
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline SizeType
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
+    ::Parent(SizeType index)
 {
-    return IsLeftChild(child, index) || IsRightChild(child, index);
+    return (index - 1) / Arity;
 }
 
 /**Get iterator from the data array.
 \return An iterator for the first element.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline typename ArrayHeap<DataType, KeyType, Size, Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
     ::ConstIterator
-    ArrayHeap<DataType, KeyType, Size, Predicate>::Begin() const
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::Begin() const
 {
-    return ConstIterator((&m_data[0]));
+    return ConstIterator(m_store.Items());
 }
 
 /**Get iterator from the data array.
 \return An iterator for the first element.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline typename ArrayHeap<DataType, KeyType, Size, Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
     ::ConstReverseIterator
-    ArrayHeap<DataType, KeyType, Size, Predicate>::RBegin() const
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::RBegin() const
 {
-    return ConstReverseIterator((&m_data[0]) + m_data.Size() - 1);
+    return ConstReverseIterator(m_store.Items() + m_store.Size() - 1);
 }
 
 /**Get iterator from the data array.
 \return A one past the end iterator for the array of the heap.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline typename ArrayHeap<DataType, KeyType, Size, Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
     ::ConstIterator
-    ArrayHeap<DataType, KeyType, Size, Predicate>::End() const
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::End() const
 {
-    return ConstIterator((&m_data[0]) + m_data.Size());
+    return ConstIterator(m_store.Items() + m_store.Size());
 }
 /**Get iterator from the data array.
 \return A one past the end iterator for the array of the heap.*/
 template<typename DataType, typename KeyType, SizeType Size,
-    typename Predicate>
-    inline typename ArrayHeap<DataType, KeyType, Size, Predicate>
+    typename Predicate, SizeType Arity, NodeLayout Layout>
+    inline typename ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>
     ::ConstReverseIterator
-    ArrayHeap<DataType, KeyType, Size, Predicate>::REnd() const
+    ArrayHeap<DataType, KeyType, Size, Predicate, Arity, Layout>::REnd() const
 {
-    return ConstReverseIterator((&m_data[0]) - 1);
+    return ConstReverseIterator(m_store.Items() - 1);
 }
 
 }
\ No newline at end of file
@@ -21,7 +21,7 @@ along with _PROJECT_NAME_.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
-#include "Array.hpp"
+#include "ArrayHeapStorage.hpp"
 
 namespace cg {
 
@@ -31,62 +31,105 @@ enum class ArrayheapException {
     EmptyArray,
     /**The array is full.*/
     FullArray,
+    /**A handle that is not in the heap.*/
+    BadHandle,
 };
 
-/**Static way to calculate the amount of nodes in a tree with N levels.*/
-template<SizeType N>
+/**Static way to calculate the amount of nodes in a tree with N levels.
+\tparam N The amount of levels.
+\tparam Arity The amount of children each node has.*/
+template<SizeType N, SizeType Arity = 2>
 struct TreeSize
 {
-    const static SizeType value = cg::Power<2, N>::value - 1;
-    inline SizeType operator()(SizeType num) {
-        if (num == 1)
-            return 1;
-        else
-            return 
-    }
+    const static SizeType value = (cg::Power<Arity, N>::value - 1)
+        / (Arity - 1);
 };
 
 /**A tree that is stored in an array.
+
+Each node has \p Arity children.  A wider node makes the tree shallower, so
+pushes and key changes do fewer steps, and the children of a node sit next
+to each other so a pop compares them in one cache line.  4 is usually
+faster than 2.
+
+Every item gets a Handle when it is added.  The handle follows the item as
+the tree moves it, so the item can be erased or have its key changed later
+in O(log n).  A handle is good until its item is popped or erased, after
+which it may be given to a new item.
+
+With NodeLayout::Split the keys are kept in their own array and the data stays
+put by handle, so only keys move as the tree is fixed up.  Use it when the data
+is large.  The iterators then walk the keys instead of the pairs.
 \tparam KeyType The type of key for sorting.
 \tparam Predicate The object with whom the () operator should return true if
 key 'a' should be higher on the tree than key 'b'.
 \tparam Size The max amount of levels in the tree. Use '0' for auto resize. A
-tree with 1 level has 1 node, a tree with 2 levels has 3 nodes. A tree with N
-levels has [(2^N) - 1] nodes.*/
-template<typename DataType, typename KeyType, 
-    SizeType Size, typename Predicate = Less<KeyType>>
+tree with 1 level has 1 node, a tree with 2 levels has Arity + 1 nodes. A tree
+with N levels has [(Arity^N) - 1] / (Arity - 1) nodes.
+\tparam Arity The amount of children each node has.
+\tparam Layout How the keys and data are laid out.*/
+template<typename DataType, typename KeyType,
+    SizeType Size, typename Predicate = Less<KeyType>, SizeType Arity = 2,
+    NodeLayout Layout = NodeLayout::Interleaved>
 class ArrayHeap
 {
 public:
+    static_assert(Arity >= 2, "A heap node needs at least 2 children.");
     /**The type of pair*/
     using PairType = Pair<DataType, KeyType>;
-    /**The type of list*/
-    using ListType = Array<PairType, TreeSize<Size>::value>;
+    /**The type of storage*/
+    using StoreType = ArrayHeapStorage<DataType, KeyType,
+        TreeSize<Size, Arity>::value, Layout>;
+    /**The type of the things the iterators walk. Pairs, or keys when the
+    layout is Split.*/
+    using ItemType = typename StoreType::ItemType;
     /**A const reverse moving iterator*/
-    using ConstReverseIterator = ArrayIterator<PairType, true, true>;
+    using ConstReverseIterator = ArrayIterator<ItemType, true, true>;
     /**A forward moving const iterator*/
-    using ConstIterator = ArrayIterator<PairType, true, false>;
+    using ConstIterator = ArrayIterator<ItemType, true, false>;
     /**The type of self.*/
-    using SelfType = ArrayHeap<DataType, KeyType, Size, Predicate>;
+    using SelfType = ArrayHeap<DataType, KeyType, Size, Predicate, Arity,
+        Layout>;
+    /**Names an item in the heap.*/
+    using Handle = SizeType;
 
     ArrayHeap(SizeType init = 3);
 
-    void Push(KeyType&& key, DataType&& o);
+    template<typename Iter>
+    ArrayHeap(Iter first, Iter last);
 
-    void Push(PairType&& p);
+    Handle Push(KeyType&& key, DataType&& o);
+
+    Handle Push(PairType&& p);
 
     template<typename... Ts>
-    void Emplace(KeyType&& key, Ts&&...ts);
+    Handle Emplace(KeyType&& key, Ts&&...ts);
+
+    template<typename Iter>
+    void Heapify(Iter first, Iter last);
 
     void Pop();
 
+    void Erase(Handle h);
+
+    void ChangeKey(Handle h, KeyType&& key);
+
+    bool Contains(Handle h) const;
+
+    DataType& Get(Handle h);
+
+    const DataType& Get(Handle h) const;
+
+    const KeyType& GetKey(Handle h) const;
+
     DataType& Top();
 
     const DataType& Top() const;
 
-
     const KeyType& TopKey() const;
 
+    Handle TopHandle() const;
+
     template<typename OutStream>
     void ShowKeys(OutStream& out) const;
 
@@ -94,6 +137,10 @@ public:
 
     bool Full() const;
 
+    SizeType Count() const;
+
+    void Clear();
+
     ConstIterator Begin() const;
 
     ConstReverseIterator RBegin() const;
@@ -103,30 +150,44 @@ public:
     ConstReverseIterator REnd() const;
 
 private:
-    /**The type of pair*/
-    using PairType = Pair<DataType, KeyType>;
-    /**The type of list*/
-    using ListType = Array<PairType, TreeSize<Size>::value>;
-    /**The array to store the data.*/
-    ListType m_data;
-
-    void FixUp(SizeType index);
+    /**Marks a free slot in m_where.*/
+    static const SizeType FreeBit = ~(~SizeType(0) >> 1);
+    /**The end of the free handle list.*/
+    static const SizeType NoHandle = ~FreeBit;
+    /**The keys and data.*/
+    StoreType m_store;
+    /**The handle of the item in each slot of m_store.*/
+    Array<Handle, 0> m_handles;
+    /**The slot of each handle, or FreeBit and the next free handle.*/
+    Array<SizeType, 0> m_where;
+    /**The first free handle.*/
+    Handle m_freeHandle = NoHandle;
+    /**The type of an item held aside while others move.*/
+    using Held = typename StoreType::Held;
+
+    Handle Insert(PairType&& p);
+
+    SizeType FixUp(SizeType index);
 
     void FixDown(SizeType index);
 
-    const KeyType& KeyAt(SizeType index)const;
+    void Restore(SizeType index);
+
+    void RemoveAt(SizeType index);
 
-    SizeType LeftChild(SizeType index);
+    void Place(SizeType to, SizeType from);
 
-    SizeType RightChild(SizeType index);
+    Handle NewHandle(SizeType slot);
 
-    SizeType Parent(SizeType index);
+    void FreeHandle(Handle h);
 
-    bool IsLeftChild(SizeType index, SizeType parent);
+    SizeType SlotOf(Handle h) const;
+
+    const KeyType& KeyAt(SizeType index)const;
 
-    bool IsRightChild(SizeType index, SizeType parent);
+    static SizeType FirstChild(SizeType index);
 
-    bool IsParent(SizeType index, SizeType child);
+    static SizeType Parent(SizeType index);
 
     static const Predicate pred; 
 };
@@ -135,4 +196,4 @@ template class ArrayHeap<int, int,0, Less<int>>;
 template class ArrayHeap<int, int,3, Less<int>>;
 
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,279 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "Array.hpp"
+
+namespace cg {
+
+/**Where an ArrayHeap keeps its items.  The heap only moves items by slot and
+finds data by slot and handle, so the layout of keys and data is up to the
+storage.
+\tparam D The data type.
+\tparam K The key type.
+\tparam N The most items, or 0 for auto resize.
+\tparam Layout How the keys and data are laid out.*/
+template<typename D, typename K, SizeType N, NodeLayout Layout>
+class ArrayHeapStorage;
+
+/**Keeps each key next to its data in one array of pairs.  Moving an item
+moves its data too.*/
+template<typename D, typename K, SizeType N>
+class ArrayHeapStorage<D, K, N, NodeLayout::Interleaved>
+{
+public:
+    /**The type of pair*/
+    using PairType = Pair<D, K>;
+    /**The type of the things in each slot.*/
+    using ItemType = PairType;
+    /**The type of an item that is held aside while the heap moves others.*/
+    using Held = PairType;
+    /**Create with room for some items.
+    \param cap The amount of items to make room for.*/
+    ArrayHeapStorage(SizeType cap) :m_items(cap) {}
+    /**Get the amount of items.
+    \return The amount of items.*/
+    SizeType Size() const
+    {
+        return m_items.Size();
+    }
+    /**Get the key in a slot.
+    \param i The slot.
+    \return A reference to the key.*/
+    K& KeyAt(SizeType i)
+    {
+        return m_items[i].m_b;
+    }
+    /**Get the key in a slot.
+    \param i The slot.
+    \return A reference to the key.*/
+    const K& KeyAt(SizeType i) const
+    {
+        return m_items[i].m_b;
+    }
+    /**Get the data of an item.
+    \param i The slot of the item.
+    \param h The handle of the item. Not used.
+    \return A reference to the data.*/
+    D& DataAt(SizeType i, SizeType /*h*/)
+    {
+        return m_items[i].m_a;
+    }
+    /**Get the data of an item.
+    \param i The slot of the item.
+    \param h The handle of the item. Not used.
+    \return A reference to the data.*/
+    const D& DataAt(SizeType i, SizeType /*h*/) const
+    {
+        return m_items[i].m_a;
+    }
+    /**Add an item in a new slot at the end.
+    \param p The item.
+    \param h The handle of the item. Not used.*/
+    void PushBack(PairType&& p, SizeType /*h*/)
+    {
+        m_items.PushBack(Forward<PairType>(p));
+    }
+    /**Remove the item in the last slot.*/
+    void PopBack()
+    {
+        m_items.PopBack();
+    }
+    /**Move the item in one slot to another.
+    \param to The slot to fill.
+    \param from The slot to take from.*/
+    void MoveTo(SizeType to, SizeType from)
+    {
+        m_items[to] = Move(m_items[from]);
+    }
+    /**Take the item out of a slot.
+    \param i The slot.
+    \return The item.*/
+    Held Take(SizeType i)
+    {
+        return Move(m_items[i]);
+    }
+    /**Put an item that was taken back into a slot.
+    \param i The slot.
+    \param item The item.*/
+    void Put(SizeType i, Held&& item)
+    {
+        m_items[i] = Forward<Held>(item);
+    }
+    /**Get the key of an item that was taken.
+    \param item The item.
+    \return A reference to its key.*/
+    static const K& KeyOf(const Held& item)
+    {
+        return item.m_b;
+    }
+    /**Let go of the data of a handle that was removed. The pair went with
+    its slot, so there is nothing to do.
+    \param h The handle.*/
+    void Release(SizeType /*h*/) {}
+    /**Remove every item.*/
+    void Clear()
+    {
+        if (m_items.Size())
+            m_items.PopBack(m_items.Size());
+    }
+    /**Get the items in slot order.
+    \return A pointer to the first item, or nullptr if there are none.*/
+    const ItemType* Items() const
+    {
+        return m_items.Size() ? &m_items[0] : nullptr;
+    }
+private:
+    /**The items in slot order.*/
+    Array<PairType, N> m_items;
+};
+
+/**Keeps the keys in a dense array in slot order, and the data in a second
+array by handle.  The heap only moves keys, so a push or pop touches
+sizeof(K) bytes per level no matter how large the data is, and the data
+never moves once it is in.  The data type must be default constructible:
+the data of a removed item is destroyed and a default one is made in its
+place, so it lets go of what it holds right away.*/
+template<typename D, typename K, SizeType N>
+class ArrayHeapStorage<D, K, N, NodeLayout::Split>
+{
+public:
+    /**The type of pair*/
+    using PairType = Pair<D, K>;
+    /**The type of the things in each slot.*/
+    using ItemType = K;
+    /**The type of an item that is held aside while the heap moves others.*/
+    using Held = K;
+    /**Create with room for some items.
+    \param cap The amount of items to make room for.*/
+    ArrayHeapStorage(SizeType cap) :m_keys(cap), m_values(cap) {}
+    /**Get the amount of items.
+    \return The amount of items.*/
+    SizeType Size() const
+    {
+        return m_keys.Size();
+    }
+    /**Get the key in a slot.
+    \param i The slot.
+    \return A reference to the key.*/
+    K& KeyAt(SizeType i)
+    {
+        return m_keys[i];
+    }
+    /**Get the key in a slot.
+    \param i The slot.
+    \return A reference to the key.*/
+    const K& KeyAt(SizeType i) const
+    {
+        return m_keys[i];
+    }
+    /**Get the data of an item.
+    \param i The slot of the item. Not used.
+    \param h The handle of the item.
+    \return A reference to the data.*/
+    D& DataAt(SizeType i, SizeType h)
+    {
+        return m_values[h];
+    }
+    /**Get the data of an item.
+    \param i The slot of the item. Not used.
+    \param h The handle of the item.
+    \return A reference to the data.*/
+    const D& DataAt(SizeType i, SizeType h) const
+    {
+        return m_values[h];
+    }
+    /**Add an item in a new slot at the end.
+    \param p The item.
+    \param h The handle of the item. Its data goes in the place for \p h.*/
+    void PushBack(PairType&& p, SizeType h)
+    {
+        m_keys.PushBack(Move(p.m_b));
+        if (h == m_values.Size())
+            m_values.PushBack(Move(p.m_a));
+        else
+            m_values[h] = Move(p.m_a);
+    }
+    /**Remove the key in the last slot.*/
+    void PopBack()
+    {
+        m_keys.PopBack();
+    }
+    /**Move the key in one slot to another.
+    \param to The slot to fill.
+    \param from The slot to take from.*/
+    void MoveTo(SizeType to, SizeType from)
+    {
+        m_keys[to] = Move(m_keys[from]);
+    }
+    /**Take the key out of a slot.
+    \param i The slot.
+    \return The key.*/
+    Held Take(SizeType i)
+    {
+        return Move(m_keys[i]);
+    }
+    /**Put a key that was taken back into a slot.
+    \param i The slot.
+    \param item The key.*/
+    void Put(SizeType i, Held&& item)
+    {
+        m_keys[i] = Forward<Held>(item);
+    }
+    /**Get the key of an item that was taken.
+    \param item The key.
+    \return \p item.*/
+    static const K& KeyOf(const Held& item)
+    {
+        return item;
+    }
+    /**Let go of the data of a handle that was removed.
+    \param h The handle.*/
+    void Release(SizeType h)
+    {
+        D* d = &m_values[h];
+        d->~D();
+        new (d) D();
+    }
+    /**Remove every item.*/
+    void Clear()
+    {
+        if (m_keys.Size())
+            m_keys.PopBack(m_keys.Size());
+        if (m_values.Size())
+            m_values.PopBack(m_values.Size());
+    }
+    /**Get the keys in slot order.
+    \return A pointer to the first key, or nullptr if there are none.*/
+    const ItemType* Items() const
+    {
+        return m_keys.Size() ? &m_keys[0] : nullptr;
+    }
+private:
+    /**The keys in slot order.*/
+    Array<K, N> m_keys;
+    /**The data by handle.  A handle is never larger than the most items
+    there have been at once, so this needs no more room than m_keys.*/
+    Array<D, N> m_values;
+};
+
+}
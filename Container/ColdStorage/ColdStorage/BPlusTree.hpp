@@ -0,0 +1,1027 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "BPlusTreeDef.hpp"
+
+namespace cg {
+
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+const Predicate BPlusTree<DataType, KeyType, Predicate, NodeSize>::pred{};
+
+/**Copy a tree.  The copy is bulk loaded, so its leaves are packed.
+\param other The tree to copy.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline BPlusTree<DataType, KeyType, Predicate, NodeSize>::BPlusTree(
+    const SelfType & other)
+    :m_root(nullptr), m_first(nullptr), m_last(nullptr), m_depth(0),
+    m_size(0)
+{
+    BulkLoad(other.Begin(), other.End());
+}
+/**Copy a tree.
+\param other The tree to copy.
+\return A reference to this.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::SelfType &
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::operator=(
+    const SelfType & other)
+{
+    if (this == &other)
+        return *this;
+    SelfType copy(other);
+    return *this = Move(copy);
+}
+/**Move a tree.
+\post The parameter \p other will be empty after the operation.
+\param other The tree to move.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline BPlusTree<DataType, KeyType, Predicate, NodeSize>::BPlusTree(
+    SelfType && other)
+    :m_root(other.m_root), m_first(other.m_first), m_last(other.m_last),
+    m_depth(other.m_depth), m_size(other.m_size)
+{
+    other.m_root = nullptr;
+    other.m_first = nullptr;
+    other.m_last = nullptr;
+    other.m_depth = 0;
+    other.m_size = 0;
+}
+/**Move a tree.
+\post The parameter \p other will be empty after the operation.
+\param other The tree to move.
+\return A reference to this.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::SelfType &
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::operator=(
+    SelfType && other)
+{
+    if (this == &other)
+        return *this;
+    Clear();
+    m_root = other.m_root;
+    m_first = other.m_first;
+    m_last = other.m_last;
+    m_depth = other.m_depth;
+    m_size = other.m_size;
+    other.m_root = nullptr;
+    other.m_first = nullptr;
+    other.m_last = nullptr;
+    other.m_depth = 0;
+    other.m_size = 0;
+    return *this;
+}
+/**Destroy the items and free the nodes.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline BPlusTree<DataType, KeyType, Predicate, NodeSize>::~BPlusTree()
+{
+    Clear();
+}
+/**Insert an element into the tree. If the key is already there its data is
+replaced.
+\param key The key of the thing to insert.
+\param o The object to insert.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline void BPlusTree<DataType, KeyType, Predicate, NodeSize>::Push(
+    KeyType && key, DataType && o)
+{
+    Insert(PairType(Forward<DataType>(o), Forward<KeyType>(key)));
+}
+/**Insert an element into the tree. If the key is already there its data is
+replaced.
+\param p The pair of key and object to insert.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline void BPlusTree<DataType, KeyType, Predicate, NodeSize>::Push(
+    PairType && p)
+{
+    Insert(Forward<PairType>(p));
+}
+/**Construct an element in the tree if the key is not there yet.
+\param key The key of the thing to insert.
+\param ts The arguments to construct the data with.
+\return True if the element was added, false if the key was already there.
+*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+template<typename ...Ts>
+inline bool BPlusTree<DataType, KeyType, Predicate, NodeSize>::Emplace(
+    KeyType && key, Ts && ...ts)
+{
+    if (Address(key))
+        return false;
+    return Insert(PairType(DataType(Forward<Ts>(ts)...),
+        Forward<KeyType>(key)));
+}
+/**Replace everything in the tree with a sorted run of items.
+
+The leaves are filled evenly and the levels above are built from them in one
+pass, which is O(n) and leaves every node close to full, unlike pushing the
+items one at a time.
+\param first The first item. Dereferencing must give a PairType. Use a move
+iterator to move the items instead of copying them.
+\param last One past the last item.
+\throw BPlusTreeException::NotSorted if the keys are not strictly
+increasing. The tree is left empty.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+template<typename InputIterator>
+inline void BPlusTree<DataType, KeyType, Predicate, NodeSize>::BulkLoad(
+    InputIterator first, InputIterator last)
+{
+    Clear();
+    SizeType amt = 0;
+    for (InputIterator it = first; it != last; ++it)
+        ++amt;
+    if (amt == 0)
+        return;
+    SizeType count = (amt + LeafCapacity - 1) / LeafCapacity;
+    void** level = new void*[count];
+    const KeyType** lows = new const KeyType*[count];
+    const KeyType* prevKey = nullptr;
+    for (SizeType i = 0; i < count; ++i)
+    {
+        LeafType* leaf = new LeafType;
+        leaf->m_prev = m_last;
+        if (m_last)
+            m_last->m_next = leaf;
+        else
+            m_first = leaf;
+        m_last = leaf;
+        SizeType fill = amt / count + (i < amt % count ? 1 : 0);
+        for (SizeType j = 0; j < fill; ++j, ++first)
+        {
+            PairType* item = new (leaf->Items() + j) PairType(*first);
+            ++leaf->m_count;
+            if (prevKey && !pred(*prevKey, item->m_b))
+            {
+                /*nothing is hooked to a root yet, so free by the links.*/
+                for (LeafType* l = m_first; l;)
+                {
+                    LeafType* next = l->m_next;
+                    for (SizeType k = 0; k < l->m_count; ++k)
+                        l->Items()[k].~PairType();
+                    delete l;
+                    l = next;
+                }
+                m_first = nullptr;
+                m_last = nullptr;
+                delete[] level;
+                delete[] lows;
+                throw BPlusTreeException::NotSorted;
+            }
+            prevKey = &item->m_b;
+        }
+        level[i] = leaf;
+        lows[i] = &leaf->Items()[0].m_b;
+    }
+    SizeType depth = 0;
+    while (count > 1)
+    {
+        SizeType parents = (count + InnerCapacity) / (InnerCapacity + 1);
+        SizeType at = 0;
+        for (SizeType i = 0; i < parents; ++i)
+        {
+            SizeType fill = count / parents + (i < count % parents ? 1 : 0);
+            InnerType* inner = new InnerType;
+            inner->m_children[0] = level[at];
+            for (SizeType j = 1; j < fill; ++j)
+            {
+                inner->m_children[j] = level[at + j];
+                new (inner->Keys() + j - 1) KeyType(*lows[at + j]);
+                ++inner->m_count;
+            }
+            /*the children of this one are already read, so the slot can be
+            reused for the level above.*/
+            level[i] = inner;
+            lows[i] = lows[at];
+            at += fill;
+        }
+        count = parents;
+        ++depth;
+    }
+    m_root = level[0];
+    m_depth = depth;
+    m_size = amt;
+    delete[] level;
+    delete[] lows;
+}
+/**Remove the object at \p key.
+\param key The key to remove.
+\return True if the key was there.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline bool BPlusTree<DataType, KeyType, Predicate, NodeSize>::Pop(
+    const KeyType & key)
+{
+    if (!m_root)
+        return false;
+    void* node = m_root;
+    for (SizeType depth = m_depth; depth > 0; --depth)
+    {
+        InnerType* inner = (InnerType*)node;
+        SizeType index = ChildIndex(inner, key);
+        /*make sure the child can lose one before going into it, so nothing
+        has to be fixed on the way back up.*/
+        if (AtMinimum(inner->m_children[index], depth - 1))
+            index = FixChild(inner, index, depth - 1);
+        node = inner->m_children[index];
+        if (inner == m_root && inner->m_count == 0)
+        {
+            m_root = node;
+            --m_depth;
+            delete inner;
+        }
+    }
+    LeafType* leaf = (LeafType*)node;
+    SizeType pos = LeafLowerBound(leaf, key);
+    if (pos == leaf->m_count || !Same(leaf->Items()[pos].m_b, key))
+        return false;
+    leaf->Items()[pos].~PairType();
+    BPlusTreeClose(leaf->Items(), leaf->m_count, pos);
+    --leaf->m_count;
+    --m_size;
+    /*only the root can get this low.*/
+    if (leaf->m_count == 0)
+    {
+        delete leaf;
+        m_root = nullptr;
+        m_first = nullptr;
+        m_last = nullptr;
+        m_depth = 0;
+    }
+    return true;
+}
+/**Get the object at \p key.
+\param key The key to search for.
+\return A reference to the object.
+\throw BPlusTreeException::KeyDoesNotExist if the key does not exist.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline DataType & BPlusTree<DataType, KeyType, Predicate, NodeSize>::Get(
+    const KeyType & key)
+{
+    PairType* p = Address(key);
+    if (!p)
+        throw BPlusTreeException::KeyDoesNotExist;
+    return p->m_a;
+}
+/**Get the object at \p key.
+\param key The key to search for.
+\return A reference to the object.
+\throw BPlusTreeException::KeyDoesNotExist if the key does not exist.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline const DataType &
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::Get(
+    const KeyType & key) const
+{
+    PairType* p = Address(key);
+    if (!p)
+        throw BPlusTreeException::KeyDoesNotExist;
+    return p->m_a;
+}
+/**Get the object at \p key.
+\param key The key to search for.
+\return A reference to the object.
+\throw BPlusTreeException::KeyDoesNotExist if the key does not exist.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline DataType &
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::operator[](
+    const KeyType & key)
+{
+    return Get(key);
+}
+/**Get the object at \p key.
+\param key The key to search for.
+\return A reference to the object.
+\throw BPlusTreeException::KeyDoesNotExist if the key does not exist.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline const DataType &
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::operator[](
+    const KeyType & key) const
+{
+    return Get(key);
+}
+/**Count the objects at \p key.
+\param key The key to search for.
+\return 1 if the key is in the tree, otherwise 0.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline SizeType BPlusTree<DataType, KeyType, Predicate, NodeSize>::Count(
+    const KeyType & key) const
+{
+    return Address(key) ? 1 : 0;
+}
+/**Find the object at \p key.
+\param key The key to search for.
+\return An iterator to the key and object, or End() if it is not there.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::Iterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::Find(const KeyType & key)
+{
+    Iterator it = LowerBound(key);
+    if (!it || !Same(it->m_b, key))
+        return End();
+    return it;
+}
+/**Find the object at \p key.
+\param key The key to search for.
+\return An iterator to the key and object, or End() if it is not there.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ConstIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::Find(
+    const KeyType & key) const
+{
+    ConstIterator it = LowerBound(key);
+    if (!it || !Same(it->m_b, key))
+        return End();
+    return it;
+}
+/**Find the first item that is not less than \p key.
+\param key The key to search for.
+\return An iterator to the item, or End() if every key is less.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::Iterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::LowerBound(
+    const KeyType & key)
+{
+    if (!m_root)
+        return End();
+    LeafType* leaf = FindLeaf(key);
+    SizeType pos = LeafLowerBound(leaf, key);
+    if (pos == leaf->m_count)
+        return Iterator(leaf->m_next, 0);
+    return Iterator(leaf, pos);
+}
+/**Find the first item that is not less than \p key.
+\param key The key to search for.
+\return An iterator to the item, or End() if every key is less.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ConstIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::LowerBound(
+    const KeyType & key) const
+{
+    if (!m_root)
+        return End();
+    const LeafType* leaf = FindLeaf(key);
+    SizeType pos = LeafLowerBound(leaf, key);
+    if (pos == leaf->m_count)
+        return ConstIterator(leaf->m_next, 0);
+    return ConstIterator(leaf, pos);
+}
+/**Find the first item that is greater than \p key.
+\param key The key to search for.
+\return An iterator to the item, or End() if no key is greater.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::Iterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::UpperBound(
+    const KeyType & key)
+{
+    if (!m_root)
+        return End();
+    LeafType* leaf = FindLeaf(key);
+    SizeType pos = LeafUpperBound(leaf, key);
+    if (pos == leaf->m_count)
+        return Iterator(leaf->m_next, 0);
+    return Iterator(leaf, pos);
+}
+/**Find the first item that is greater than \p key.
+\param key The key to search for.
+\return An iterator to the item, or End() if no key is greater.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ConstIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::UpperBound(
+    const KeyType & key) const
+{
+    if (!m_root)
+        return End();
+    const LeafType* leaf = FindLeaf(key);
+    SizeType pos = LeafUpperBound(leaf, key);
+    if (pos == leaf->m_count)
+        return ConstIterator(leaf->m_next, 0);
+    return ConstIterator(leaf, pos);
+}
+/**Call a function on every item with a key in [low, high), in key order.
+This walks the leaves directly, so it is faster than stepping an iterator.
+\param low The smallest key to visit.
+\param high The key to stop at. It is not visited.
+\param func The function. Called as func(PairType&).
+\return The amount of items visited.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+template<typename Func>
+inline SizeType BPlusTree<DataType, KeyType, Predicate, NodeSize>::ForRange(
+    const KeyType & low, const KeyType & high, Func && func)
+{
+    if (!m_root)
+        return 0;
+    SizeType visited = 0;
+    LeafType* leaf = FindLeaf(low);
+    for (SizeType pos = LeafLowerBound(leaf, low); leaf;
+        leaf = leaf->m_next, pos = 0)
+    {
+        PairType* items = leaf->Items();
+        for (; pos < leaf->m_count; ++pos, ++visited)
+        {
+            if (!pred(items[pos].m_b, high))
+                return visited;
+            func(items[pos]);
+        }
+    }
+    return visited;
+}
+/**Call a function on every item with a key in [low, high), in key order.
+This walks the leaves directly, so it is faster than stepping an iterator.
+\param low The smallest key to visit.
+\param high The key to stop at. It is not visited.
+\param func The function. Called as func(const PairType&).
+\return The amount of items visited.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+template<typename Func>
+inline SizeType BPlusTree<DataType, KeyType, Predicate, NodeSize>::ForRange(
+    const KeyType & low, const KeyType & high, Func && func) const
+{
+    if (!m_root)
+        return 0;
+    SizeType visited = 0;
+    const LeafType* leaf = FindLeaf(low);
+    for (SizeType pos = LeafLowerBound(leaf, low); leaf;
+        leaf = leaf->m_next, pos = 0)
+    {
+        const PairType* items = leaf->Items();
+        for (; pos < leaf->m_count; ++pos, ++visited)
+        {
+            if (!pred(items[pos].m_b, high))
+                return visited;
+            func(items[pos]);
+        }
+    }
+    return visited;
+}
+/**Remove all the items and free the nodes.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline void BPlusTree<DataType, KeyType, Predicate, NodeSize>::Clear()
+{
+    if (m_root)
+        FreeNode(m_root, m_depth);
+    m_root = nullptr;
+    m_first = nullptr;
+    m_last = nullptr;
+    m_depth = 0;
+    m_size = 0;
+}
+/**Get the size of the tree.
+\return The amount of items in the tree.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline SizeType BPlusTree<DataType, KeyType, Predicate, NodeSize>::Size()
+const
+{
+    return m_size;
+}
+/**Determine if the tree is empty.
+\return True if the tree is empty.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline bool BPlusTree<DataType, KeyType, Predicate, NodeSize>::Empty() const
+{
+    return m_size == 0;
+}
+/**Get the begin iterator.
+\return The begin iterator to the smallest key.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ConstIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::Begin() const
+{
+    return ConstIterator(m_first, 0);
+}
+/**Get the begin iterator.
+\return The begin iterator to the smallest key.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::Iterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::Begin()
+{
+    return Iterator(m_first, 0);
+}
+/**Get the reverse begin iterator.
+\return The reverse begin iterator to the largest key.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ConstReverseIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::RBegin() const
+{
+    return ConstReverseIterator(m_last, m_last ? m_last->m_count - 1 : 0);
+}
+/**Get the reverse begin iterator.
+\return The reverse begin iterator to the largest key.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ReverseIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::RBegin()
+{
+    return ReverseIterator(m_last, m_last ? m_last->m_count - 1 : 0);
+}
+/**Get a one past the end iterator.
+\return A iterator to one element past the end.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ConstIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::End() const
+{
+    return ConstIterator();
+}
+/**Get a one past the end iterator.
+\return A iterator to one element past the end.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::Iterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::End()
+{
+    return Iterator();
+}
+/**Get a one past the end reverse iterator.
+\return A reverse iterator to one element past the end.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ConstReverseIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::REnd() const
+{
+    return ConstReverseIterator();
+}
+/**Get a one past the end reverse iterator.
+\return A reverse iterator to one element past the end.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>
+::ReverseIterator
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::REnd()
+{
+    return ReverseIterator();
+}
+/**Determine if two keys are the same under the predicate.
+\param a The first key.
+\param b The second key.
+\return True if neither key preceeds the other.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline bool BPlusTree<DataType, KeyType, Predicate, NodeSize>::Same(
+    const KeyType & a, const KeyType & b)
+{
+    return !pred(a, b) && !pred(b, a);
+}
+/**Find the first item in a leaf that is not less than \p key.
+\param leaf The leaf.
+\param key The key.
+\return The index of the item, or the count of the leaf.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline SizeType
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::LeafLowerBound(
+    const LeafType * leaf, const KeyType & key)
+{
+    const PairType* items = leaf->Items();
+    SizeType low = 0;
+    SizeType high = leaf->m_count;
+    while (low < high)
+    {
+        SizeType mid = (low + high) / 2;
+        if (pred(items[mid].m_b, key))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+/**Find the first item in a leaf that is greater than \p key.
+\param leaf The leaf.
+\param key The key.
+\return The index of the item, or the count of the leaf.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline SizeType
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::LeafUpperBound(
+    const LeafType * leaf, const KeyType & key)
+{
+    const PairType* items = leaf->Items();
+    SizeType low = 0;
+    SizeType high = leaf->m_count;
+    while (low < high)
+    {
+        SizeType mid = (low + high) / 2;
+        if (pred(key, items[mid].m_b))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+/**Find the child of an inner node that holds \p key.
+\param inner The node.
+\param key The key.
+\return The index of the child.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline SizeType BPlusTree<DataType, KeyType, Predicate, NodeSize>::ChildIndex(
+    const InnerType * inner, const KeyType & key)
+{
+    const KeyType* keys = inner->Keys();
+    SizeType low = 0;
+    SizeType high = inner->m_count;
+    while (low < high)
+    {
+        SizeType mid = (low + high) / 2;
+        if (pred(key, keys[mid]))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+/**Determine if a node can take no more.
+\param node The node.
+\param depth The depth of the node above the leaves.
+\return True if the node is full.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline bool BPlusTree<DataType, KeyType, Predicate, NodeSize>::Full(
+    void * node, SizeType depth)
+{
+    if (depth == 0)
+        return ((LeafType*)node)->m_count == LeafCapacity;
+    return ((InnerType*)node)->m_count == InnerCapacity;
+}
+/**Determine if a node can lose no more.
+\param node The node.
+\param depth The depth of the node above the leaves.
+\return True if the node is at its minimum.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline bool BPlusTree<DataType, KeyType, Predicate, NodeSize>::AtMinimum(
+    void * node, SizeType depth)
+{
+    if (depth == 0)
+        return ((LeafType*)node)->m_count <= LeafMinimum;
+    return ((InnerType*)node)->m_count <= InnerMinimum;
+}
+/**Find the leaf that would hold \p key.
+\pre The tree must not be empty.
+\param key The key.
+\return The leaf.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::LeafType *
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::FindLeaf(
+    const KeyType & key) const
+{
+    void* node = m_root;
+    for (SizeType depth = m_depth; depth > 0; --depth)
+    {
+        InnerType* inner = (InnerType*)node;
+        node = inner->m_children[ChildIndex(inner, key)];
+    }
+    return (LeafType*)node;
+}
+/**Will return the address of the pair with key \p key
+\param key The key to search for.
+\return A pointer to the pair with key \p key, or null.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline typename BPlusTree<DataType, KeyType, Predicate, NodeSize>::PairType *
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::Address(
+    const KeyType & key) const
+{
+    if (!m_root)
+        return nullptr;
+    LeafType* leaf = FindLeaf(key);
+    SizeType pos = LeafLowerBound(leaf, key);
+    if (pos == leaf->m_count || !Same(leaf->Items()[pos].m_b, key))
+        return nullptr;
+    return leaf->Items() + pos;
+}
+/**Insert an item. Full nodes are split on the way down, so there is always
+room for a split below.
+\param p The item.
+\return True if it was added, false if the key was there and its data was
+replaced.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline bool BPlusTree<DataType, KeyType, Predicate, NodeSize>::Insert(
+    PairType && p)
+{
+    if (!m_root)
+    {
+        LeafType* leaf = new LeafType;
+        m_root = leaf;
+        m_first = leaf;
+        m_last = leaf;
+        m_depth = 0;
+    }
+    if (Full(m_root, m_depth))
+    {
+        InnerType* root = new InnerType;
+        root->m_children[0] = m_root;
+        m_root = root;
+        ++m_depth;
+        SplitChild(root, 0, m_depth - 1);
+    }
+    void* node = m_root;
+    for (SizeType depth = m_depth; depth > 0; --depth)
+    {
+        InnerType* inner = (InnerType*)node;
+        SizeType index = ChildIndex(inner, p.m_b);
+        if (Full(inner->m_children[index], depth - 1))
+        {
+            SplitChild(inner, index, depth - 1);
+            if (!pred(p.m_b, inner->Keys()[index]))
+                ++index;
+        }
+        node = inner->m_children[index];
+    }
+    LeafType* leaf = (LeafType*)node;
+    SizeType pos = LeafLowerBound(leaf, p.m_b);
+    if (pos < leaf->m_count && Same(leaf->Items()[pos].m_b, p.m_b))
+    {
+        leaf->Items()[pos].m_a = Move(p.m_a);
+        return false;
+    }
+    BPlusTreeOpen(leaf->Items(), leaf->m_count, pos);
+    new (leaf->Items() + pos) PairType(Forward<PairType>(p));
+    ++leaf->m_count;
+    ++m_size;
+    return true;
+}
+/**Split a full child in two and put the new separator in the parent.
+\pre The parent must not be full.
+\param parent The parent.
+\param index The child to split.
+\param childDepth The depth of the child above the leaves.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline void BPlusTree<DataType, KeyType, Predicate, NodeSize>::SplitChild(
+    InnerType * parent, SizeType index, SizeType childDepth)
+{
+    void* right;
+    BPlusTreeOpen(parent->Keys(), parent->m_count, index);
+    if (childDepth == 0)
+    {
+        LeafType* left = (LeafType*)parent->m_children[index];
+        LeafType* leaf = new LeafType;
+        SizeType keep = LeafCapacity / 2;
+        BPlusTreeMoveTo(leaf->Items(), left->Items() + keep,
+            left->m_count - keep);
+        leaf->m_count = left->m_count - keep;
+        left->m_count = keep;
+        leaf->m_prev = left;
+        leaf->m_next = left->m_next;
+        if (left->m_next)
+            left->m_next->m_prev = leaf;
+        else
+            m_last = leaf;
+        left->m_next = leaf;
+        /*leaf separators are copies, the item stays in the leaf.*/
+        new (parent->Keys() + index) KeyType(leaf->Items()[0].m_b);
+        right = leaf;
+    }
+    else
+    {
+        InnerType* left = (InnerType*)parent->m_children[index];
+        InnerType* inner = new InnerType;
+        SizeType mid = InnerCapacity / 2;
+        SizeType moved = left->m_count - mid - 1;
+        BPlusTreeMoveTo(inner->Keys(), left->Keys() + mid + 1, moved);
+        for (SizeType i = 0; i <= moved; ++i)
+            inner->m_children[i] = left->m_children[mid + 1 + i];
+        inner->m_count = moved;
+        /*the middle key moves up.*/
+        new (parent->Keys() + index) KeyType(Move(left->Keys()[mid]));
+        left->Keys()[mid].~KeyType();
+        left->m_count = mid;
+        right = inner;
+    }
+    for (SizeType i = parent->m_count + 1; i > index + 1; --i)
+        parent->m_children[i] = parent->m_children[i - 1];
+    parent->m_children[index + 1] = right;
+    ++parent->m_count;
+}
+/**Give a child at its minimum one more by taking from a sibling, or by
+merging it with one.
+\param parent The parent.
+\param index The child to fix.
+\param childDepth The depth of the child above the leaves.
+\return The index of the child that now holds the keys \p index held.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline SizeType BPlusTree<DataType, KeyType, Predicate, NodeSize>::FixChild(
+    InnerType * parent, SizeType index, SizeType childDepth)
+{
+    bool hasLeft = index > 0;
+    bool hasRight = index < parent->m_count;
+    KeyType* seps = parent->Keys();
+    if (childDepth == 0)
+    {
+        LeafType* child = (LeafType*)parent->m_children[index];
+        LeafType* left = hasLeft ?
+            (LeafType*)parent->m_children[index - 1] : nullptr;
+        LeafType* right = hasRight ?
+            (LeafType*)parent->m_children[index + 1] : nullptr;
+        if (left && left->m_count > LeafMinimum)
+        {
+            PairType* last = left->Items() + left->m_count - 1;
+            BPlusTreeOpen(child->Items(), child->m_count, 0);
+            new (child->Items()) PairType(Move(*last));
+            last->~PairType();
+            --left->m_count;
+            ++child->m_count;
+            seps[index - 1] = child->Items()[0].m_b;
+            return index;
+        }
+        if (right && right->m_count > LeafMinimum)
+        {
+            new (child->Items() + child->m_count)
+                PairType(Move(right->Items()[0]));
+            right->Items()[0].~PairType();
+            BPlusTreeClose(right->Items(), right->m_count, 0);
+            --right->m_count;
+            ++child->m_count;
+            seps[index] = right->Items()[0].m_b;
+            return index;
+        }
+        if (left)
+        {
+            MergeLeaves(parent, index - 1);
+            return index - 1;
+        }
+        MergeLeaves(parent, index);
+        return index;
+    }
+    InnerType* child = (InnerType*)parent->m_children[index];
+    InnerType* left = hasLeft ?
+        (InnerType*)parent->m_children[index - 1] : nullptr;
+    InnerType* right = hasRight ?
+        (InnerType*)parent->m_children[index + 1] : nullptr;
+    if (left && left->m_count > InnerMinimum)
+    {
+        /*rotate through the parent: its separator comes down and the last
+        key of the left sibling goes up.*/
+        BPlusTreeOpen(child->Keys(), child->m_count, 0);
+        new (child->Keys()) KeyType(Move(seps[index - 1]));
+        for (SizeType i = child->m_count + 1; i > 0; --i)
+            child->m_children[i] = child->m_children[i - 1];
+        child->m_children[0] = left->m_children[left->m_count];
+        ++child->m_count;
+        KeyType* last = left->Keys() + left->m_count - 1;
+        seps[index - 1] = Move(*last);
+        last->~KeyType();
+        --left->m_count;
+        return index;
+    }
+    if (right && right->m_count > InnerMinimum)
+    {
+        new (child->Keys() + child->m_count) KeyType(Move(seps[index]));
+        child->m_children[child->m_count + 1] = right->m_children[0];
+        ++child->m_count;
+        seps[index] = Move(right->Keys()[0]);
+        right->Keys()[0].~KeyType();
+        BPlusTreeClose(right->Keys(), right->m_count, 0);
+        for (SizeType i = 0; i < right->m_count; ++i)
+            right->m_children[i] = right->m_children[i + 1];
+        --right->m_count;
+        return index;
+    }
+    if (left)
+    {
+        MergeInners(parent, index - 1);
+        return index - 1;
+    }
+    MergeInners(parent, index);
+    return index;
+}
+/**Merge a leaf with the one after it and drop the separator.
+\param parent The parent.
+\param index The left one of the two leaves.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline void BPlusTree<DataType, KeyType, Predicate, NodeSize>::MergeLeaves(
+    InnerType * parent, SizeType index)
+{
+    LeafType* left = (LeafType*)parent->m_children[index];
+    LeafType* right = (LeafType*)parent->m_children[index + 1];
+    BPlusTreeMoveTo(left->Items() + left->m_count, right->Items(),
+        right->m_count);
+    left->m_count += right->m_count;
+    left->m_next = right->m_next;
+    if (right->m_next)
+        right->m_next->m_prev = left;
+    else
+        m_last = left;
+    delete right;
+    RemoveSeparator(parent, index);
+}
+/**Merge an inner node with the one after it.  The separator comes down
+between them.
+\param parent The parent.
+\param index The left one of the two nodes.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline void BPlusTree<DataType, KeyType, Predicate, NodeSize>::MergeInners(
+    InnerType * parent, SizeType index)
+{
+    InnerType* left = (InnerType*)parent->m_children[index];
+    InnerType* right = (InnerType*)parent->m_children[index + 1];
+    new (left->Keys() + left->m_count)
+        KeyType(Move(parent->Keys()[index]));
+    BPlusTreeMoveTo(left->Keys() + left->m_count + 1, right->Keys(),
+        right->m_count);
+    for (SizeType i = 0; i <= right->m_count; ++i)
+        left->m_children[left->m_count + 1 + i] = right->m_children[i];
+    left->m_count += right->m_count + 1;
+    delete right;
+    RemoveSeparator(parent, index);
+}
+/**Remove a separator and the child after it from an inner node.
+\param parent The node.
+\param index The separator.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline void
+BPlusTree<DataType, KeyType, Predicate, NodeSize>::RemoveSeparator(
+    InnerType * parent, SizeType index)
+{
+    parent->Keys()[index].~KeyType();
+    BPlusTreeClose(parent->Keys(), parent->m_count, index);
+    for (SizeType i = index + 1; i < parent->m_count; ++i)
+        parent->m_children[i] = parent->m_children[i + 1];
+    --parent->m_count;
+}
+/**Destroy a subtree.
+\param node The root of the subtree.
+\param depth The depth of the node above the leaves.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType NodeSize>
+inline void BPlusTree<DataType, KeyType, Predicate, NodeSize>::FreeNode(
+    void * node, SizeType depth)
+{
+    if (depth == 0)
+    {
+        LeafType* leaf = (LeafType*)node;
+        for (SizeType i = 0; i < leaf->m_count; ++i)
+            leaf->Items()[i].~PairType();
+        delete leaf;
+        return;
+    }
+    InnerType* inner = (InnerType*)node;
+    for (SizeType i = 0; i <= inner->m_count; ++i)
+        FreeNode(inner->m_children[i], depth - 1);
+    for (SizeType i = 0; i < inner->m_count; ++i)
+        inner->Keys()[i].~KeyType();
+    delete inner;
+}
+
+}
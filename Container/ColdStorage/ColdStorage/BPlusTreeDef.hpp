@@ -0,0 +1,205 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "BPlusTreeIterator.hpp"
+
+namespace cg {
+
+/**B+ tree exceptions*/
+enum class BPlusTreeException
+{
+    /**Key does not exist*/
+    KeyDoesNotExist,
+    /**The items given to BulkLoad were not in strictly increasing order.*/
+    NotSorted,
+};
+
+/**An ordered map that keeps many keys in each node.
+
+Inner nodes hold only keys and child pointers, so one node fills a few cache
+lines and a lookup does a binary search in each instead of chasing a pointer
+per key.  All the items are in the leaves, which are linked both ways, so a
+scan walks memory in order without going back up the tree.  Every node but
+the root is kept at least half full and all the leaves are at the same depth.
+\tparam DataType The type of data to store.
+\tparam KeyType The type of key used to find data.
+\tparam Predicate The functor that orders the keys.
+\tparam NodeSize The size to aim for with each node, in bytes. A few cache
+lines is best for memory, a page for nodes that get paged.*/
+template<typename DataType, typename KeyType,
+    typename Predicate = Less<KeyType>, SizeType NodeSize = 512>
+class BPlusTree
+{
+public:
+    /**The type of pair*/
+    using PairType = Pair<DataType, KeyType>;
+    /**The most items in a leaf.*/
+    static const SizeType LeafCapacity =
+        NodeSize > 3 * sizeof(void*) + 4 * sizeof(PairType) ?
+        (NodeSize - 3 * sizeof(void*)) / sizeof(PairType) : 4;
+    /**The most keys in an inner node.*/
+    static const SizeType InnerCapacity =
+        NodeSize > 2 * sizeof(void*) + 3 * (sizeof(KeyType) + sizeof(void*)) ?
+        (NodeSize - 2 * sizeof(void*)) / (sizeof(KeyType) + sizeof(void*)) :
+        3;
+    /**The leaf type*/
+    using LeafType = BPlusTreeLeaf<DataType, KeyType, LeafCapacity>;
+    /**The inner node type*/
+    using InnerType = BPlusTreeInner<KeyType, InnerCapacity>;
+    /**A reverse moving iterator type*/
+    using ReverseIterator = BPlusTreeIterator<LeafType, false, true>;
+    /**The standard forward iterator*/
+    using Iterator = BPlusTreeIterator<LeafType, false, false>;
+    /**A const reverse moving iterator*/
+    using ConstReverseIterator = BPlusTreeIterator<LeafType, true, true>;
+    /**A forward moving const iterator*/
+    using ConstIterator = BPlusTreeIterator<LeafType, true, false>;
+    /**The type of self.*/
+    using SelfType = BPlusTree<DataType, KeyType, Predicate, NodeSize>;
+
+    BPlusTree() :m_root(nullptr), m_first(nullptr), m_last(nullptr),
+        m_depth(0), m_size(0) {}
+
+    BPlusTree(const SelfType& other);
+
+    SelfType& operator=(const SelfType& other);
+
+    BPlusTree(SelfType&& other);
+
+    SelfType& operator=(SelfType&& other);
+
+    ~BPlusTree();
+
+    void Push(KeyType&& key, DataType&& o);
+
+    void Push(PairType&& p);
+
+    template<typename... Ts>
+    bool Emplace(KeyType&& key, Ts&&...ts);
+
+    template<typename InputIterator>
+    void BulkLoad(InputIterator first, InputIterator last);
+
+    bool Pop(const KeyType& key);
+
+    DataType& Get(const KeyType& key);
+
+    const DataType& Get(const KeyType& key) const;
+
+    DataType& operator[](const KeyType& key);
+
+    const DataType& operator[](const KeyType& key) const;
+
+    SizeType Count(const KeyType& key) const;
+
+    Iterator Find(const KeyType& key);
+
+    ConstIterator Find(const KeyType& key) const;
+
+    Iterator LowerBound(const KeyType& key);
+
+    ConstIterator LowerBound(const KeyType& key) const;
+
+    Iterator UpperBound(const KeyType& key);
+
+    ConstIterator UpperBound(const KeyType& key) const;
+
+    template<typename Func>
+    SizeType ForRange(const KeyType& low, const KeyType& high, Func&& func);
+
+    template<typename Func>
+    SizeType ForRange(const KeyType& low, const KeyType& high,
+        Func&& func) const;
+
+    void Clear();
+
+    SizeType Size() const;
+
+    bool Empty() const;
+
+    ConstIterator Begin() const;
+
+    Iterator Begin();
+
+    ConstReverseIterator RBegin() const;
+
+    ReverseIterator RBegin();
+
+    ConstIterator End() const;
+
+    Iterator End();
+
+    ConstReverseIterator REnd() const;
+
+    ReverseIterator REnd();
+private:
+    /**The least items in a leaf that is not the root.*/
+    static const SizeType LeafMinimum = LeafCapacity / 2;
+    /**The least keys in an inner node that is not the root.*/
+    static const SizeType InnerMinimum = (InnerCapacity - 1) / 2;
+
+    static bool Same(const KeyType& a, const KeyType& b);
+
+    static SizeType LeafLowerBound(const LeafType* leaf, const KeyType& key);
+
+    static SizeType LeafUpperBound(const LeafType* leaf, const KeyType& key);
+
+    static SizeType ChildIndex(const InnerType* inner, const KeyType& key);
+
+    static bool Full(void* node, SizeType depth);
+
+    static bool AtMinimum(void* node, SizeType depth);
+
+    LeafType* FindLeaf(const KeyType& key) const;
+
+    PairType* Address(const KeyType& key) const;
+
+    bool Insert(PairType&& p);
+
+    void SplitChild(InnerType* parent, SizeType index, SizeType childDepth);
+
+    SizeType FixChild(InnerType* parent, SizeType index, SizeType childDepth);
+
+    void MergeLeaves(InnerType* parent, SizeType index);
+
+    void MergeInners(InnerType* parent, SizeType index);
+
+    static void RemoveSeparator(InnerType* parent, SizeType index);
+
+    void FreeNode(void* node, SizeType depth);
+
+    /**The root. A leaf if m_depth is 0, null if the tree is empty.*/
+    void* m_root;
+    /**The leaf with the smallest keys.*/
+    LeafType* m_first;
+    /**The leaf with the largest keys.*/
+    LeafType* m_last;
+    /**The amount of inner levels above the leaves.*/
+    SizeType m_depth;
+    /**The amount of items.*/
+    SizeType m_size;
+    /**The comparator*/
+    static const Predicate pred;
+};
+
+}
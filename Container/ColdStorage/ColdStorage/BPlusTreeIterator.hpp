@@ -0,0 +1,209 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "BPlusTreeIteratorDef.hpp"
+
+namespace cg {
+
+/**Create an iterator at an item.
+\param leaf The leaf of the item, or null for an end.
+\param index The item in \p leaf.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline BPlusTreeIterator<LeafType, Const, Reverse>::BPlusTreeIterator(
+    LeafPtr leaf, SizeType index)
+    :m_leaf(leaf), m_index(index)
+{
+
+}
+/**Determine if the iterator can be dereferenced.
+\return True if the iterator is on an item.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline BPlusTreeIterator<LeafType, Const, Reverse>::operator bool() const
+{
+    return m_leaf != nullptr;
+}
+/**Dereference the iterator.
+\pre The object must point to something.
+\return A reference to the data.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline typename BPlusTreeIterator<LeafType, Const, Reverse>::Ref
+BPlusTreeIterator<LeafType, Const, Reverse>::operator*()
+{
+    CheckAndThrow();
+    return m_leaf->Items()[m_index];
+}
+/**Dereference the iterator.
+\pre The object must point to something.
+\return A reference to the data.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline const typename BPlusTreeIterator<LeafType, Const, Reverse>::Ref
+BPlusTreeIterator<LeafType, Const, Reverse>::operator*() const
+{
+    CheckAndThrow();
+    return m_leaf->Items()[m_index];
+}
+/**Pointer to member access.
+\pre The object must point to something.
+\return A pointer to the data.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline typename BPlusTreeIterator<LeafType, Const, Reverse>::Ptr
+BPlusTreeIterator<LeafType, Const, Reverse>::operator->()
+{
+    CheckAndThrow();
+    return m_leaf->Items() + m_index;
+}
+/**Pointer to member access.
+\pre The object must point to something.
+\return A pointer to the data.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline const typename BPlusTreeIterator<LeafType, Const, Reverse>::Ptr
+BPlusTreeIterator<LeafType, Const, Reverse>::operator->() const
+{
+    CheckAndThrow();
+    return m_leaf->Items() + m_index;
+}
+/**Postincrement the iterator one item.
+\pre The object must point to something.
+\return A copy of this object before the increment happened.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline typename BPlusTreeIterator<LeafType, Const, Reverse>::SelfType
+BPlusTreeIterator<LeafType, Const, Reverse>::operator++(int)
+{
+    CheckAndThrow();
+    SelfType copy = *this;
+    if (Reverse)
+        StepDown();
+    else
+        StepUp();
+    return copy;
+}
+/**Preincrement the iterator one item.
+\pre The object must point to something.
+\return A reference to this object after increment happens.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline typename BPlusTreeIterator<LeafType, Const, Reverse>::SelfType &
+BPlusTreeIterator<LeafType, Const, Reverse>::operator++()
+{
+    CheckAndThrow();
+    if (Reverse)
+        StepDown();
+    else
+        StepUp();
+    return *this;
+}
+/**Postdecrement the iterator one item.
+\pre The object must point to something.  An end can not be decremented.
+\return A copy of this object before the decrement happened.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline typename BPlusTreeIterator<LeafType, Const, Reverse>::SelfType
+BPlusTreeIterator<LeafType, Const, Reverse>::operator--(int)
+{
+    CheckAndThrow();
+    SelfType copy = *this;
+    if (Reverse)
+        StepUp();
+    else
+        StepDown();
+    return copy;
+}
+/**Predecrement the iterator one item.
+\pre The object must point to something.  An end can not be decremented.
+\return A reference to this object after decrement happens.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline typename BPlusTreeIterator<LeafType, Const, Reverse>::SelfType &
+BPlusTreeIterator<LeafType, Const, Reverse>::operator--()
+{
+    CheckAndThrow();
+    if (Reverse)
+        StepUp();
+    else
+        StepDown();
+    return *this;
+}
+/**Determine if two iterators are different.
+\param other The other iterator.
+\return True if the iterators are on different items.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline bool BPlusTreeIterator<LeafType, Const, Reverse>::operator!=(
+    const SelfType & other) const
+{
+    return !(*this == other);
+}
+/**Determine if two iterators are the same.
+\param other The other iterator.
+\return True if the iterators are on the same item.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline bool BPlusTreeIterator<LeafType, Const, Reverse>::operator==(
+    const SelfType & other) const
+{
+    return m_leaf == other.m_leaf && m_index == other.m_index;
+}
+/**Get the address of the data.
+\return A pointer to the data, or null at an end.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline typename BPlusTreeIterator<LeafType, Const, Reverse>::Ptr
+BPlusTreeIterator<LeafType, Const, Reverse>::Addr()
+{
+    return m_leaf ? m_leaf->Items() + m_index : nullptr;
+}
+/**Get the address of the data.
+\return A pointer to the data, or null at an end.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline const typename BPlusTreeIterator<LeafType, Const, Reverse>::Ptr
+BPlusTreeIterator<LeafType, Const, Reverse>::Addr() const
+{
+    return m_leaf ? m_leaf->Items() + m_index : nullptr;
+}
+/**Check and throw and exceptions needed.
+\throw BPlusTreeIteratorException::NotDereferenceable if the iterator is at
+an end.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline void BPlusTreeIterator<LeafType, Const, Reverse>::CheckAndThrow()
+const
+{
+    if (!m_leaf)
+        throw BPlusTreeIteratorException::NotDereferenceable;
+}
+/**Move one item toward the larger keys.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline void BPlusTreeIterator<LeafType, Const, Reverse>::StepUp()
+{
+    if (++m_index < m_leaf->m_count)
+        return;
+    m_leaf = m_leaf->m_next;
+    m_index = 0;
+}
+/**Move one item toward the smaller keys.*/
+template<typename LeafType, bool Const, bool Reverse>
+inline void BPlusTreeIterator<LeafType, Const, Reverse>::StepDown()
+{
+    if (m_index > 0)
+    {
+        --m_index;
+        return;
+    }
+    m_leaf = m_leaf->m_prev;
+    m_index = m_leaf ? m_leaf->m_count - 1 : 0;
+}
+
+}
@@ -0,0 +1,98 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "BPlusTreeNode.hpp"
+
+namespace cg {
+
+enum class BPlusTreeIteratorException
+{
+    /**The iterator was not dereferencable.*/
+    NotDereferenceable,
+};
+
+/**An iterator that walks the linked leaves of a BPlusTree in key order.
+\tparam LeafType The leaf type of the tree.
+\tparam Const True if the data can not be changed through the iterator.
+\tparam Reverse True to walk from the largest key to the smallest.*/
+template<typename LeafType, bool Const, bool Reverse>
+class BPlusTreeIterator
+{
+public:
+    using PairType = typename LeafType::PairType;
+    /**The type of data reference to return.*/
+    using Ref = ConditionalType<Const, const PairType&, PairType&>;
+    /**The type of data pointer to return.*/
+    using Ptr = ConditionalType<Const, const PairType*, PairType*>;
+    /**The type of leaf pointer to hold.*/
+    using LeafPtr = ConditionalType<Const, const LeafType*, LeafType*>;
+    /**The type of this object.*/
+    using SelfType = BPlusTreeIterator<LeafType, Const, Reverse>;
+
+    BPlusTreeIterator() :m_leaf(nullptr), m_index(0) {}
+
+    BPlusTreeIterator(LeafPtr leaf, SizeType index);
+
+    BPlusTreeIterator(const SelfType& other) = default;
+
+    SelfType& operator=(const SelfType& other) = default;
+
+    operator bool() const;
+
+    Ref operator*();
+
+    const Ref operator*() const;
+
+    Ptr operator->();
+
+    const Ptr operator->() const;
+
+    SelfType operator++(int);
+
+    SelfType& operator++();
+
+    SelfType operator--(int);
+
+    SelfType& operator--();
+
+    bool operator!=(const SelfType& other) const;
+
+    bool operator==(const SelfType& other) const;
+
+    Ptr Addr();
+
+    const Ptr Addr() const;
+private:
+    /**Check and throw and exceptions needed*/
+    void CheckAndThrow() const;
+    /**Move one item toward the larger keys.*/
+    void StepUp();
+    /**Move one item toward the smaller keys.*/
+    void StepDown();
+    /**The current leaf, null at either end.*/
+    LeafPtr m_leaf;
+    /**The item in the current leaf.*/
+    SizeType m_index;
+};
+
+}
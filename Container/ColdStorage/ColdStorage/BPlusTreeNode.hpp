@@ -0,0 +1,143 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <new>
+
+#include "cgdef.hpp"
+
+namespace cg {
+
+/**A leaf of a BPlusTree.  Holds the items in key order, with links to the
+leaves on either side so a scan never goes back up the tree.
+\tparam D The data type.
+\tparam K The key type.
+\tparam Cap The most items the leaf can hold.*/
+template<typename D, typename K, SizeType Cap>
+struct BPlusTreeLeaf
+{
+    using DataType = D;
+    using KeyType = K;
+    /**The type of pair*/
+    using PairType = Pair<DataType, KeyType>;
+    /**The most items the leaf can hold.*/
+    static const SizeType Capacity = Cap;
+    /**Create an empty leaf.*/
+    BPlusTreeLeaf() :m_count(0), m_prev(nullptr), m_next(nullptr) {}
+    /**Get the items. Only the first m_count are constructed.
+    \return A pointer to the first item.*/
+    PairType* Items()
+    {
+        return reinterpret_cast<PairType*>(m_items);
+    }
+    /**Get the items. Only the first m_count are constructed.
+    \return A pointer to the first item.*/
+    const PairType* Items() const
+    {
+        return reinterpret_cast<const PairType*>(m_items);
+    }
+    /**The amount of items held.*/
+    SizeType m_count;
+    /**The leaf with the next smaller keys.*/
+    BPlusTreeLeaf<D, K, Cap>* m_prev;
+    /**The leaf with the next larger keys.*/
+    BPlusTreeLeaf<D, K, Cap>* m_next;
+    /**The storage for the items.*/
+    alignas(PairType) unsigned char m_items[sizeof(PairType) * Cap];
+};
+
+/**An inner node of a BPlusTree.  Child i holds the keys that are not less
+than key i - 1 and less than key i.
+\tparam K The key type.
+\tparam Cap The most keys the node can hold. It has one more child.*/
+template<typename K, SizeType Cap>
+struct BPlusTreeInner
+{
+    using KeyType = K;
+    /**The most keys the node can hold.*/
+    static const SizeType Capacity = Cap;
+    /**Create an empty node.*/
+    BPlusTreeInner() :m_count(0) {}
+    /**Get the keys. Only the first m_count are constructed.
+    \return A pointer to the first key.*/
+    KeyType* Keys()
+    {
+        return reinterpret_cast<KeyType*>(m_keys);
+    }
+    /**Get the keys. Only the first m_count are constructed.
+    \return A pointer to the first key.*/
+    const KeyType* Keys() const
+    {
+        return reinterpret_cast<const KeyType*>(m_keys);
+    }
+    /**The amount of keys held.*/
+    SizeType m_count;
+    /**The children. Leaves or inner nodes, depending on the depth.*/
+    void* m_children[Cap + 1];
+    /**The storage for the keys.*/
+    alignas(KeyType) unsigned char m_keys[sizeof(KeyType) * Cap];
+};
+
+/**Move constructed things into unconstructed space. The sources are
+destroyed.
+\param dst The place to move to.
+\param src The things to move. Must not overlap \p dst.
+\param amt The amount of things.*/
+template<typename T>
+inline void BPlusTreeMoveTo(T* dst, T* src, SizeType amt)
+{
+    for (SizeType i = 0; i < amt; ++i)
+    {
+        new (dst + i) T(Move(src[i]));
+        src[i].~T();
+    }
+}
+/**Make an unconstructed hole in a run of things by moving the ones after it
+up one.
+\param items The things. There must be room for \p count + 1.
+\param count The amount of things.
+\param pos The place for the hole.*/
+template<typename T>
+inline void BPlusTreeOpen(T* items, SizeType count, SizeType pos)
+{
+    for (SizeType i = count; i > pos; --i)
+    {
+        new (items + i) T(Move(items[i - 1]));
+        items[i - 1].~T();
+    }
+}
+/**Close an unconstructed hole in a run of things by moving the ones after it
+down one.
+\param items The things.
+\param count The amount of things, counting the hole.
+\param pos The place of the hole.*/
+template<typename T>
+inline void BPlusTreeClose(T* items, SizeType count, SizeType pos)
+{
+    for (SizeType i = pos; i + 1 < count; ++i)
+    {
+        new (items + i) T(Move(items[i + 1]));
+        items[i + 1].~T();
+    }
+}
+
+}
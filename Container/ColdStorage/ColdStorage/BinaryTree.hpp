@@ -25,15 +25,17 @@ along with _PROJECT_NAME_.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace cg {
 
-template<typename DataType, typename KeyType, typename Predicate>
-const Predicate BinaryTree<DataType, KeyType, Predicate>::pred;
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+const Predicate BinaryTree<DataType, KeyType, Predicate, Balance>::pred;
 
 /**Insert an element into the tree.
 \param key The key of the thing to insert.
 \param o The object to insert.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline void BinaryTree<DataType, KeyType, Predicate>::Push(KeyType && key,
-    DataType && o)
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::Push(
+    KeyType && key, DataType && o)
 {
     InsertHelper(m_root,
         MakePair(Forward<DataType>(o), Forward<KeyType>(key)));
@@ -41,8 +43,10 @@ inline void BinaryTree<DataType, KeyType, Predicate>::Push(KeyType && key,
 }
 /**Insert an element into the tree.
 \param p The pair of key and object to insert..*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline void BinaryTree<DataType, KeyType, Predicate>::Push(PairType && p)
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::Push(
+    PairType && p)
 {
     InsertHelper(m_root, Forward<PairType>(p));
     ++m_size;
@@ -50,8 +54,10 @@ inline void BinaryTree<DataType, KeyType, Predicate>::Push(PairType && p)
 /**Remove the object at \p key.
 \param key The key to search for.
 \throw BinaryTreeException::KeyDoesNotExist if the key does not exist.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline void BinaryTree<DataType, KeyType, Predicate>::Pop(KeyType && key)
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::Pop(
+    KeyType && key)
 {
     RemoveHelper(m_root, Forward<KeyType>(key));
     --m_size;
@@ -60,8 +66,10 @@ inline void BinaryTree<DataType, KeyType, Predicate>::Pop(KeyType && key)
 \param key The key to search for.
 \return A reference to the object.
 \throw BinaryTreeException::KeyDoesNotExist if the key does not exist.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline DataType & BinaryTree<DataType, KeyType, Predicate>::Get(KeyType && key)
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline DataType & BinaryTree<DataType, KeyType, Predicate, Balance>::Get(
+    KeyType && key)
 {
     return GetHelper(m_root, Forward<KeyType>(key));
 }
@@ -69,9 +77,10 @@ inline DataType & BinaryTree<DataType, KeyType, Predicate>::Get(KeyType && key)
 \param key The key to search for.
 \return A reference to the object.
 \throw BinaryTreeException::KeyDoesNotExist if the key does not exist.*/
-template<typename DataType, typename KeyType, typename Predicate>
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
 inline const DataType &
-BinaryTree<DataType, KeyType, Predicate>::Get(KeyType && key) const
+BinaryTree<DataType, KeyType, Predicate, Balance>::Get(KeyType && key) const
 {
     return GetHelper(m_root, Forward<KeyType>(key));
 }
@@ -79,9 +88,10 @@ BinaryTree<DataType, KeyType, Predicate>::Get(KeyType && key) const
 \param key The key to search for.
 \return A reference to the object.
 \throw BinaryTreeException::KeyDoesNotExist if the key does not exist.*/
-template<typename DataType, typename KeyType, typename Predicate>
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
 inline DataType &
-BinaryTree<DataType, KeyType, Predicate>::operator[](KeyType && key)
+BinaryTree<DataType, KeyType, Predicate, Balance>::operator[](KeyType && key)
 {
     return Get(Forward<KeyType>(key));
 }
@@ -89,95 +99,112 @@ BinaryTree<DataType, KeyType, Predicate>::operator[](KeyType && key)
 \param key The key to search for.
 \return A reference to the object.
 \throw BinaryTreeException::KeyDoesNotExist if the key does not exist.*/
-template<typename DataType, typename KeyType, typename Predicate>
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
 inline const DataType &
-BinaryTree<DataType, KeyType, Predicate>::operator[](KeyType && key) const
+BinaryTree<DataType, KeyType, Predicate, Balance>::operator[](
+    KeyType && key) const
 {
     return Get(Forward<KeyType>(key));
 }
-template<typename DataType, typename KeyType, typename Predicate>
-inline SizeType BinaryTree<DataType, KeyType, Predicate>::Count(
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline SizeType BinaryTree<DataType, KeyType, Predicate, Balance>::Count(
     KeyType && key) const
 {
     return CountHelper(m_root, Forward<KeyType>(key));
 }
 /**Determine if the tree is empty.
 \return True if the tree is empty.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline bool BinaryTree<DataType, KeyType, Predicate>::Empty() const
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline bool BinaryTree<DataType, KeyType, Predicate, Balance>::Empty() const
 {
     return m_root == nullptr;
 }
 /**Get the begin iterator.
 \return The begin iterator to the first inorder element.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename  BinaryTree<DataType, KeyType, Predicate>::ConstIterator
-BinaryTree<DataType, KeyType, Predicate>::Begin() const
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>::ConstIterator
+BinaryTree<DataType, KeyType, Predicate, Balance>::Begin() const
 {
     return ConstIterator(m_root);
 }
 /**Get the begin iterator.
 \return The begin iterator to the first inorder element.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename  BinaryTree<DataType, KeyType, Predicate>::Iterator
-BinaryTree<DataType, KeyType, Predicate>::Begin()
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>::Iterator
+BinaryTree<DataType, KeyType, Predicate, Balance>::Begin()
 {
     return Iterator(m_root);
 }
 /**Get the reverse begin iterator.
 \return The reverse begin iterator to the first inorder element.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename  BinaryTree<DataType, KeyType, Predicate>::ConstReverseIterator
-BinaryTree<DataType, KeyType, Predicate>::RBegin() const
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>
+::ConstReverseIterator
+BinaryTree<DataType, KeyType, Predicate, Balance>::RBegin() const
 {
     return ConstReverseIterator(m_root);
 }
 /**Get the reverse begin iterator.
 \return The reverse begin iterator to the first inorder element.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename  BinaryTree<DataType, KeyType, Predicate>::ReverseIterator
-BinaryTree<DataType, KeyType, Predicate>::RBegin()
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>
+::ReverseIterator
+BinaryTree<DataType, KeyType, Predicate, Balance>::RBegin()
 {
     return ReverseIterator(m_root);
 }
 /**Get a one past the end iterator.
 \return A iterator to one element past the end.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename  BinaryTree<DataType, KeyType, Predicate>::ConstIterator
-BinaryTree<DataType, KeyType, Predicate>::End() const
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>::ConstIterator
+BinaryTree<DataType, KeyType, Predicate, Balance>::End() const
 {
     return ConstIterator();
 }
 /**Get a one past the end iterator.
 \return A iterator to one element past the end.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename  BinaryTree<DataType, KeyType, Predicate>::Iterator
-BinaryTree<DataType, KeyType, Predicate>::End()
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>::Iterator
+BinaryTree<DataType, KeyType, Predicate, Balance>::End()
 {
     return Iterator();
 }
 /**Get a one past the end reverse iterator.
 \return A reverse iterator to one element past the end.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename  BinaryTree<DataType, KeyType, Predicate>::ReverseIterator
-BinaryTree<DataType, KeyType, Predicate>::REnd()
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>
+::ReverseIterator
+BinaryTree<DataType, KeyType, Predicate, Balance>::REnd()
 {
     return ReverseIterator();
 }
 /**Get a one past the end reverse iterator.
 \return A reverse iterator to one element past the end.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename BinaryTree<DataType, KeyType, Predicate>::ConstReverseIterator
-BinaryTree<DataType, KeyType, Predicate>::REnd() const
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>
+::ConstReverseIterator
+BinaryTree<DataType, KeyType, Predicate, Balance>::REnd() const
 {
     return ConstReverseIterator();
 }
 /**Emplace an object onto the tree.
 \param key The key to put the new object.
 \param ts The arguments to forward to the constructor of the data.*/
-template<typename DataType, typename KeyType, typename Predicate>
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
 template<typename ...Ts>
-inline void BinaryTree<DataType, KeyType, Predicate>::Emplace(
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::Emplace(
     KeyType && key, Ts && ...ts)
 {
     PairType p;
@@ -188,18 +215,20 @@ inline void BinaryTree<DataType, KeyType, Predicate>::Emplace(
 }
 /**Print the keys from left to right
 \param out The stream to print to.*/
-template<typename DataType, typename KeyType, typename Predicate>
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
 template<typename OutStream>
-inline void BinaryTree<DataType, KeyType, Predicate>::ShowKeys(
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::ShowKeys(
     OutStream & out) const
 {
     PrintHelper(m_root, out);
 }
 /**Print the keys from left to right
 \param out The stream to print to.*/
-template<typename DataType, typename KeyType, typename Predicate>
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
 template<typename Stream>
-inline void BinaryTree<DataType, KeyType, Predicate>::PrintHelper(
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::PrintHelper(
     NodeType * node, Stream & out)
 {
     if (!node)
@@ -211,8 +240,9 @@ inline void BinaryTree<DataType, KeyType, Predicate>::PrintHelper(
 /**Recursive helper for inserting.
 \param startNode The node to start looking with.
 \param p The pair to insert.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline void BinaryTree<DataType, KeyType, Predicate>::InsertHelper(
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::InsertHelper(
     NodeType *& startNode, PairType && p)
 {
     if (!startNode)
@@ -229,14 +259,16 @@ inline void BinaryTree<DataType, KeyType, Predicate>::InsertHelper(
         InsertHelper(startNode->m_right, Forward<PairType>(p));
     else
         startNode->m_data = Forward<PairType>(p);
+    Rebalance(startNode);
 }
 /**Will return the address of the pair with key \p key
 \param startNode The node tostart looking at.
 \param key The key to search for.
 \return a pointer to the pair with key \p key.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline typename BinaryTree<DataType, KeyType, Predicate>::PairType *
-BinaryTree<DataType, KeyType, Predicate>::AddressHelper(
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline typename BinaryTree<DataType, KeyType, Predicate, Balance>::PairType *
+BinaryTree<DataType, KeyType, Predicate, Balance>::AddressHelper(
     NodeType * startNode, KeyType && key)
 {
     if (!startNode)
@@ -254,8 +286,9 @@ BinaryTree<DataType, KeyType, Predicate>::AddressHelper(
 \param startNode The node to start with.
 \param key The key to look for.
 \return A referene to the data.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline DataType & BinaryTree<DataType, KeyType, Predicate>::GetHelper(
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline DataType & BinaryTree<DataType, KeyType, Predicate, Balance>::GetHelper(
     NodeType * startNode, KeyType && key)
 {
     if (!startNode)
@@ -272,8 +305,9 @@ inline DataType & BinaryTree<DataType, KeyType, Predicate>::GetHelper(
 /**Helper to remove data.
 \param node The node to start with.
 \param key The key to look for.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline void BinaryTree<DataType, KeyType, Predicate>::RemoveHelper(
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::RemoveHelper(
     NodeType *& node, KeyType && key)
 {
     if (!node)
@@ -281,9 +315,9 @@ inline void BinaryTree<DataType, KeyType, Predicate>::RemoveHelper(
     bool goLeft = pred(key, node->m_data.m_b);
     bool goRight = pred(node->m_data.m_b, key);
     if (goLeft)
-        return RemoveHelper(node->m_left, Forward<KeyType>(key));
+        RemoveHelper(node->m_left, Forward<KeyType>(key));
     else if (goRight)
-        return RemoveHelper(node->m_right, Forward<KeyType>(key));
+        RemoveHelper(node->m_right, Forward<KeyType>(key));
     else //key must be equal here
     {
         if (node->m_left && node->m_right)
@@ -313,12 +347,14 @@ inline void BinaryTree<DataType, KeyType, Predicate>::RemoveHelper(
             node = NULL;
         }
     }
+    Rebalance(node);
 }
 /**Helper to count data.
 \param node The node to start with.
 \param key The key to look for.*/
-template<typename DataType, typename KeyType, typename Predicate>
-inline SizeType BinaryTree<DataType, KeyType, Predicate>::CountHelper(
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline SizeType BinaryTree<DataType, KeyType, Predicate, Balance>::CountHelper(
     NodeType * startNode, KeyType&& key)
 {
     SizeType ct = 0;
@@ -330,6 +366,76 @@ inline SizeType BinaryTree<DataType, KeyType, Predicate>::CountHelper(
         + CountHelper(startNode->m_right, Forward<KeyType>(key));
 }
 
+/**Get the height of a subtree.
+\param node The root of the subtree. May be null.
+\return The height of the subtree, 0 if it is empty.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline SizeType BinaryTree<DataType, KeyType, Predicate, Balance>::Height(
+    NodeType * node)
+{
+    return node ? node->m_height : 0;
+}
+/**Rotate a subtree to the left. The right child becomes the root.
+\param node The root of the subtree. Will be set to the new root.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::RotateLeft(
+    NodeType *& node)
+{
+    NodeType* right = node->m_right;
+    node->m_right = right->m_left;
+    right->m_left = node;
+    node->m_height = 1 + Max(Height(node->m_left), Height(node->m_right));
+    right->m_height = 1 + Max(Height(right->m_left), Height(right->m_right));
+    node = right;
+}
+/**Rotate a subtree to the right. The left child becomes the root.
+\param node The root of the subtree. Will be set to the new root.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::RotateRight(
+    NodeType *& node)
+{
+    NodeType* left = node->m_left;
+    node->m_left = left->m_right;
+    left->m_right = node;
+    node->m_height = 1 + Max(Height(node->m_left), Height(node->m_right));
+    left->m_height = 1 + Max(Height(left->m_left), Height(left->m_right));
+    node = left;
+}
+/**Fix the height of a node whose children just changed, and rotate if one
+side got 2 taller than the other.  Called on the way back up from an insert
+or remove, so every node on the changed path is fixed.  Does nothing if the
+tree is not balanced.
+\param node The root of the subtree. Will be set to the new root.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
+inline void BinaryTree<DataType, KeyType, Predicate, Balance>::Rebalance(
+    NodeType *& node)
+{
+    if (Balance != TreeBalance::AVL || !node)
+        return;
+    SizeType left = Height(node->m_left);
+    SizeType right = Height(node->m_right);
+    if (left > right + 1)
+    {
+        /*left-right case, turn it into left-left first.*/
+        if (Height(node->m_left->m_left) < Height(node->m_left->m_right))
+            RotateLeft(node->m_left);
+        RotateRight(node);
+    }
+    else if (right > left + 1)
+    {
+        if (Height(node->m_right->m_right) < Height(node->m_right->m_left))
+            RotateRight(node->m_right);
+        RotateLeft(node);
+    }
+    else
+        node->m_height = 1 + Max(left, right);
+}
+
 template class BinaryTree<int, int, Less<int>>;
+template class BinaryTree<int, int, Less<int>, TreeBalance::None>;
 
 }
\ No newline at end of file
@@ -32,8 +32,15 @@ enum class BinaryTreeException
     KeyDoesNotExist,
 };
 
-/**A class for a tree type data structure.*/
-template<typename DataType, typename KeyType, typename Predicate>
+/**A class for a tree type data structure.
+\tparam DataType The type of data to store.
+\tparam KeyType The type of key used to find data.
+\tparam Predicate The functor that orders the keys.
+\tparam Balance How the tree keeps itself balanced. With TreeBalance::AVL,
+Push, Emplace, Pop and Get are O(log n) no matter what order the keys come
+in.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance = TreeBalance::AVL>
 class BinaryTree
 {
 public:
@@ -50,7 +57,7 @@ public:
     /**A forward moving const iterator*/
     using ConstIterator = BinaryTreeIterator<NodeType, true, false>;
     /**The type of self.*/
-    using SelfType = BinaryTree<DataType, KeyType, Predicate>;
+    using SelfType = BinaryTree<DataType, KeyType, Predicate, Balance>;
 
     BinaryTree() :m_root(nullptr) {}
 
@@ -110,6 +117,14 @@ private:
     template<typename Stream>
     static void PrintHelper(NodeType* node, Stream& out);
 
+    static SizeType Height(NodeType* node);
+
+    static void RotateLeft(NodeType*& node);
+
+    static void RotateRight(NodeType*& node);
+
+    static void Rebalance(NodeType*& node);
+
     /**The root node*/
     NodeType* m_root;
     /**The size of the tree in nodes.*/
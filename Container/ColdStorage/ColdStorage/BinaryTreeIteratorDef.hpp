@@ -25,7 +25,8 @@ along with _PROJECT_NAME_.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace cg {
 
-template<typename DataType, typename KeyType, typename Predicate>
+template<typename DataType, typename KeyType, typename Predicate,
+    TreeBalance Balance>
 class BinaryTree;
 
 enum class BinaryTreeIteratorExceptions
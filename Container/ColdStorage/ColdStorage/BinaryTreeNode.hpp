@@ -21,6 +21,15 @@ along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 #include "cgdef.hpp"
 namespace cg {
+/**The ways a BinaryTree can keep itself balanced.*/
+enum class TreeBalance
+{
+    /**No balancing. Keys that come in sorted make the tree a list.*/
+    None,
+    /**AVL balancing. The heights of the two sides of every node differ by at
+    most 1, so the tree is never deeper than about 1.44 log2(n).*/
+    AVL,
+};
 /**A class for a search tree.*/
 template<typename T, typename K, typename P>
 class BinaryTreeNode {
@@ -36,18 +45,21 @@ public:
     \param r the right node.*/
     BinaryTreeNode(PairType&& p, BinaryTreeNode<T, K, P>* l,
         BinaryTreeNode<T, K, P>* r) :m_data(Forward<PairType>(p)),
-        m_left(l), m_right(r) {}
+        m_left(l), m_right(r), m_height(1) {}
     /**Create the node.
     \param l The left node.
     \param r the right node.*/
     BinaryTreeNode(BinaryTreeNode<T, K, P>* l, BinaryTreeNode<T, K, P>* r)
-        : m_left(l), m_right(r) {}
+        : m_left(l), m_right(r), m_height(1) {}
     /**The data held*/
     PairType m_data;
     /**A pointer to the left child.*/
     BinaryTreeNode<T, K, P>* m_left;
     /**A pointer to the right child.*/
     BinaryTreeNode<T, K, P>* m_right;
+    /**The height of the subtree rooted here. A leaf is 1. Only kept up to
+    date by balancing trees.*/
+    SizeType m_height;
 
 };
 }
\ No newline at end of file
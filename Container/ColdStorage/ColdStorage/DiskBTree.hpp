@@ -0,0 +1,880 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "DiskBTreeDef.hpp"
+
+namespace cg {
+
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+const Predicate DiskBTree<DataType, KeyType, Predicate, PageSize>::pred{};
+
+/**Open a tree, or make an empty one if the file is not there or is empty.
+Only a header and the free list are read.
+\param path The file.
+\param cacheBytes The most bytes of pages to keep in memory.  At least 8
+pages are kept.
+\throw DiskBTreeException::BadFile if the file holds a tree of other types.
+\throw DiskBTreeException::Corrupt if the file has no good header.
+\throw DiskBTreeException::IOError if the file could not be made.
+\throw ArrayException::OutOfMemory if the cache could not be had.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline DiskBTree<DataType, KeyType, Predicate, PageSize>::DiskBTree(
+    const std::string & path, SizeType cacheBytes)
+    :m_file(path)
+{
+    m_frameCount = cacheBytes / PageSize;
+    if (m_frameCount < 8)
+        m_frameCount = 8;
+    m_data = (char*)std::malloc(m_frameCount * PageSize);
+    m_scratch = (char*)std::malloc(PageSize);
+    try {
+        if (!m_data || !m_scratch)
+            throw ArrayException::OutOfMemory;
+        m_frames.Reserve(m_frameCount);
+        m_cached.Reserve(m_frameCount);
+        Super a;
+        Super b;
+        bool goodA = ReadSuper(0, a);
+        bool goodB = ReadSuper(1, b);
+        if (goodA || goodB)
+            Load(goodA && (!goodB || a.m_gen > b.m_gen) ? a : b);
+        else
+        {
+            if (m_file.Exists() && m_file.Size() != 0)
+                throw DiskBTreeException::Corrupt;
+            if (!m_file.Touch())
+                throw DiskBTreeException::IOError;
+            /*write a header for the empty tree, so a file that has pages
+            always has a good header too.*/
+            m_gen = 1;
+            m_changed = true;
+            Commit();
+        }
+    }
+    catch (...)
+    {
+        std::free(m_data);
+        std::free(m_scratch);
+        throw;
+    }
+}
+/**Commit, and free the cache.  Errors from the commit are dropped, so call
+Commit first to see them.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline DiskBTree<DataType, KeyType, Predicate, PageSize>::~DiskBTree()
+{
+    try {
+        Commit();
+    }
+    catch (...) {}
+    std::free(m_data);
+    std::free(m_scratch);
+}
+/**Insert an item. If the key is already there its data is replaced.  The
+change is not in the file until Commit.
+\param key The key.
+\param o The data.
+\throw DiskBTreeException::IOError or Corrupt if a page could not be
+moved.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline void DiskBTree<DataType, KeyType, Predicate, PageSize>::Push(
+    const KeyType & key, const DataType & o)
+{
+    if (!m_root)
+    {
+        m_root = Allocate();
+        Fresh(m_root, Leaf);
+    }
+    Split split;
+    split.m_split = false;
+    bool added = false;
+    m_root = InsertAt(m_root, m_depth, key, o, split, added);
+    if (split.m_split)
+    {
+        uint64_t root = Allocate();
+        char* p = Fresh(root, Inner);
+        Head(p)->m_count = 1;
+        Keys(p)[0] = split.m_key;
+        Children(p)[0] = m_root;
+        Children(p)[1] = split.m_right;
+        m_root = root;
+        ++m_depth;
+    }
+    if (added)
+        ++m_size;
+    m_changed = true;
+}
+/**Remove an item.  The change is not in the file until Commit.
+\param key The key of the item.
+\return True if it was there.
+\throw DiskBTreeException::IOError or Corrupt if a page could not be
+moved.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline bool
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Pop(const KeyType & key)
+{
+    if (!m_root)
+        return false;
+    bool empty = false;
+    bool found = false;
+    m_root = PopAt(m_root, m_depth, key, empty, found);
+    if (!found)
+        return false;
+    if (empty)
+    {
+        Release(m_root);
+        m_root = 0;
+        m_depth = 0;
+    }
+    while (m_depth > 0)
+    {
+        char* p = Fetch(m_root, false);
+        if (Head(p)->m_count != 0)
+            break;
+        uint64_t child = Children(p)[0];
+        Release(m_root);
+        m_root = child;
+        --m_depth;
+    }
+    --m_size;
+    m_changed = true;
+    return true;
+}
+/**Find an item.
+\param key The key to search for.
+\param out Set to the data if the key is there.
+\return True if the key is there.
+\throw DiskBTreeException::IOError or Corrupt if a page could not be
+read.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline bool DiskBTree<DataType, KeyType, Predicate, PageSize>::Get(
+    const KeyType & key, DataType & out)
+{
+    if (!m_root)
+        return false;
+    uint64_t id = m_root;
+    for (SizeType level = m_depth; level > 0; --level)
+    {
+        char* p = Fetch(id, false);
+        id = Children(p)[ChildIndex(Keys(p), Head(p)->m_count, key)];
+    }
+    char* p = Fetch(id, false);
+    SizeType count = Head(p)->m_count;
+    SizeType pos = LowerBound(Keys(p), count, key);
+    if (pos == count || !Same(Keys(p)[pos], key))
+        return false;
+    out = LeafData(p)[pos];
+    return true;
+}
+/**Get the data at \p key.
+\param key The key to search for.
+\return A copy of the data.
+\throw DiskBTreeException::KeyDoesNotExist if the key is not there.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline DataType
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Get(const KeyType & key)
+{
+    DataType out;
+    if (!Get(key, out))
+        throw DiskBTreeException::KeyDoesNotExist;
+    return out;
+}
+/**Count the items with a key.
+\param key The key.
+\return 1 if the key is there, otherwise 0.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline SizeType
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Count(const KeyType & key)
+{
+    DataType out;
+    return Get(key, out) ? 1 : 0;
+}
+/**Call a function on every item with a key in [low, high), in key order.
+Only the pages on the way down to \p low and the pages that hold the range
+are read.
+\param low The smallest key to visit.
+\param high The key to stop at. It is not visited.
+\param func The function. Called as func(const KeyType&, const DataType&).
+It must not use the tree.
+\return The amount of items visited.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+template<typename Func>
+inline SizeType
+DiskBTree<DataType, KeyType, Predicate, PageSize>::ForRange(
+    const KeyType & low, const KeyType & high, Func && func)
+{
+    SizeType visited = 0;
+    if (m_root)
+        ScanAt(m_root, m_depth, low, high, func, visited);
+    return visited;
+}
+/**Write the changes to the file.  The new pages and the free list are
+written and synced first, then the header that points at them, so the file
+holds either the last commit or this one if the program or the machine dies
+part way.  The commit is on the disk when this returns.
+\throw DiskBTreeException::IOError if a page could not be written.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline void DiskBTree<DataType, KeyType, Predicate, PageSize>::Commit()
+{
+    if (!m_changed)
+        return;
+    /*the pages this commit frees are listed too; they are only handed out
+    once the header below is written.  The list goes in free pages when
+    there are any, so the file does not grow by a list every commit, and a
+    page used for the list is not in it.*/
+    cg::Array<uint64_t, 0> list;
+    while (list.Size() * FreePerPage < m_free.Size() + m_pending.Size())
+        list.PushBack(Allocate());
+    SizeType chain = list.Size();
+    SizeType total = m_free.Size() + m_pending.Size();
+    SizeType k = 0;
+    for (SizeType c = 0; c < chain; ++c)
+    {
+        std::memset(m_scratch, 0, PageSize);
+        PageHead* head = Head(m_scratch);
+        head->m_gen = m_gen;
+        head->m_kind = FreeList;
+        head->m_next = c + 1 < chain ? list.Get(c + 1) : 0;
+        uint64_t* ids = FreeIds(m_scratch);
+        for (; head->m_count < FreePerPage && k < total; ++k)
+            ids[head->m_count++] = k < m_free.Size() ? m_free.Get(k) :
+            m_pending.Get(k - m_free.Size());
+        WritePage(list.Get(c), m_scratch);
+    }
+    for (SizeType f = 0; f < m_frames.Size(); ++f)
+        if (m_frames.Get(f).m_dirty)
+            WriteFrame(f);
+    /*the header may not reach the disk before the pages it points at.*/
+    if (!m_file.Sync())
+        throw DiskBTreeException::IOError;
+    std::memset(m_scratch, 0, PageSize);
+    Super* super = (Super*)m_scratch;
+    super->m_magic = Magic;
+    super->m_gen = m_gen;
+    super->m_pageSize = PageSize;
+    super->m_keySize = sizeof(KeyType);
+    super->m_dataSize = sizeof(DataType);
+    super->m_root = m_root;
+    super->m_depth = m_depth;
+    super->m_size = m_size;
+    super->m_pages = m_pages;
+    super->m_freeHead = chain ? list.Get(0) : 0;
+    super->m_sum = Checksum(m_scratch, sizeof(Super));
+    if (!m_file.Write(m_scratch, PageSize,
+        (std::ptrdiff_t)((m_gen % 2) * PageSize)) || !m_file.Sync())
+        throw DiskBTreeException::IOError;
+    for (SizeType i = 0; i < m_pending.Size(); ++i)
+        m_free.PushBack((uint64_t)m_pending.Get(i));
+    m_pending.PopBack(m_pending.Size());
+    for (SizeType c = 0; c < chain; ++c)
+        m_pending.PushBack((uint64_t)list.Get(c));
+    ++m_gen;
+    m_changed = false;
+}
+/**Get the amount of items.
+\return The amount of items.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline SizeType
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Size() const
+{
+    return m_size;
+}
+/**Determine if there are no items.
+\return True if there are none.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline bool
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Empty() const
+{
+    return m_size == 0;
+}
+/**Get the size of the file in pages, including free ones.
+\return The amount of pages.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline SizeType
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Pages() const
+{
+    return (SizeType)m_pages;
+}
+///////////////////////////////////////////////////////////////////////////
+/**Get the head of a page.
+\param page The page.
+\return The head.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline typename DiskBTree<DataType, KeyType, Predicate, PageSize>::PageHead *
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Head(char * page)
+{
+    return (PageHead*)page;
+}
+/**Get the keys of a leaf or inner node.
+\param page The page.
+\return The first key.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline KeyType *
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Keys(char * page)
+{
+    return (KeyType*)(page + HeadSize);
+}
+/**Get the data of a leaf.
+\param page The page.
+\return The first data.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline DataType *
+DiskBTree<DataType, KeyType, Predicate, PageSize>::LeafData(char * page)
+{
+    return (DataType*)(page + LeafDataOffset);
+}
+/**Get the children of an inner node.
+\param page The page.
+\return The first child.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline uint64_t *
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Children(char * page)
+{
+    return (uint64_t*)(page + ChildOffset);
+}
+/**Get the page numbers in a free list page.
+\param page The page.
+\return The first page number.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline uint64_t *
+DiskBTree<DataType, KeyType, Predicate, PageSize>::FreeIds(char * page)
+{
+    return (uint64_t*)(page + HeadSize);
+}
+/**Get the checksum of a page or header.  The first 8 bytes hold the sum, so
+they are not part of it.
+\param page The page.
+\param size The bytes to sum, counting the first 8.
+\return The checksum.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline uint64_t
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Checksum(
+    const char * page, SizeType size)
+{
+    return cg::HashBytes(page + 8, size - 8);
+}
+/**Determine if two keys are the same under the predicate.
+\param a The first key.
+\param b The second key.
+\return True if neither is less than the other.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline bool DiskBTree<DataType, KeyType, Predicate, PageSize>::Same(
+    const KeyType & a, const KeyType & b)
+{
+    return !pred(a, b) && !pred(b, a);
+}
+/**Find the first key that is not less than \p key.
+\param keys The keys.
+\param count The amount of keys.
+\param key The key.
+\return The index of the key, or \p count.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline SizeType
+DiskBTree<DataType, KeyType, Predicate, PageSize>::LowerBound(
+    const KeyType * keys, SizeType count, const KeyType & key)
+{
+    SizeType low = 0;
+    SizeType high = count;
+    while (low < high)
+    {
+        SizeType mid = (low + high) / 2;
+        if (pred(keys[mid], key))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+/**Find the child of an inner node that may hold \p key.
+\param keys The keys of the node.
+\param count The amount of keys.
+\param key The key.
+\return The index of the child.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline SizeType
+DiskBTree<DataType, KeyType, Predicate, PageSize>::ChildIndex(
+    const KeyType * keys, SizeType count, const KeyType & key)
+{
+    SizeType low = 0;
+    SizeType high = count;
+    while (low < high)
+    {
+        SizeType mid = (low + high) / 2;
+        if (pred(key, keys[mid]))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+/**Read a header page.
+\param slot 0 or 1.
+\param super Set to the header.
+\return True if the header is there and matches its checksum.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline bool DiskBTree<DataType, KeyType, Predicate, PageSize>::ReadSuper(
+    SizeType slot, Super & super)
+{
+    if (!m_file.Exists()
+        || !m_file.Read(m_scratch, PageSize, (std::ptrdiff_t)(slot * PageSize)))
+        return false;
+    std::memcpy(&super, m_scratch, sizeof(Super));
+    return super.m_magic == Magic
+        && super.m_sum == Checksum(m_scratch, sizeof(Super));
+}
+/**Take the state of a header and read the free list it points at.
+\param super The header.
+\throw DiskBTreeException::BadFile if the header is for other types.
+\throw DiskBTreeException::Corrupt if the free list is not good.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline void
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Load(const Super & super)
+{
+    if (super.m_pageSize != PageSize || super.m_keySize != sizeof(KeyType)
+        || super.m_dataSize != sizeof(DataType))
+        throw DiskBTreeException::BadFile;
+    m_gen = super.m_gen + 1;
+    m_root = super.m_root;
+    m_depth = (SizeType)super.m_depth;
+    m_size = (SizeType)super.m_size;
+    m_pages = super.m_pages;
+    SizeType walked = 0;
+    for (uint64_t id = super.m_freeHead; id; id = Head(m_scratch)->m_next)
+    {
+        if (id >= m_pages || ++walked > m_pages)
+            throw DiskBTreeException::Corrupt;
+        if (!m_file.Read(m_scratch, PageSize, (std::ptrdiff_t)(id * PageSize))
+            || Head(m_scratch)->m_sum != Checksum(m_scratch, PageSize)
+            || Head(m_scratch)->m_kind != FreeList)
+            throw DiskBTreeException::Corrupt;
+        uint64_t* ids = FreeIds(m_scratch);
+        for (SizeType i = 0; i < Head(m_scratch)->m_count; ++i)
+            m_free.PushBack((uint64_t)ids[i]);
+        /*the list itself is in use until the next commit.*/
+        m_pending.PushBack((uint64_t)id);
+    }
+}
+/**Insert into a subtree.
+\param id The root of the subtree.
+\param level The amount of inner levels in the subtree.
+\param key The key.
+\param o The data.
+\param split Set if the root of the subtree was split.
+\param added Set to true if the key was not there.
+\return The page of the root of the subtree, which is a copy if \p id was
+in the last commit.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline uint64_t
+DiskBTree<DataType, KeyType, Predicate, PageSize>::InsertAt(
+    uint64_t id, SizeType level, const KeyType & key, const DataType & o,
+    Split & split, bool & added)
+{
+    id = Writable(id);
+    char* p = Fetch(id, true);
+    SizeType count = Head(p)->m_count;
+    KeyType* keys = Keys(p);
+    if (level == 0)
+    {
+        DataType* data = LeafData(p);
+        SizeType pos = LowerBound(keys, count, key);
+        if (pos < count && Same(keys[pos], key))
+        {
+            data[pos] = o;
+            return id;
+        }
+        std::memmove(keys + pos + 1, keys + pos,
+            (count - pos) * sizeof(KeyType));
+        std::memmove(data + pos + 1, data + pos,
+            (count - pos) * sizeof(DataType));
+        keys[pos] = key;
+        data[pos] = o;
+        Head(p)->m_count = (uint32_t)++count;
+        added = true;
+        if (count > LeafCapacity)
+            SplitLeaf(id, split);
+        return id;
+    }
+    SizeType index = ChildIndex(keys, count, key);
+    Split below;
+    below.m_split = false;
+    uint64_t child = InsertAt(Children(p)[index], level - 1, key, o, below,
+        added);
+    /*the child may have pushed this page out of the cache.*/
+    p = Fetch(id, true);
+    keys = Keys(p);
+    uint64_t* children = Children(p);
+    children[index] = child;
+    if (!below.m_split)
+        return id;
+    std::memmove(keys + index + 1, keys + index,
+        (count - index) * sizeof(KeyType));
+    std::memmove(children + index + 2, children + index + 1,
+        (count - index) * sizeof(uint64_t));
+    keys[index] = below.m_key;
+    children[index + 1] = below.m_right;
+    Head(p)->m_count = (uint32_t)++count;
+    if (count > InnerCapacity)
+        SplitInner(id, split);
+    return id;
+}
+/**Remove a key that is in a subtree.
+\param id The root of the subtree.
+\param level The amount of inner levels in the subtree.
+\param key The key.
+\param empty Set to true if the subtree has nothing left.
+\param found Set to true if the key was there.  If not, no page is copied
+or changed.
+\return The page of the root of the subtree, which is a copy if \p id was
+in the last commit and the key was removed.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline uint64_t DiskBTree<DataType, KeyType, Predicate, PageSize>::PopAt(
+    uint64_t id, SizeType level, const KeyType & key, bool & empty,
+    bool & found)
+{
+    /*read down first, and only copy the pages once the key turns up.*/
+    char* p = Fetch(id, false);
+    SizeType count = Head(p)->m_count;
+    KeyType* keys = Keys(p);
+    if (level == 0)
+    {
+        SizeType pos = LowerBound(keys, count, key);
+        found = pos < count && Same(keys[pos], key);
+        if (!found)
+            return id;
+        id = Writable(id);
+        p = Fetch(id, true);
+        keys = Keys(p);
+        DataType* data = LeafData(p);
+        std::memmove(keys + pos, keys + pos + 1,
+            (count - pos - 1) * sizeof(KeyType));
+        std::memmove(data + pos, data + pos + 1,
+            (count - pos - 1) * sizeof(DataType));
+        Head(p)->m_count = (uint32_t)--count;
+        empty = count == 0;
+        return id;
+    }
+    SizeType index = ChildIndex(keys, count, key);
+    bool childEmpty = false;
+    uint64_t child = PopAt(Children(p)[index], level - 1, key, childEmpty,
+        found);
+    if (!found)
+        return id;
+    id = Writable(id);
+    p = Fetch(id, true);
+    keys = Keys(p);
+    uint64_t* children = Children(p);
+    children[index] = child;
+    if (!childEmpty)
+        return id;
+    Release(child);
+    if (count == 0)
+    {
+        empty = true;
+        return id;
+    }
+    /*drop the child and a key next to it; its neighbor takes its range.*/
+    p = Fetch(id, true);
+    keys = Keys(p);
+    children = Children(p);
+    SizeType keyIndex = index == 0 ? 0 : index - 1;
+    std::memmove(keys + keyIndex, keys + keyIndex + 1,
+        (count - keyIndex - 1) * sizeof(KeyType));
+    std::memmove(children + index, children + index + 1,
+        (count - index) * sizeof(uint64_t));
+    Head(p)->m_count = (uint32_t)--count;
+    return id;
+}
+/**Visit the items of a subtree that are in [low, high).
+\param id The root of the subtree.
+\param level The amount of inner levels in the subtree.
+\param low The smallest key to visit.
+\param high The key to stop at.
+\param func The function to call.
+\param visited Counts the items visited.
+\return False if a key at or past \p high was found, so the scan is done.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+template<typename Func>
+inline bool DiskBTree<DataType, KeyType, Predicate, PageSize>::ScanAt(
+    uint64_t id, SizeType level, const KeyType & low, const KeyType & high,
+    Func & func, SizeType & visited)
+{
+    char* p = Fetch(id, false);
+    if (level == 0)
+    {
+        SizeType count = Head(p)->m_count;
+        KeyType* keys = Keys(p);
+        DataType* data = LeafData(p);
+        for (SizeType pos = LowerBound(keys, count, low); pos < count;
+            ++pos, ++visited)
+        {
+            if (!pred(keys[pos], high))
+                return false;
+            func((const KeyType&)keys[pos], (const DataType&)data[pos]);
+        }
+        return true;
+    }
+    for (SizeType index = ChildIndex(Keys(p), Head(p)->m_count, low);;
+        ++index)
+    {
+        p = Fetch(id, false);
+        SizeType count = Head(p)->m_count;
+        /*every key past the separator is at least the separator.*/
+        bool last = index == count || !pred(Keys(p)[index], high);
+        bool done = index < count && last;
+        if (!ScanAt(Children(p)[index], level - 1, low, high, func, visited)
+            || done)
+            return false;
+        if (last)
+            return true;
+    }
+}
+/**Split a leaf that is over capacity in two.
+\param id The leaf.  It must be writable.
+\param split Set to the new right leaf and its smallest key.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline void DiskBTree<DataType, KeyType, Predicate, PageSize>::SplitLeaf(
+    uint64_t id, Split & split)
+{
+    char* p = Fetch(id, true);
+    std::memcpy(m_scratch, p, PageSize);
+    SizeType count = Head(p)->m_count;
+    SizeType half = count / 2;
+    Head(p)->m_count = (uint32_t)half;
+    uint64_t right = Allocate();
+    char* q = Fresh(right, Leaf);
+    Head(q)->m_count = (uint32_t)(count - half);
+    std::memcpy(Keys(q), Keys(m_scratch) + half,
+        (count - half) * sizeof(KeyType));
+    std::memcpy(LeafData(q), LeafData(m_scratch) + half,
+        (count - half) * sizeof(DataType));
+    split.m_split = true;
+    split.m_key = Keys(q)[0];
+    split.m_right = right;
+}
+/**Split an inner node that is over capacity in two.  The middle key moves
+up to the parent.
+\param id The inner node.  It must be writable.
+\param split Set to the new right node and the key between the two.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline void DiskBTree<DataType, KeyType, Predicate, PageSize>::SplitInner(
+    uint64_t id, Split & split)
+{
+    char* p = Fetch(id, true);
+    std::memcpy(m_scratch, p, PageSize);
+    SizeType count = Head(p)->m_count;
+    SizeType mid = count / 2;
+    Head(p)->m_count = (uint32_t)mid;
+    uint64_t right = Allocate();
+    char* q = Fresh(right, Inner);
+    Head(q)->m_count = (uint32_t)(count - mid - 1);
+    std::memcpy(Keys(q), Keys(m_scratch) + mid + 1,
+        (count - mid - 1) * sizeof(KeyType));
+    std::memcpy(Children(q), Children(m_scratch) + mid + 1,
+        (count - mid) * sizeof(uint64_t));
+    split.m_split = true;
+    split.m_key = Keys(m_scratch)[mid];
+    split.m_right = right;
+}
+/**Get a page that can be changed in place.  A page that is part of the last
+commit is copied to a free page first, and is freed once this commit is
+written.
+\param id The page.
+\return The page to change, which is \p id if it was made since the last
+commit.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline uint64_t
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Writable(uint64_t id)
+{
+    char* p = Fetch(id, false);
+    if (Head(p)->m_gen == m_gen)
+        return id;
+    std::memcpy(m_scratch, p, PageSize);
+    m_pending.PushBack((uint64_t)id);
+    uint64_t copy = Allocate();
+    p = Fresh(copy, (PageKind)Head(m_scratch)->m_kind);
+    std::memcpy(p, m_scratch, PageSize);
+    Head(p)->m_gen = m_gen;
+    return copy;
+}
+/**Get a page to write to, from the free pages or the end of the file.
+\return The page.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline uint64_t
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Allocate()
+{
+    if (m_free.Size() == 0)
+        return m_pages++;
+    uint64_t id = m_free.Back();
+    m_free.PopBack();
+    return id;
+}
+/**Free a page that was made writable in this commit.  It is not in any
+commit, so it can be used again right away.
+\param id The page.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline void
+DiskBTree<DataType, KeyType, Predicate, PageSize>::Release(uint64_t id)
+{
+    m_frames.Get(FrameOf(id, true)).m_dirty = false;
+    m_free.PushBack((uint64_t)id);
+}
+/**Get a page, reading it in if it is not in the cache.
+\param id The page.
+\param write True if the page will be changed.  It must be writable.
+\return The page.  Only good until the next page is fetched.
+\throw DiskBTreeException::IOError or Corrupt if the page could not be
+read.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline char * DiskBTree<DataType, KeyType, Predicate, PageSize>::Fetch(
+    uint64_t id, bool write)
+{
+    SizeType f = FrameOf(id, true);
+    if (write)
+        m_frames.Get(f).m_dirty = true;
+    return m_data + f * PageSize;
+}
+/**Get a page in the cache without reading it, and make it an empty node.
+\param id The page.
+\param kind What the page will hold.
+\return The page.  Only good until the next page is fetched.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline char * DiskBTree<DataType, KeyType, Predicate, PageSize>::Fresh(
+    uint64_t id, PageKind kind)
+{
+    SizeType f = FrameOf(id, false);
+    m_frames.Get(f).m_dirty = true;
+    char* p = m_data + f * PageSize;
+    std::memset(p, 0, PageSize);
+    Head(p)->m_gen = m_gen;
+    Head(p)->m_kind = kind;
+    return p;
+}
+/**Find the frame of a page, dropping the page the clock picks if it is not
+in the cache.
+\param id The page.
+\param read True to read the page in if it is not in the cache.
+\return The frame.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline SizeType DiskBTree<DataType, KeyType, Predicate, PageSize>::FrameOf(
+    uint64_t id, bool read)
+{
+    auto it = m_cached.Find(id);
+    if (it != m_cached.End())
+    {
+        m_frames.Get(it->m_a).m_ref = true;
+        return it->m_a;
+    }
+    SizeType f;
+    if (m_frames.Size() < m_frameCount)
+    {
+        f = m_frames.Size();
+        m_frames.PushBack(Frame{ 0, false, false });
+    }
+    else
+    {
+        for (;;)
+        {
+            f = m_hand;
+            m_hand = (m_hand + 1) % m_frameCount;
+            if (!m_frames.Get(f).m_ref)
+                break;
+            m_frames.Get(f).m_ref = false;
+        }
+        /*dirty pages were made in this commit, so writing them now can not
+        hurt the last one.*/
+        if (m_frames.Get(f).m_dirty)
+            WriteFrame(f);
+        m_cached.Pop(m_frames.Get(f).m_page);
+    }
+    char* p = m_data + f * PageSize;
+    m_frames.Get(f) = Frame{ 0, false, false };
+    if (read && !m_file.Read(p, PageSize, (std::ptrdiff_t)(id * PageSize)))
+        throw DiskBTreeException::IOError;
+    if (read && Head(p)->m_sum != Checksum(p, PageSize))
+        throw DiskBTreeException::Corrupt;
+    m_frames.Get(f) = Frame{ id, false, true };
+    m_cached.Push((uint64_t)id, (SizeType)f);
+    return f;
+}
+/**Write a cached page to the file.
+\param f The frame.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline void
+DiskBTree<DataType, KeyType, Predicate, PageSize>::WriteFrame(SizeType f)
+{
+    WritePage(m_frames.Get(f).m_page, m_data + f * PageSize);
+    m_frames.Get(f).m_dirty = false;
+}
+/**Checksum a page and write it to its place in the file.
+\param id The page.
+\param page The bytes of the page.
+\throw DiskBTreeException::IOError if the page could not be written.*/
+template<typename DataType, typename KeyType, typename Predicate,
+    SizeType PageSize>
+inline void DiskBTree<DataType, KeyType, Predicate, PageSize>::WritePage(
+    uint64_t id, char * page)
+{
+    Head(page)->m_sum = Checksum(page, PageSize);
+    if (!m_file.Write(page, PageSize, (std::ptrdiff_t)(id * PageSize)))
+        throw DiskBTreeException::IOError;
+}
+
+template class DiskBTree<int, int>;
+
+}
@@ -0,0 +1,308 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "Array.hpp"
+#include "HashMap.hpp"
+#include "../../../FileSystem.hpp"
+
+namespace cg {
+
+/**Disk B tree exceptions*/
+enum class DiskBTreeException
+{
+    /**Key does not exist*/
+    KeyDoesNotExist,
+    /**The file is not a tree of these types and page size.*/
+    BadFile,
+    /**A page did not match its checksum, or no header was good.*/
+    Corrupt,
+    /**A page could not be read from or written to the file.*/
+    IOError,
+};
+
+/**An ordered map that lives in a file and reads only the pages it needs.
+
+The file is an array of PageSize pages.  Pages 0 and 1 are headers, and the
+rest are the nodes of a B+ tree: leaves hold keys and data in two runs, inner
+nodes hold keys and the page numbers of their children.  Opening a tree only
+reads a header and the list of free pages, so it costs the same for any
+amount of keys, and a lookup reads one page per level that is not already in
+the page cache.
+
+Updates are copy on write.  A page that is part of the last commit is never
+written over: changing it writes a copy to a free page, which changes its
+parent, and so on up to the root.  Commit writes the new pages and then the
+header that points at the new root, alternating between the two header
+pages.  If the program dies at any point, the newest header that matches its
+checksum still points at a whole tree, and everything since that commit is
+lost.  Pages freed by a commit are only reused after the next one, so the
+older header stays good too.  Every page carries a checksum that is checked
+when it is read.
+
+Pops do not merge pages.  A page is freed once it is empty, and a root with
+one child is replaced by the child.
+
+The cache and the file are not guarded, so a tree may only be used by one
+thread at a time.
+\tparam DataType The type of data to store.  Must be trivially copyable.
+\tparam KeyType The type of key used to find data.  Must be trivially
+copyable.
+\tparam Predicate The functor that orders the keys.
+\tparam PageSize The size of a page in bytes.  A multiple of the disk block
+size is best.*/
+template<typename DataType, typename KeyType,
+    typename Predicate = Less<KeyType>, SizeType PageSize = 4096>
+class DiskBTree
+{
+public:
+    static_assert(std::is_trivially_copyable<DataType>::value
+        && std::is_trivially_copyable<KeyType>::value,
+        "A disk B tree can only hold trivially copyable keys and data.");
+    static_assert(alignof(DataType) <= 16 && alignof(KeyType) <= 16,
+        "A disk B tree can not align keys or data past 16 bytes.");
+    /**The type of self.*/
+    using SelfType = DiskBTree<DataType, KeyType, Predicate, PageSize>;
+    /**The bytes at the front of every page.*/
+    static const SizeType HeadSize = 32;
+    /**The most items in a leaf.  The page has room for one more, which is
+    split off right away.*/
+    static const SizeType LeafCapacity = (PageSize - HeadSize - 16)
+        / (sizeof(KeyType) + sizeof(DataType)) - 1;
+    /**The most keys in an inner node.  The page has room for one more, which
+    is split off right away.*/
+    static const SizeType InnerCapacity = (PageSize - HeadSize - 16)
+        / (sizeof(KeyType) + sizeof(uint64_t)) - 1;
+    static_assert(LeafCapacity >= 3 && InnerCapacity >= 3,
+        "The page size is too small for the key and data.");
+    /**The size of the page cache when none is given.*/
+    static const SizeType DefaultCacheBytes = 1024 * 1024;
+    /**The first 8 bytes of a good header.*/
+    static const uint64_t Magic = 0x45455254424b5344ull;
+
+    DiskBTree(const std::string& path,
+        SizeType cacheBytes = DefaultCacheBytes);
+
+    ~DiskBTree();
+
+    DiskBTree(const SelfType&) = delete;
+
+    void operator=(const SelfType&) = delete;
+
+    void Push(const KeyType& key, const DataType& o);
+
+    bool Pop(const KeyType& key);
+
+    bool Get(const KeyType& key, DataType& out);
+
+    DataType Get(const KeyType& key);
+
+    SizeType Count(const KeyType& key);
+
+    template<typename Func>
+    SizeType ForRange(const KeyType& low, const KeyType& high, Func&& func);
+
+    void Commit();
+
+    SizeType Size() const;
+
+    bool Empty() const;
+
+    SizeType Pages() const;
+private:
+    /**What a page holds.*/
+    enum PageKind : uint32_t
+    {
+        /**Keys and data.*/
+        Leaf = 1,
+        /**Keys and child pages.*/
+        Inner = 2,
+        /**Numbers of free pages.*/
+        FreeList = 3,
+    };
+    /**The front of every page.*/
+    struct PageHead
+    {
+        /**The checksum of the rest of the page.*/
+        uint64_t m_sum;
+        /**The commit the page was written for.*/
+        uint64_t m_gen;
+        /**A PageKind.*/
+        uint32_t m_kind;
+        /**The amount of items, keys, or free page numbers.*/
+        uint32_t m_count;
+        /**The next free list page, or 0.*/
+        uint64_t m_next;
+    };
+    static_assert(sizeof(PageHead) == HeadSize, "The page head must be 32.");
+    /**The content of a header page.*/
+    struct Super
+    {
+        /**The checksum of the rest of the header.*/
+        uint64_t m_sum;
+        /**Always Magic.*/
+        uint64_t m_magic;
+        /**The commit this header is for.  The larger good one wins.*/
+        uint64_t m_gen;
+        /**PageSize when the file was made.*/
+        uint64_t m_pageSize;
+        /**sizeof(KeyType) when the file was made.*/
+        uint64_t m_keySize;
+        /**sizeof(DataType) when the file was made.*/
+        uint64_t m_dataSize;
+        /**The root page, or 0 if the tree is empty.*/
+        uint64_t m_root;
+        /**The amount of inner levels above the leaves.*/
+        uint64_t m_depth;
+        /**The amount of items.*/
+        uint64_t m_size;
+        /**The amount of pages in the file.*/
+        uint64_t m_pages;
+        /**The first free list page, or 0.*/
+        uint64_t m_freeHead;
+    };
+    /**A place in the cache for one page.*/
+    struct Frame
+    {
+        /**The page in the frame, or 0.*/
+        uint64_t m_page;
+        /**True if the page was changed since it was read.*/
+        bool m_dirty;
+        /**True if the page was touched since the hand last went by.*/
+        bool m_ref;
+    };
+    /**What a node tells its parent after an insert.*/
+    struct Split
+    {
+        /**True if the node was split.*/
+        bool m_split;
+        /**The smallest key of the new right node.*/
+        KeyType m_key;
+        /**The new right node.*/
+        uint64_t m_right;
+    };
+    /**The amount of free page numbers in a free list page.*/
+    static const SizeType FreePerPage = (PageSize - HeadSize) / 8;
+    /**Where the data starts in a leaf.*/
+    static const SizeType LeafDataOffset = (HeadSize
+        + (LeafCapacity + 1) * sizeof(KeyType) + alignof(DataType) - 1)
+        / alignof(DataType) * alignof(DataType);
+    /**Where the children start in an inner node.*/
+    static const SizeType ChildOffset = (HeadSize
+        + (InnerCapacity + 1) * sizeof(KeyType) + 7) / 8 * 8;
+
+    static PageHead* Head(char* page);
+
+    static KeyType* Keys(char* page);
+
+    static DataType* LeafData(char* page);
+
+    static uint64_t* Children(char* page);
+
+    static uint64_t* FreeIds(char* page);
+
+    static uint64_t Checksum(const char* page, SizeType size);
+
+    static bool Same(const KeyType& a, const KeyType& b);
+
+    static SizeType LowerBound(const KeyType* keys, SizeType count,
+        const KeyType& key);
+
+    static SizeType ChildIndex(const KeyType* keys, SizeType count,
+        const KeyType& key);
+
+    bool ReadSuper(SizeType slot, Super& super);
+
+    void Load(const Super& super);
+
+    uint64_t InsertAt(uint64_t id, SizeType level, const KeyType& key,
+        const DataType& o, Split& split, bool& added);
+
+    uint64_t PopAt(uint64_t id, SizeType level, const KeyType& key,
+        bool& empty, bool& found);
+
+    template<typename Func>
+    bool ScanAt(uint64_t id, SizeType level, const KeyType& low,
+        const KeyType& high, Func& func, SizeType& visited);
+
+    void SplitLeaf(uint64_t id, Split& split);
+
+    void SplitInner(uint64_t id, Split& split);
+
+    uint64_t Writable(uint64_t id);
+
+    uint64_t Allocate();
+
+    void Release(uint64_t id);
+
+    char* Fetch(uint64_t id, bool write);
+
+    char* Fresh(uint64_t id, PageKind kind);
+
+    SizeType FrameOf(uint64_t id, bool read);
+
+    void WriteFrame(SizeType f);
+
+    void WritePage(uint64_t id, char* page);
+
+    /**Orders the keys.*/
+    static const Predicate pred;
+    /**The file.*/
+    cg::File m_file;
+    /**Which page is in each frame.*/
+    cg::Array<Frame, 0> m_frames;
+    /**The frame each cached page is in.*/
+    cg::HashMap<SizeType, uint64_t> m_cached;
+    /**The memory for the frames.*/
+    char* m_data;
+    /**A page to copy through.*/
+    char* m_scratch;
+    /**The most frames there can be.*/
+    SizeType m_frameCount;
+    /**The next frame the clock looks at.*/
+    SizeType m_hand = 0;
+    /**Pages that can be used now.*/
+    cg::Array<uint64_t, 0> m_free;
+    /**Pages the last commit still uses, free after the next one.*/
+    cg::Array<uint64_t, 0> m_pending;
+    /**The commit being built.  Pages with this generation are not in any
+    commit yet, so they are changed in place.*/
+    uint64_t m_gen;
+    /**The root page, or 0 if the tree is empty.*/
+    uint64_t m_root = 0;
+    /**The amount of inner levels above the leaves.*/
+    SizeType m_depth = 0;
+    /**The amount of items.*/
+    SizeType m_size = 0;
+    /**The amount of pages in the file.*/
+    uint64_t m_pages = 2;
+    /**True if something changed since the last commit.*/
+    bool m_changed = false;
+};
+
+}
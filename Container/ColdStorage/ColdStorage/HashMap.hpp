@@ -0,0 +1,581 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "HashMapDef.hpp"
+
+namespace cg {
+
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+const Hasher HashMap<DataType, KeyType, Hasher, KeyEqual>::hasher{};
+
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+const KeyEqual HashMap<DataType, KeyType, Hasher, KeyEqual>::equal{};
+
+/**Create a map with room for \p amt items before it has to grow.
+\param amt The amount of items to make room for.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline HashMap<DataType, KeyType, Hasher, KeyEqual>::HashMap(SizeType amt)
+    :m_ctrl(nullptr), m_slots(nullptr), m_size(0), m_capacity(0)
+{
+    Reserve(amt);
+}
+/**Copy a map.
+\param other The map to copy.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline HashMap<DataType, KeyType, Hasher, KeyEqual>::HashMap(
+    const SelfType & other)
+    :m_ctrl(nullptr), m_slots(nullptr), m_size(0), m_capacity(0)
+{
+    Reserve(other.m_size);
+    for (SizeType i = 0; i < other.m_capacity; ++i)
+        if (other.m_ctrl[i] != HashMapEmpty)
+            Place(hasher(other.m_slots[i].m_b), PairType(other.m_slots[i]));
+}
+/**Copy a map.
+\param other The map to copy.
+\return A reference to this.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::SelfType &
+HashMap<DataType, KeyType, Hasher, KeyEqual>::operator=(
+    const SelfType & other)
+{
+    if (this == &other)
+        return *this;
+    SelfType copy(other);
+    return *this = Move(copy);
+}
+/**Move a map.
+\post The parameter \p other will be empty after the operation.
+\param other The map to move.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline HashMap<DataType, KeyType, Hasher, KeyEqual>::HashMap(
+    SelfType && other)
+    :m_ctrl(other.m_ctrl), m_slots(other.m_slots), m_size(other.m_size),
+    m_capacity(other.m_capacity)
+{
+    other.m_ctrl = nullptr;
+    other.m_slots = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+}
+/**Move a map.
+\post The parameter \p other will be empty after the operation.
+\param other The map to move.
+\return A reference to this.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::SelfType &
+HashMap<DataType, KeyType, Hasher, KeyEqual>::operator=(SelfType && other)
+{
+    if (this == &other)
+        return *this;
+    Free();
+    m_ctrl = other.m_ctrl;
+    m_slots = other.m_slots;
+    m_size = other.m_size;
+    m_capacity = other.m_capacity;
+    other.m_ctrl = nullptr;
+    other.m_slots = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+    return *this;
+}
+/**Destroy the items and free the memory.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline HashMap<DataType, KeyType, Hasher, KeyEqual>::~HashMap()
+{
+    Free();
+}
+/**Insert an element into the map. If the key is already there its data is
+replaced.
+\param key The key of the thing to insert.
+\param o The object to insert.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::Push(
+    KeyType && key, DataType && o)
+{
+    Push(PairType(Forward<DataType>(o), Forward<KeyType>(key)));
+}
+/**Insert an element into the map. If the key is already there its data is
+replaced.
+\param p The pair of key and object to insert.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::Push(PairType && p)
+{
+    SizeType hash = hasher(p.m_b);
+    SizeType index = FindIndex(p.m_b, hash);
+    if (index != NotFound)
+    {
+        m_slots[index].m_a = Move(p.m_a);
+        return;
+    }
+    if (m_size + 1 > MaxLoad(m_capacity))
+        Grow();
+    Place(hash, Forward<PairType>(p));
+}
+/**Construct an element in the map if the key is not there yet.
+\param key The key of the thing to insert.
+\param ts The arguments to construct the data with.
+\return True if the element was added, false if the key was already there.
+*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+template<typename ...Ts>
+inline bool HashMap<DataType, KeyType, Hasher, KeyEqual>::Emplace(
+    KeyType && key, Ts && ...ts)
+{
+    SizeType hash = hasher(key);
+    if (FindIndex(key, hash) != NotFound)
+        return false;
+    if (m_size + 1 > MaxLoad(m_capacity))
+        Grow();
+    Place(hash, PairType(DataType(Forward<Ts>(ts)...),
+        Forward<KeyType>(key)));
+    return true;
+}
+/**Remove the object at \p key.
+
+The items after it in its run are shifted back over the hole, so no
+tombstone is left.  This invalidates iterators.
+\param key The key to remove.
+\return True if the key was there.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline bool HashMap<DataType, KeyType, Hasher, KeyEqual>::Pop(
+    const KeyType & key)
+{
+    SizeType hole = FindIndex(key, hasher(key));
+    if (hole == NotFound)
+        return false;
+    const SizeType mask = m_capacity - 1;
+    m_slots[hole].~PairType();
+    for (SizeType i = (hole + 1) & mask; m_ctrl[i] != HashMapEmpty;
+        i = (i + 1) & mask)
+    {
+        SizeType home = Home(hasher(m_slots[i].m_b));
+        /*the item can fill the hole if the hole is on its probe path, that
+        is between its home and where it is now.*/
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            new (m_slots + hole) PairType(Move(m_slots[i]));
+            m_slots[i].~PairType();
+            SetCtrl(hole, m_ctrl[i]);
+            hole = i;
+        }
+    }
+    SetCtrl(hole, HashMapEmpty);
+    --m_size;
+    return true;
+}
+/**Get the object at \p key.
+\param key The key to search for.
+\return A reference to the object.
+\throw HashMapException::KeyDoesNotExist if the key does not exist.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline DataType & HashMap<DataType, KeyType, Hasher, KeyEqual>::Get(
+    const KeyType & key)
+{
+    SizeType index = FindIndex(key, hasher(key));
+    if (index == NotFound)
+        throw HashMapException::KeyDoesNotExist;
+    return m_slots[index].m_a;
+}
+/**Get the object at \p key.
+\param key The key to search for.
+\return A reference to the object.
+\throw HashMapException::KeyDoesNotExist if the key does not exist.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline const DataType & HashMap<DataType, KeyType, Hasher, KeyEqual>::Get(
+    const KeyType & key) const
+{
+    SizeType index = FindIndex(key, hasher(key));
+    if (index == NotFound)
+        throw HashMapException::KeyDoesNotExist;
+    return m_slots[index].m_a;
+}
+/**Get the object at \p key.
+\param key The key to search for.
+\return A reference to the object.
+\throw HashMapException::KeyDoesNotExist if the key does not exist.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline DataType & HashMap<DataType, KeyType, Hasher, KeyEqual>::operator[](
+    const KeyType & key)
+{
+    return Get(key);
+}
+/**Get the object at \p key.
+\param key The key to search for.
+\return A reference to the object.
+\throw HashMapException::KeyDoesNotExist if the key does not exist.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline const DataType &
+HashMap<DataType, KeyType, Hasher, KeyEqual>::operator[](
+    const KeyType & key) const
+{
+    return Get(key);
+}
+/**Count the objects at \p key.
+\param key The key to search for.
+\return 1 if the key is in the map, otherwise 0.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline SizeType HashMap<DataType, KeyType, Hasher, KeyEqual>::Count(
+    const KeyType & key) const
+{
+    return FindIndex(key, hasher(key)) == NotFound ? 0 : 1;
+}
+/**Find the object at \p key.
+\param key The key to search for.
+\return An iterator to the key and object, or End() if it is not there.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::Iterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::Find(const KeyType & key)
+{
+    SizeType index = FindIndex(key, hasher(key));
+    if (index == NotFound)
+        return End();
+    return Iterator(m_ctrl, m_slots, index, m_capacity);
+}
+/**Find the object at \p key.
+\param key The key to search for.
+\return An iterator to the key and object, or End() if it is not there.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::ConstIterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::Find(const KeyType & key) const
+{
+    SizeType index = FindIndex(key, hasher(key));
+    if (index == NotFound)
+        return End();
+    return ConstIterator(m_ctrl, m_slots, index, m_capacity);
+}
+/**Make sure \p amt items fit without the map growing.
+\param amt The amount of items to make room for.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::Reserve(
+    SizeType amt)
+{
+    if (amt <= MaxLoad(m_capacity))
+        return;
+    SizeType capacity = MinCapacity;
+    while (MaxLoad(capacity) < amt)
+        capacity *= 2;
+    Rehash(capacity);
+}
+/**Remove all the items. The memory is kept.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::Clear()
+{
+    if (m_capacity == 0)
+        return;
+    for (SizeType i = 0; i < m_capacity; ++i)
+        if (m_ctrl[i] != HashMapEmpty)
+            m_slots[i].~PairType();
+    std::memset(m_ctrl, (unsigned char)HashMapEmpty,
+        m_capacity + HashMapGroup::Width - 1);
+    m_size = 0;
+}
+/**Get the size of the map.
+\return The amount of items in the map.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline SizeType HashMap<DataType, KeyType, Hasher, KeyEqual>::Size() const
+{
+    return m_size;
+}
+/**Get the amount of slots.
+\return The amount of slots. Up to 7/8ths of them are used before it grows.
+*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline SizeType HashMap<DataType, KeyType, Hasher, KeyEqual>::Capacity() const
+{
+    return m_capacity;
+}
+/**Determine if the map is empty.
+\return True if the map is empty.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline bool HashMap<DataType, KeyType, Hasher, KeyEqual>::Empty() const
+{
+    return m_size == 0;
+}
+/**Get the beginning iterator.
+\return An iterator at the first used slot.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::ConstIterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::Begin() const
+{
+    return ConstIterator(m_ctrl, m_slots, 0, m_capacity);
+}
+/**Get the beginning iterator.
+\return An iterator at the first used slot.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::Iterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::Begin()
+{
+    return Iterator(m_ctrl, m_slots, 0, m_capacity);
+}
+/**Get the reverse beginning iterator.
+\return An iterator at the last used slot.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>
+::ConstReverseIterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::RBegin() const
+{
+    return ConstReverseIterator(m_ctrl, m_slots, m_capacity - 1, m_capacity);
+}
+/**Get the reverse beginning iterator.
+\return An iterator at the last used slot.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::ReverseIterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::RBegin()
+{
+    return ReverseIterator(m_ctrl, m_slots, m_capacity - 1, m_capacity);
+}
+/**Get the ending iterator.
+\return An iterator one past the last slot.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::ConstIterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::End() const
+{
+    return ConstIterator(m_ctrl, m_slots, m_capacity, m_capacity);
+}
+/**Get the ending iterator.
+\return An iterator one past the last slot.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::Iterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::End()
+{
+    return Iterator(m_ctrl, m_slots, m_capacity, m_capacity);
+}
+/**Get the reverse ending iterator.
+\return An iterator one before the first slot.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>
+::ConstReverseIterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::REnd() const
+{
+    return ConstReverseIterator(m_ctrl, m_slots, (SizeType)-1, m_capacity);
+}
+/**Get the reverse ending iterator.
+\return An iterator one before the first slot.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline typename HashMap<DataType, KeyType, Hasher, KeyEqual>::ReverseIterator
+HashMap<DataType, KeyType, Hasher, KeyEqual>::REnd()
+{
+    return ReverseIterator(m_ctrl, m_slots, (SizeType)-1, m_capacity);
+}
+/**Get the amount of items that fit before the map must grow.
+\param capacity The amount of slots.
+\return 7/8ths of \p capacity.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline SizeType HashMap<DataType, KeyType, Hasher, KeyEqual>::MaxLoad(
+    SizeType capacity)
+{
+    return capacity - capacity / 8;
+}
+/**Get the control byte for a hash.
+\param hash The hash of a key.
+\return The low 7 bits of \p hash.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline int8_t HashMap<DataType, KeyType, Hasher, KeyEqual>::Tag(
+    SizeType hash)
+{
+    return (int8_t)(hash & 0x7F);
+}
+/**Get the home slot for a hash.  The bits used by the tag are skipped so
+the tag tells keys in the same run apart.
+\param hash The hash of a key.
+\return The slot where the probe for \p hash starts.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline SizeType HashMap<DataType, KeyType, Hasher, KeyEqual>::Home(
+    SizeType hash) const
+{
+    return (hash >> 7) & (m_capacity - 1);
+}
+/**Find the slot of a key.
+
+Every slot from the home of a key to the slot it is in is used, so the probe
+can stop at the first group that has an empty slot.
+\param key The key.
+\param hash The hash of \p key.
+\return The slot of \p key, or NotFound.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline SizeType HashMap<DataType, KeyType, Hasher, KeyEqual>::FindIndex(
+    const KeyType & key, SizeType hash) const
+{
+    if (m_size == 0)
+        return NotFound;
+    const SizeType mask = m_capacity - 1;
+    const int8_t tag = Tag(hash);
+    SizeType pos = Home(hash);
+    while (true)
+    {
+        HashMapGroup group(m_ctrl + pos);
+        for (uint32_t bits = group.Match(tag); bits != 0; bits &= bits - 1)
+        {
+            SizeType index = (pos + HashMapLowestBit(bits)) & mask;
+            if (equal(m_slots[index].m_b, key))
+                return index;
+        }
+        if (group.MatchEmpty() != 0)
+            return NotFound;
+        pos = (pos + HashMapGroup::Width) & mask;
+    }
+}
+/**Find the first empty slot on the probe path of a hash.
+\pre There must be an empty slot, which the load limit makes sure of.
+\param hash The hash of a key.
+\return The slot to put the key in.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline SizeType HashMap<DataType, KeyType, Hasher, KeyEqual>::FindEmpty(
+    SizeType hash) const
+{
+    const SizeType mask = m_capacity - 1;
+    SizeType pos = Home(hash);
+    while (true)
+    {
+        uint32_t empty = HashMapGroup(m_ctrl + pos).MatchEmpty();
+        if (empty != 0)
+            return (pos + HashMapLowestBit(empty)) & mask;
+        pos = (pos + HashMapGroup::Width) & mask;
+    }
+}
+/**Set a control byte and its copy at the end if it has one.
+\param index The slot.
+\param ctrl The control byte.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::SetCtrl(
+    SizeType index, int8_t ctrl)
+{
+    m_ctrl[index] = ctrl;
+    if (index < HashMapGroup::Width - 1)
+        m_ctrl[m_capacity + index] = ctrl;
+}
+/**Double the amount of slots.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::Grow()
+{
+    Rehash(m_capacity == 0 ? MinCapacity : m_capacity * 2);
+}
+/**Move every item into a new set of slots.
+\param capacity The new amount of slots. Must be a power of 2 that holds
+all the items.
+\throw HashMapException::OutOfMemory if the memory could not be had. The map
+is left as it was.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::Rehash(
+    SizeType capacity)
+{
+    int8_t* ctrl = (int8_t*)std::malloc(capacity + HashMapGroup::Width - 1);
+    PairType* slots = (PairType*)std::malloc(sizeof(PairType) * capacity);
+    if (!ctrl || !slots)
+    {
+        std::free(ctrl);
+        std::free(slots);
+        throw HashMapException::OutOfMemory;
+    }
+    std::memset(ctrl, (unsigned char)HashMapEmpty,
+        capacity + HashMapGroup::Width - 1);
+    int8_t* oldCtrl = m_ctrl;
+    PairType* oldSlots = m_slots;
+    SizeType oldCapacity = m_capacity;
+    m_ctrl = ctrl;
+    m_slots = slots;
+    m_capacity = capacity;
+    m_size = 0;
+    for (SizeType i = 0; i < oldCapacity; ++i)
+    {
+        if (oldCtrl[i] == HashMapEmpty)
+            continue;
+        Place(hasher(oldSlots[i].m_b), Move(oldSlots[i]));
+        oldSlots[i].~PairType();
+    }
+    std::free(oldCtrl);
+    std::free(oldSlots);
+}
+/**Put an item in the first empty slot on its probe path.
+\pre The key must not be in the map and there must be room for it.
+\param hash The hash of the key.
+\param p The item.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::Place(
+    SizeType hash, PairType && p)
+{
+    SizeType index = FindEmpty(hash);
+    new (m_slots + index) PairType(Forward<PairType>(p));
+    SetCtrl(index, Tag(hash));
+    ++m_size;
+}
+/**Destroy the items and free the memory.*/
+template<typename DataType, typename KeyType, typename Hasher,
+    typename KeyEqual>
+inline void HashMap<DataType, KeyType, Hasher, KeyEqual>::Free()
+{
+    Clear();
+    std::free(m_ctrl);
+    std::free(m_slots);
+    m_ctrl = nullptr;
+    m_slots = nullptr;
+    m_capacity = 0;
+}
+
+}
@@ -0,0 +1,202 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "HashMapIterator.hpp"
+#include "../../../Hash.hpp"
+
+namespace cg {
+
+/**Hash map exceptions*/
+enum class HashMapException
+{
+    /**Key does not exist*/
+    KeyDoesNotExist,
+    /**The map could not get memory*/
+    OutOfMemory,
+};
+
+/**The default hasher for HashMap. Uses cg::Hash.*/
+template<typename T>
+struct DefaultHash
+{
+    /**Hash a key.
+    \param key The key.
+    \return The hash of \p key.*/
+    inline SizeType operator()(const T& key) const
+    {
+        return (SizeType)cg::Hash(key);
+    }
+};
+
+/**Equal to functor*/
+template<typename T>
+struct EqualTo
+{
+    /**Compare a with b.
+    \param a The first item.
+    \param b The second item.
+    \return True if a and b are the same.*/
+    inline bool operator()(const T& a, const T& b) const
+    {
+        return a == b;
+    }
+};
+
+/**An open addressing hash map with its data held flat in one block.
+
+Each slot has a control byte that is either HashMapEmpty or the low 7 bits
+of the hash of its key.  Lookups start at the home slot of a key and check
+HashMapGroup::Width control bytes at a time, so most of them touch a single
+group and compare only the keys whose tag matches.  Probing is linear, which
+lets Pop shift the rest of the run back instead of leaving tombstones behind,
+so a map that has keys popped never slows down or needs a rehash to clean up.
+\tparam DataType The type of data to store.
+\tparam KeyType The type of key used to find data.
+\tparam Hasher A functor that hashes a key to a SizeType.
+\tparam KeyEqual A functor that returns true if two keys are the same.*/
+template<typename DataType, typename KeyType,
+    typename Hasher = DefaultHash<KeyType>,
+    typename KeyEqual = EqualTo<KeyType>>
+class HashMap
+{
+public:
+    /**The type of pair*/
+    using PairType = Pair<DataType, KeyType>;
+    /**A reverse moving iterator type*/
+    using ReverseIterator = HashMapIterator<PairType, false, true>;
+    /**The standard forward iterator*/
+    using Iterator = HashMapIterator<PairType, false, false>;
+    /**A const reverse moving iterator*/
+    using ConstReverseIterator = HashMapIterator<PairType, true, true>;
+    /**A forward moving const iterator*/
+    using ConstIterator = HashMapIterator<PairType, true, false>;
+    /**The type of self.*/
+    using SelfType = HashMap<DataType, KeyType, Hasher, KeyEqual>;
+
+    HashMap() :m_ctrl(nullptr), m_slots(nullptr), m_size(0),
+        m_capacity(0) {}
+
+    explicit HashMap(SizeType amt);
+
+    HashMap(const SelfType& other);
+
+    SelfType& operator=(const SelfType& other);
+
+    HashMap(SelfType&& other);
+
+    SelfType& operator=(SelfType&& other);
+
+    ~HashMap();
+
+    void Push(KeyType&& key, DataType&& o);
+
+    void Push(PairType&& p);
+
+    template<typename... Ts>
+    bool Emplace(KeyType&& key, Ts&&...ts);
+
+    bool Pop(const KeyType& key);
+
+    DataType& Get(const KeyType& key);
+
+    const DataType& Get(const KeyType& key) const;
+
+    DataType& operator[](const KeyType& key);
+
+    const DataType& operator[](const KeyType& key) const;
+
+    SizeType Count(const KeyType& key) const;
+
+    Iterator Find(const KeyType& key);
+
+    ConstIterator Find(const KeyType& key) const;
+
+    void Reserve(SizeType amt);
+
+    void Clear();
+
+    SizeType Size() const;
+
+    SizeType Capacity() const;
+
+    bool Empty() const;
+
+    ConstIterator Begin() const;
+
+    Iterator Begin();
+
+    ConstReverseIterator RBegin() const;
+
+    ReverseIterator RBegin();
+
+    ConstIterator End() const;
+
+    Iterator End();
+
+    ConstReverseIterator REnd() const;
+
+    ReverseIterator REnd();
+private:
+    /**The smallest amount of slots. At least a group, so a group load from
+    any slot stays inside the control bytes.*/
+    static const SizeType MinCapacity = HashMapGroup::Width;
+    /**Returned when a key is not found.*/
+    static const SizeType NotFound = (SizeType)-1;
+
+    static SizeType MaxLoad(SizeType capacity);
+
+    static int8_t Tag(SizeType hash);
+
+    SizeType Home(SizeType hash) const;
+
+    SizeType FindIndex(const KeyType& key, SizeType hash) const;
+
+    SizeType FindEmpty(SizeType hash) const;
+
+    void SetCtrl(SizeType index, int8_t ctrl);
+
+    void Grow();
+
+    void Rehash(SizeType capacity);
+
+    void Place(SizeType hash, PairType&& p);
+
+    void Free();
+
+    /**The control bytes. There are HashMapGroup::Width - 1 extra at the end
+    that copy the first ones, so a group can be loaded from the last slots
+    without wrapping.*/
+    int8_t* m_ctrl;
+    /**The slots. Only the ones with a tag in m_ctrl are constructed.*/
+    PairType* m_slots;
+    /**The amount of used slots.*/
+    SizeType m_size;
+    /**The amount of slots. Always 0 or a power of 2.*/
+    SizeType m_capacity;
+    /**The hasher*/
+    static const Hasher hasher;
+    /**The key comparator*/
+    static const KeyEqual equal;
+};
+
+}
@@ -0,0 +1,116 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CG_HASHMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "cgdef.hpp"
+
+namespace cg {
+
+/**The control byte of an unused slot. It is the only control byte with the
+high bit set, so the empty slots of a group are just its sign bits.  A used
+slot holds the low 7 bits of its hash instead.*/
+const int8_t HashMapEmpty = (int8_t)0x80;
+
+/**Get the index of the lowest set bit.
+\pre \p bits must not be 0.
+\param bits The bits to look at.
+\return The index of the lowest set bit.*/
+inline SizeType HashMapLowestBit(uint32_t bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return (SizeType)index;
+#else
+    return (SizeType)__builtin_ctz(bits);
+#endif
+}
+
+/**A group of control bytes that are checked all at once.
+
+The bytes are loaded from any slot, not just aligned ones, so a probe can
+start right at the home slot of a key.  A match is a bit mask with bit i set
+if slot i of the group matches.*/
+class HashMapGroup
+{
+public:
+    /**The amount of slots in a group.*/
+    static const SizeType Width = 16;
+    /**Load a group.
+    \param ctrl A pointer to the first control byte of the group. There must
+    be Width bytes to read.*/
+    explicit HashMapGroup(const int8_t* ctrl)
+#ifdef CG_HASHMAP_SSE2
+        :m_ctrl(_mm_loadu_si128((const __m128i*)ctrl)) {}
+#else
+        :m_ctrl(ctrl) {}
+#endif
+    /**Find the slots that have a certian hash tag.
+    \param tag The low 7 bits of a hash.
+    \return The mask of the slots with \p tag.*/
+    uint32_t Match(int8_t tag) const
+    {
+#ifdef CG_HASHMAP_SSE2
+        return (uint32_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_set1_epi8(tag), m_ctrl));
+#else
+        uint32_t mask = 0;
+        for (SizeType i = 0; i < Width; ++i)
+            mask |= (uint32_t)(m_ctrl[i] == tag) << i;
+        return mask;
+#endif
+    }
+    /**Find the empty slots.
+    \return The mask of the empty slots.*/
+    uint32_t MatchEmpty() const
+    {
+#ifdef CG_HASHMAP_SSE2
+        return (uint32_t)_mm_movemask_epi8(m_ctrl);
+#else
+        uint32_t mask = 0;
+        for (SizeType i = 0; i < Width; ++i)
+            mask |= (uint32_t)(m_ctrl[i] < 0) << i;
+        return mask;
+#endif
+    }
+private:
+    /**The control bytes.*/
+#ifdef CG_HASHMAP_SSE2
+    __m128i m_ctrl;
+#else
+    const int8_t* m_ctrl;
+#endif
+};
+
+}
@@ -0,0 +1,202 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "HashMapIteratorDef.hpp"
+
+namespace cg {
+
+/**Create an iterator that sits on \p index, or the first used slot after it
+in the direction of travel.
+\param ctrl The control bytes of the map.
+\param slots The slots of the map.
+\param index The slot to start at.
+\param capacity The amount of slots in the map.*/
+template<typename PairType, bool Const, bool Reverse>
+inline HashMapIterator<PairType, Const, Reverse>::HashMapIterator(
+    const int8_t* ctrl, Ptr slots, SizeType index, SizeType capacity)
+    :m_ctrl(ctrl), m_slots(slots), m_index(index), m_capacity(capacity)
+{
+    Settle(!Reverse);
+}
+/**Determine if the iterator can be dereferenced.
+\return True if the iterator is on a used slot.*/
+template<typename PairType, bool Const, bool Reverse>
+inline HashMapIterator<PairType, Const, Reverse>::operator bool() const
+{
+    return m_index < m_capacity;
+}
+/**Dereference the iterator.
+\pre The object must point to something.
+\return A reference to the data.*/
+template<typename PairType, bool Const, bool Reverse>
+inline typename HashMapIterator<PairType, Const, Reverse>::Ref
+HashMapIterator<PairType, Const, Reverse>::operator*()
+{
+    CheckAndThrow();
+    return m_slots[m_index];
+}
+/**Dereference the iterator.
+\pre The object must point to something.
+\return A reference to the data.*/
+template<typename PairType, bool Const, bool Reverse>
+inline const typename HashMapIterator<PairType, Const, Reverse>::Ref
+HashMapIterator<PairType, Const, Reverse>::operator*() const
+{
+    CheckAndThrow();
+    return m_slots[m_index];
+}
+/**Pointer to member access.
+\pre The object must point to something.
+\return A pointer to the data.*/
+template<typename PairType, bool Const, bool Reverse>
+inline typename HashMapIterator<PairType, Const, Reverse>::Ptr
+HashMapIterator<PairType, Const, Reverse>::operator->()
+{
+    CheckAndThrow();
+    return m_slots + m_index;
+}
+/**Pointer to member access.
+\pre The object must point to something.
+\return A pointer to the data.*/
+template<typename PairType, bool Const, bool Reverse>
+inline const typename HashMapIterator<PairType, Const, Reverse>::Ptr
+HashMapIterator<PairType, Const, Reverse>::operator->() const
+{
+    CheckAndThrow();
+    return m_slots + m_index;
+}
+/**Postincrement the iterator to the next used slot.
+\pre The object must point to something.
+\return A copy of this object before the increment happened.*/
+template<typename PairType, bool Const, bool Reverse>
+inline typename HashMapIterator<PairType, Const, Reverse>::SelfType
+HashMapIterator<PairType, Const, Reverse>::operator++(int)
+{
+    CheckAndThrow();
+    SelfType copy = *this;
+    Step(!Reverse);
+    return copy;
+}
+/**Preincrement the iterator to the next used slot.
+\pre The object must point to something.
+\return A reference to this object after increment happens.*/
+template<typename PairType, bool Const, bool Reverse>
+inline typename HashMapIterator<PairType, Const, Reverse>::SelfType &
+HashMapIterator<PairType, Const, Reverse>::operator++()
+{
+    CheckAndThrow();
+    Step(!Reverse);
+    return *this;
+}
+/**Postdecrement the iterator to the previous used slot.
+\return A copy of this object before the decrement happened.*/
+template<typename PairType, bool Const, bool Reverse>
+inline typename HashMapIterator<PairType, Const, Reverse>::SelfType
+HashMapIterator<PairType, Const, Reverse>::operator--(int)
+{
+    SelfType copy = *this;
+    Step(Reverse);
+    return copy;
+}
+/**Predecrement the iterator to the previous used slot.
+\return A reference to this object after decrement happens.*/
+template<typename PairType, bool Const, bool Reverse>
+inline typename HashMapIterator<PairType, Const, Reverse>::SelfType &
+HashMapIterator<PairType, Const, Reverse>::operator--()
+{
+    Step(Reverse);
+    return *this;
+}
+/**Determine if two iterators are different.
+\param other The other iterator.
+\return True if the iterators are on different slots.*/
+template<typename PairType, bool Const, bool Reverse>
+inline bool HashMapIterator<PairType, Const, Reverse>::operator!=(
+    const SelfType & other) const
+{
+    return !(*this == other);
+}
+/**Determine if two iterators are the same.
+\param other The other iterator.
+\return True if the iterators are on the same slot of the same map.*/
+template<typename PairType, bool Const, bool Reverse>
+inline bool HashMapIterator<PairType, Const, Reverse>::operator==(
+    const SelfType & other) const
+{
+    return m_slots == other.m_slots && m_index == other.m_index;
+}
+/**Get the address of the data.
+\return A pointer to the data, or null at the end.*/
+template<typename PairType, bool Const, bool Reverse>
+inline typename HashMapIterator<PairType, Const, Reverse>::Ptr
+HashMapIterator<PairType, Const, Reverse>::Addr()
+{
+    return *this ? m_slots + m_index : nullptr;
+}
+/**Get the address of the data.
+\return A pointer to the data, or null at the end.*/
+template<typename PairType, bool Const, bool Reverse>
+inline const typename HashMapIterator<PairType, Const, Reverse>::Ptr
+HashMapIterator<PairType, Const, Reverse>::Addr() const
+{
+    return *this ? m_slots + m_index : nullptr;
+}
+/**Get the slot the iterator is on.
+\return The slot index.*/
+template<typename PairType, bool Const, bool Reverse>
+inline SizeType HashMapIterator<PairType, Const, Reverse>::Index() const
+{
+    return m_index;
+}
+/**Check and throw and exceptions needed.
+\throw HashMapIteratorException::NotDereferenceable if the iterator is at
+an end.*/
+template<typename PairType, bool Const, bool Reverse>
+inline void HashMapIterator<PairType, Const, Reverse>::CheckAndThrow() const
+{
+    if (!*this)
+        throw HashMapIteratorException::NotDereferenceable;
+}
+/**Move to the next used slot in the direction of travel, or to the end.
+\param forward True to go toward the end of the slots.*/
+template<typename PairType, bool Const, bool Reverse>
+inline void HashMapIterator<PairType, Const, Reverse>::Step(bool forward)
+{
+    /*both ends are outside of [0, capacity) so stepping off one end is
+    caught by the same check.*/
+    m_index += forward ? 1 : (SizeType)-1;
+    Settle(forward);
+}
+/**Stay on the current slot if it is used, otherwise step.
+\param forward The direction to step.*/
+template<typename PairType, bool Const, bool Reverse>
+inline void HashMapIterator<PairType, Const, Reverse>::Settle(bool forward)
+{
+    while (m_index < m_capacity && m_ctrl[m_index] == HashMapEmpty)
+        m_index += forward ? 1 : (SizeType)-1;
+    /*any place off the end is the end.*/
+    if (m_index >= m_capacity)
+        m_index = forward ? m_capacity : (SizeType)-1;
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "HashMapGroup.hpp"
+
+namespace cg {
+
+enum class HashMapIteratorException
+{
+    /**The iterator was not dereferencable.*/
+    NotDereferenceable,
+};
+
+/**An iterator over the used slots of a HashMap. The order is the slot order,
+which has nothing to do with the keys.
+\tparam PairType The type in each slot.
+\tparam Const True if the data can not be changed through the iterator.
+\tparam Reverse True to walk the slots from last to first.*/
+template<typename PairType, bool Const, bool Reverse>
+class HashMapIterator
+{
+public:
+    /**The type of data reference to return.*/
+    using Ref = ConditionalType<Const, const PairType&, PairType&>;
+    /**The type of data pointer to return.*/
+    using Ptr = ConditionalType<Const, const PairType*, PairType*>;
+    /**The type of this object.*/
+    using SelfType = HashMapIterator<PairType, Const, Reverse>;
+
+    HashMapIterator() :m_ctrl(nullptr), m_slots(nullptr), m_index(0),
+        m_capacity(0) {}
+
+    HashMapIterator(const int8_t* ctrl, Ptr slots, SizeType index,
+        SizeType capacity);
+
+    HashMapIterator(const SelfType& other) = default;
+
+    SelfType& operator=(const SelfType& other) = default;
+
+    operator bool() const;
+
+    Ref operator*();
+
+    const Ref operator*() const;
+
+    Ptr operator->();
+
+    const Ptr operator->() const;
+
+    SelfType operator++(int);
+
+    SelfType& operator++();
+
+    SelfType operator--(int);
+
+    SelfType& operator--();
+
+    bool operator!=(const SelfType& other) const;
+
+    bool operator==(const SelfType& other) const;
+
+    Ptr Addr();
+
+    const Ptr Addr() const;
+
+    SizeType Index() const;
+private:
+    /**Check and throw and exceptions needed*/
+    void CheckAndThrow() const;
+    /**Move to the next used slot in the direction of travel, or to the end.
+    \param forward True to go toward the end of the slots.*/
+    void Step(bool forward);
+    /**Stay on the current slot if it is used, otherwise step.
+    \param forward The direction to step.*/
+    void Settle(bool forward);
+    /**The control bytes of the map.*/
+    const int8_t* m_ctrl;
+    /**The slots of the map.*/
+    Ptr m_slots;
+    /**The current slot. The forward end is the capacity and the reverse end
+    is one before slot 0, which wraps to the largest SizeType.*/
+    SizeType m_index;
+    /**The amount of slots in the map.*/
+    SizeType m_capacity;
+};
+
+}
@@ -67,6 +67,7 @@ inline LinkedList<DataType> & LinkedList<DataType>::operator=(
 {
     if (this == &o)
         return *this;
+    Clear();
     auto it = o.Begin();
     auto end = o.End();
     for (; it != end; ++it)
@@ -82,12 +83,35 @@ inline LinkedList<DataType> & LinkedList<DataType>::operator=(
 {
     if (this == &o)
         return *this;
+    Clear();
     m_first = o.m_first;
     m_last = o.m_last;
+    m_pool = Move(o.m_pool);
     o.m_first = nullptr;
     o.m_last = nullptr;
     return *this;
 }
+/**Destroy the elements and free the nodes.*/
+template<typename DataType>
+inline LinkedList<DataType>::~LinkedList()
+{
+    Clear();
+}
+/**Remove every element and give the node memory back.*/
+template<typename DataType>
+inline void LinkedList<DataType>::Clear()
+{
+    auto n = m_first;
+    while (n)
+    {
+        auto next = n->m_next;
+        m_pool.Delete(n);
+        n = next;
+    }
+    m_pool.Release();
+    m_first = nullptr;
+    m_last = nullptr;
+}
 
 /**Create a list from a pointer of data.
 \param ptr A pointer to an array of data.
@@ -110,13 +134,13 @@ inline void LinkedList<DataType>::PushBack(DataType && o)
 {
     if (!m_last)
     {
-        m_first = new LinkedListNode<DataType>(Forward<DataType>(o),
+        m_first = m_pool.New(Forward<DataType>(o),
             nullptr, nullptr);
         m_last = m_first;
         return;
     }
     auto oldLast = m_last;
-    m_last = new LinkedListNode<DataType>(Forward<DataType>(o),
+    m_last = m_pool.New(Forward<DataType>(o),
         nullptr, oldLast);
     oldLast->m_next = m_last;
 }
@@ -127,13 +151,13 @@ inline void LinkedList<DataType>::PushFront(DataType && o)
 {
     if (!m_first)
     {
-        m_first = new LinkedListNode<DataType>(Forward<DataType>(o),
+        m_first = m_pool.New(Forward<DataType>(o),
             nullptr, nullptr);
         m_last = m_first;
         return;
     }
     auto oldFirst = m_first;
-    m_first = new LinkedListNode<DataType>(Forward<DataType>(o),
+    m_first = m_pool.New(Forward<DataType>(o),
         oldFirst, nullptr);
     oldFirst->m_prev = m_first;
 }
@@ -145,13 +169,13 @@ inline void LinkedList<DataType>::EmplaceBack(Ts && ...o)
 {
     if (!m_first)
     {
-        m_first = new LinkedListNode<DataType>();
+        m_first = m_pool.New();
         new (&m_first->m_data) DataType(Forward<Ts>(o)...);
         m_last = m_first;
         return;
     }
     auto oldLast = m_last;
-    m_last = new LinkedListNode<DataType>();
+    m_last = m_pool.New();
     new (&m_last->m_data) DataType(Forward<Ts>(o)...);
     oldLast->m_next = m_last;
     m_last->m_prev = oldLast;
@@ -164,13 +188,13 @@ inline void LinkedList<DataType>::EmplaceFront(Ts && ...o)
 {
     if (!m_first)
     {
-        m_first = new LinkedListNode<DataType>();
+        m_first = m_pool.New();
         new (&m_first->m_data) DataType(Forward<Ts>(o)...);
         m_last = m_first;
         return;
     }
     auto oldFirst = m_first;
-    m_first = new LinkedListNode<DataType>();
+    m_first = m_pool.New();
     new (&m_first->m_data) DataType(Forward<Ts>(o)...);
     oldFirst->m_prev = m_first;
     m_first->m_next = oldFirst;
@@ -252,14 +276,14 @@ inline void LinkedList<DataType>::PopBack()
         throw LinkedListException::IndexOutOfBounds;
     if (!m_last->m_prev)
     {
-        delete m_last;
+        m_pool.Delete(m_last);
         m_last = nullptr;
         m_first = nullptr;
     }
     else
     {
         auto old = m_last->m_prev;
-        delete m_last;
+        m_pool.Delete(m_last);
         m_last = old;
         m_last->m_next = nullptr;
     }
@@ -276,14 +300,14 @@ inline void LinkedList<DataType>::PopFront()
         throw LinkedListException::IndexOutOfBounds;
     if (!m_first->m_next)
     {
-        delete m_last;
+        m_pool.Delete(m_last);
         m_last = nullptr;
         m_first = nullptr;
     }
     else
     {
         auto old = m_first->m_next;
-        delete m_first;
+        m_pool.Delete(m_first);
         m_first = old;
         m_first->m_prev = nullptr;
     }
@@ -311,7 +335,7 @@ LinkedList<DataType>::PushAfter(Iterator & it, DataType && d)
 {
     if (!it)
         throw LinkedListException::InvalidIterator;
-    auto n = new LinkedListNode<DataType>(Forward<DataType>(d),
+    auto n = m_pool.New(Forward<DataType>(d),
         it.m_ptr->m_next, it.m_ptr);
     it.m_ptr->m_next = n;
     n->m_next->m_prev = n;
@@ -396,7 +420,7 @@ LinkedList<DataType>::EmplaceAfter(Iterator & it, Ts && ...ts)
 {
     if (!it)
         throw LinkedListException::InvalidIterator;
-    auto n = new LinkedListNode<DataType>(it.m_ptr->m_next, it.m_ptr);
+    auto n = m_pool.New(it.m_ptr->m_next, it.m_ptr);
     new (&n->m_data) DataType(Forward<Ts>(ts)...);
     it.m_ptr->m_next = n;
     n->m_next->m_prev = n;
@@ -22,6 +22,7 @@ along with _PROJECT_NAME_.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include "LinkedListIterator.hpp"
+#include "LinkedListPool.hpp"
 
 
 namespace cg {
@@ -37,7 +38,8 @@ enum class LinkedListException
     InvalidIterator,
 };
 
-/**Double linked list
+/**Double linked list.  The nodes come from a slab pool owned by the list, so
+they are allocated in blocks and sit next to each other in memory.
 \tparam DataType The type of data to store.*/
 template<typename DataType>
 class LinkedList
@@ -69,6 +71,8 @@ public:
 
     LinkedList<DataType>& operator=(LinkedList<DataType>&& o);
 
+    ~LinkedList();
+
     LinkedList(const DataType* ptr, SizeType size);
 
     cg::SizeType Empty() const;
@@ -103,6 +107,7 @@ public:
 
     void PopFront();
 
+    void Clear();
 
     ReverseIterator PushAfter(ReverseIterator& it, DataType&& d);
 
@@ -133,10 +138,11 @@ public:
     DataType& Front();
 private:
     /**The first node.*/
-    LinkedListNode<DataType>* m_first;
+    LinkedListNode<DataType>* m_first = nullptr;
     /**The last node*/
-    LinkedListNode<DataType>* m_last;
-
+    LinkedListNode<DataType>* m_last = nullptr;
+    /**Where the nodes come from.*/
+    LinkedListPool<LinkedListNode<DataType>> m_pool;
 
 };
 
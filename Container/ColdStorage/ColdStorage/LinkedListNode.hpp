@@ -31,10 +31,11 @@ template<typename DataType>
 class LinkedListNode
 {
     template<typename ListDataType> friend class LinkedList;
+    template<typename NodeType> friend class LinkedListPool;
     template<typename DataType, bool Const, bool Reverse>
     friend class LinkedListIterator;
     /**Default ctor*/
-    LinkedListNode() {};
+    LinkedListNode() :m_next(nullptr), m_prev(nullptr) {};
     /**Create with data
     \param data The data.
     \param next The next pointer.
@@ -60,14 +61,6 @@ class LinkedListNode
     };
     /**Destroy*/
     ~LinkedListNode() {};
-    /**Clean off this node, deleteing any children.*/
-    void Clean() {
-        if (m_next)
-        {
-            m_next->Clean();
-            delete m_next;
-        }
-    }
     /**Determine if this node is equal to another.
     \param o The other node.*/
     bool operator==(const LinkedListNode<DataType>& o) const
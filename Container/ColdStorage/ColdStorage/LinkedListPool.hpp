@@ -0,0 +1,175 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <cstdlib>
+#include <new>
+
+#include "cgdef.hpp"
+
+
+namespace cg {
+
+/**A slab allocator for list nodes.
+
+Nodes are carved out of slabs, each twice the size of the last up to
+MaxSlab, so n pushes cost O(log n) allocations instead of n.  Fresh nodes
+are handed out in address order, so a list built front to back is laid out
+front to back and a walk over it mostly stays in cache.  Deleted nodes go on
+a free list and are reused first.  Nodes never move, so pointers to them
+stay good until they are deleted.
+\tparam NodeType The type of node.*/
+template<typename NodeType>
+class LinkedListPool
+{
+public:
+    /**The amount of nodes in the first slab.*/
+    const static cg::SizeType FirstSlab = 8;
+    /**The most nodes in one slab.*/
+    const static cg::SizeType MaxSlab = 1024;
+    /**Default ctor. Nothing is allocated until the first node.*/
+    LinkedListPool() {};
+    /**Move ctor. \p other is left empty.
+    \param other The pool to take the slabs from.*/
+    LinkedListPool(LinkedListPool<NodeType>&& other)
+    {
+        *this = Move(other);
+    }
+    /**Move op. Any slabs this pool had are released.
+    \param other The pool to take the slabs from.
+    \return A reference to this object.*/
+    LinkedListPool<NodeType>& operator=(LinkedListPool<NodeType>&& other)
+    {
+        if (this == &other)
+            return *this;
+        Release();
+        m_slabs = other.m_slabs;
+        m_free = other.m_free;
+        m_bump = other.m_bump;
+        m_bumpEnd = other.m_bumpEnd;
+        m_capacity = other.m_capacity;
+        other.m_slabs = nullptr;
+        other.m_free = nullptr;
+        other.m_bump = nullptr;
+        other.m_bumpEnd = nullptr;
+        other.m_capacity = 0;
+        return *this;
+    }
+    /**Release the slabs.*/
+    ~LinkedListPool()
+    {
+        Release();
+    }
+    /**Make a node.
+    \param ts The args to send to the ctor of the node.
+    \return A pointer to the new node.
+    \throw std::bad_alloc if a new slab was needed and could not be had.*/
+    template<typename...Ts>
+    NodeType* New(Ts&&...ts)
+    {
+        Slot* slot = m_free;
+        if (slot)
+            m_free = slot->m_next;
+        else
+        {
+            if (m_bump == m_bumpEnd)
+                Grow();
+            slot = m_bump++;
+        }
+        return new (slot->m_node) NodeType(Forward<Ts>(ts)...);
+    }
+    /**Destroy a node and keep its memory for the next New.
+    \param node The node. Must have come from this pool.*/
+    void Delete(NodeType* node)
+    {
+        node->~NodeType();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->m_next = m_free;
+        m_free = slot;
+    }
+    /**Free every slab.  The nodes are not destroyed, so they must all have
+    been deleted, or be of a type that does not need it.*/
+    void Release()
+    {
+        while (m_slabs)
+        {
+            Slab* next = m_slabs->m_next;
+            std::free(m_slabs);
+            m_slabs = next;
+        }
+        m_free = nullptr;
+        m_bump = nullptr;
+        m_bumpEnd = nullptr;
+        m_capacity = 0;
+    }
+    /**Get the amount of nodes the slabs can hold.
+    \return The amount of nodes.*/
+    cg::SizeType Capacity() const
+    {
+        return m_capacity;
+    }
+private:
+    /**Stop copying*/
+    LinkedListPool(const LinkedListPool<NodeType>&) = delete;
+    /**Stop copying*/
+    void operator=(const LinkedListPool<NodeType>&) = delete;
+    /**The room for one node.  Holds the free list link while unused.*/
+    union Slot
+    {
+        /**The next free slot.*/
+        Slot* m_next;
+        /**The node.*/
+        alignas(NodeType) unsigned char m_node[sizeof(NodeType)];
+    };
+    /**The head of a slab. The slots follow it.*/
+    struct alignas(Slot) alignas(void*) Slab
+    {
+        /**The slab made before this one.*/
+        Slab* m_next;
+    };
+    /**Add a slab twice the size of the last one.*/
+    void Grow()
+    {
+        cg::SizeType count = m_capacity == 0 ? FirstSlab
+            : m_capacity < MaxSlab ? m_capacity : MaxSlab;
+        Slab* slab = (Slab*)std::malloc(sizeof(Slab) + sizeof(Slot) * count);
+        if (!slab)
+            throw std::bad_alloc();
+        slab->m_next = m_slabs;
+        m_slabs = slab;
+        m_bump = reinterpret_cast<Slot*>(slab + 1);
+        m_bumpEnd = m_bump + count;
+        m_capacity += count;
+    }
+    /**The newest slab.*/
+    Slab* m_slabs = nullptr;
+    /**The deleted nodes.*/
+    Slot* m_free = nullptr;
+    /**The next never used slot in the newest slab.*/
+    Slot* m_bump = nullptr;
+    /**One past the last slot in the newest slab.*/
+    Slot* m_bumpEnd = nullptr;
+    /**The amount of slots in all slabs.*/
+    cg::SizeType m_capacity = 0;
+};
+
+}
@@ -0,0 +1,426 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "MappedArrayDef.hpp"
+
+namespace cg {
+
+/**Open or create a mapped array.
+\param path The file to keep the elements in.  If it is there, its elements
+are the elements of the array.
+\param initCap The least amount of elements to have room for.
+\throw MappedArrayException::BadFile if the file is not a mapped array of
+this type.  The file is not changed.
+\throw cg::FileSystemException if the file could not be opened or mapped.*/
+template<typename DataType>
+MappedArray<DataType>::MappedArray(const std::string& path,
+    cg::SizeType initCap)
+    :m_file(path)
+{
+    /*mapped at the size it has, so a file that is not ours is not grown.
+    Only an empty file gets a header; anything else must have one already.*/
+    if (m_file.Size() == 0)
+    {
+        m_file.Resize(HeaderSize);
+        Head()->m_magic = Magic;
+        Head()->m_typeSize = sizeof(DataType);
+    }
+    else if (m_file.Size() < HeaderSize)
+        throw MappedArrayException::BadFile;
+    Header* head = Head();
+    m_cap = (m_file.Size() - HeaderSize) / sizeof(DataType);
+    if (head->m_magic != Magic || head->m_typeSize != sizeof(DataType)
+        || head->m_count > m_cap)
+        throw MappedArrayException::BadFile;
+    ExpandTo(initCap);
+}
+/**Get the amount of elements.
+\return The amount of elements.*/
+template<typename DataType>
+cg::SizeType MappedArray<DataType>::Size() const
+{
+    return (cg::SizeType)Head()->m_count;
+}
+/**Get the amount of elements there is room for without growing the file.
+\return The capacity.*/
+template<typename DataType>
+cg::SizeType MappedArray<DataType>::Capacity() const
+{
+    return m_cap;
+}
+/**Determine if there are no elements.
+\return True if there are none.*/
+template<typename DataType>
+bool MappedArray<DataType>::Empty() const
+{
+    return Head()->m_count == 0;
+}
+/**Make an object at the back of the list.
+\param o The args to make it with.  They may not refer to elements of this
+list.*/
+template<typename DataType>
+template<typename...Ts>
+void MappedArray<DataType>::EmplaceBack(Ts&&... o)
+{
+    cg::SizeType size = Size();
+    if (size == m_cap)
+        ExpandTo(Grown(size + 1));
+    new (Addr(size)) DataType(Forward<Ts>(o)...);
+    Head()->m_count = size + 1;
+}
+/**Copy an object to the back of the list.
+\param o The object.  It may be an element of this list.*/
+template<typename DataType>
+void MappedArray<DataType>::PushBack(const DataType& o)
+{
+    Insert(Size(), o);
+}
+/**Copy a run of objects to the back of the list with one grow and one copy.
+\param arr The objects to copy. Must not point into this list.
+\param amt The amount of objects.*/
+template<typename DataType>
+void MappedArray<DataType>::Append(const DataType* arr, cg::SizeType amt)
+{
+    if (amt == 0)
+        return;
+    cg::SizeType size = Size();
+    if (size + amt > m_cap)
+        ExpandTo(Grown(size + amt));
+    std::memcpy(Addr(size), arr, sizeof(DataType) * amt);
+    Head()->m_count = size + amt;
+}
+/**Copy an object into the list.
+\param i The index to put it at.  Everything from \p i on moves up one.
+\param o The object.  It may be an element of this list.
+\throw ArrayException::IndexOutOfBounds if \p i is past the end.*/
+template<typename DataType>
+void MappedArray<DataType>::Insert(cg::SizeType i, const DataType& o)
+{
+    cg::SizeType size = Size();
+    if (i > size)
+        throw ArrayException::IndexOutOfBounds;
+    /*copied first, since growing can move the view out from under o.*/
+    DataType copy = o;
+    if (size == m_cap)
+        ExpandTo(Grown(size + 1));
+    if (size != i)
+        std::memmove(Addr(i + 1), Addr(i), sizeof(DataType) * (size - i));
+    std::memcpy(Addr(i), &copy, sizeof(DataType));
+    Head()->m_count = size + 1;
+}
+/**Get an element.
+\param i The index.
+\return A reference to the element.
+\throw ArrayException::IndexOutOfBounds if \p i is not an element.*/
+template<typename DataType>
+DataType& MappedArray<DataType>::Get(cg::SizeType i)
+{
+    if (i >= Size())
+        throw ArrayException::IndexOutOfBounds;
+    return *Addr(i);
+}
+/**Get an element.
+\param i The index.
+\return A reference to the element.
+\throw ArrayException::IndexOutOfBounds if \p i is not an element.*/
+template<typename DataType>
+const DataType& MappedArray<DataType>::Get(cg::SizeType i) const
+{
+    if (i >= Size())
+        throw ArrayException::IndexOutOfBounds;
+    return *Addr(i);
+}
+/**Get an element.
+\param i The index.
+\return A reference to the element.
+\throw ArrayException::IndexOutOfBounds if \p i is not an element.*/
+template<typename DataType>
+DataType& MappedArray<DataType>::operator[](cg::SizeType i)
+{
+    return Get(i);
+}
+/**Get an element.
+\param i The index.
+\return A reference to the element.
+\throw ArrayException::IndexOutOfBounds if \p i is not an element.*/
+template<typename DataType>
+const DataType& MappedArray<DataType>::operator[](cg::SizeType i) const
+{
+    return Get(i);
+}
+/**Get the last element.
+\return A reference to the last element.
+\throw ArrayException::ListEmpty if there are no elements.*/
+template<typename DataType>
+const DataType& MappedArray<DataType>::Back() const
+{
+    if (Empty())
+        throw ArrayException::ListEmpty;
+    return Get(Size() - 1);
+}
+/**Get the last element.
+\return A reference to the last element.
+\throw ArrayException::ListEmpty if there are no elements.*/
+template<typename DataType>
+DataType& MappedArray<DataType>::Back()
+{
+    if (Empty())
+        throw ArrayException::ListEmpty;
+    return Get(Size() - 1);
+}
+/**Get the first element.
+\return A reference to the first element.
+\throw ArrayException::ListEmpty if there are no elements.*/
+template<typename DataType>
+const DataType& MappedArray<DataType>::Front() const
+{
+    if (Empty())
+        throw ArrayException::ListEmpty;
+    return Get(0);
+}
+/**Get the first element.
+\return A reference to the first element.
+\throw ArrayException::ListEmpty if there are no elements.*/
+template<typename DataType>
+DataType& MappedArray<DataType>::Front()
+{
+    if (Empty())
+        throw ArrayException::ListEmpty;
+    return Get(0);
+}
+/**Get the begin iterator.
+\return An iterator to the front of the list.*/
+template<typename DataType>
+typename MappedArray<DataType>::Iterator MappedArray<DataType>::Begin()
+{
+    return Iterator(Addr());
+}
+/**Get the begin iterator.
+\return An iterator to the front of the list.*/
+template<typename DataType>
+typename MappedArray<DataType>::ConstIterator
+MappedArray<DataType>::Begin() const
+{
+    return ConstIterator(Addr());
+}
+/**Get the begin iterator.
+\return An iterator to the back of the list.*/
+template<typename DataType>
+typename MappedArray<DataType>::ReverseIterator
+MappedArray<DataType>::RBegin()
+{
+    return ReverseIterator(Addr() + (Size() - 1));
+}
+/**Get the begin iterator.
+\return An iterator to the back of the list.*/
+template<typename DataType>
+typename MappedArray<DataType>::ConstReverseIterator
+MappedArray<DataType>::RBegin() const
+{
+    return ConstReverseIterator(Addr() + (Size() - 1));
+}
+/**Get an iterator to the end+1 of the list.
+\return An iterator to End+1*/
+template<typename DataType>
+typename MappedArray<DataType>::Iterator MappedArray<DataType>::End()
+{
+    return Iterator(Addr() + Size());
+}
+/**Get an iterator to the end+1 of the list.
+\return An iterator to End+1*/
+template<typename DataType>
+typename MappedArray<DataType>::ConstIterator
+MappedArray<DataType>::End() const
+{
+    return ConstIterator(Addr() + Size());
+}
+/**Get an iterator to the begin-1 of the list.
+\return An iterator to Begin-1*/
+template<typename DataType>
+typename MappedArray<DataType>::ReverseIterator
+MappedArray<DataType>::REnd()
+{
+    return ReverseIterator(Addr() - 1);
+}
+/**Get an iterator to the begin-1 of the list.
+\return An iterator to Begin-1*/
+template<typename DataType>
+typename MappedArray<DataType>::ConstReverseIterator
+MappedArray<DataType>::REnd() const
+{
+    return ConstReverseIterator(Addr() - 1);
+}
+/**Erase a unit from the storage.
+\param i The index to erase.*/
+template<typename DataType>
+void MappedArray<DataType>::Erase(cg::SizeType i)
+{
+    Erase(i, 1);
+}
+/**Erase a unit from the storage.
+\param i The index to erase.
+\param s The amount to erase in elements.
+\throw ArrayException::IndexOutOfBounds if the run is not all elements.*/
+template<typename DataType>
+void MappedArray<DataType>::Erase(cg::SizeType i, cg::SizeType s)
+{
+    cg::SizeType size = Size();
+    if (i + s > size || i + s < i)
+        throw ArrayException::IndexOutOfBounds;
+    std::memmove(Addr(i), Addr(i + s), (size - (i + s)) * sizeof(DataType));
+    Head()->m_count = size - s;
+}
+/**Pop off the last element.*/
+template<typename DataType>
+void MappedArray<DataType>::PopBack()
+{
+    PopBack(1);
+}
+/**Pop off the last element.
+\param amt The amount to pop at the end.
+\throw ArrayException::ListEmpty if there are less than \p amt elements.*/
+template<typename DataType>
+void MappedArray<DataType>::PopBack(cg::SizeType amt)
+{
+    if (amt > Size())
+        throw ArrayException::ListEmpty;
+    Head()->m_count -= amt;
+}
+/**Remove every element.  The file keeps its size.*/
+template<typename DataType>
+void MappedArray<DataType>::Clear()
+{
+    Head()->m_count = 0;
+}
+/**Ensure that the array can hold \p amt of units.
+\param amt The amount to reserve.
+\return True, since the file can always grow.
+\throw cg::FileSystemException if the file could not be grown.*/
+template<typename DataType>
+bool MappedArray<DataType>::Reserve(cg::SizeType amt)
+{
+    ExpandTo(amt);
+    return true;
+}
+/**Shrink the file so that it only has room for the elements it has.
+\throw cg::FileSystemException if the file could not be resized.*/
+template<typename DataType>
+void MappedArray<DataType>::ShrinkToFit()
+{
+    if (m_cap == Size())
+        return;
+    m_file.Resize(HeaderSize + Size() * sizeof(DataType));
+    m_cap = Size();
+}
+/**Write the changed elements back to the file.
+\param async True to only start the writes and return right away.
+\throw cg::FileSystemException if the writes could not be done.*/
+template<typename DataType>
+void MappedArray<DataType>::Flush(bool async)
+{
+    m_file.Sync(async);
+}
+/**Set how fast the file grows when it fills up.
+\param factor The capacity is multiplied by this. Must be more than 1.
+\throw ArrayException::InvalidParameter if \p factor is not more than 1.*/
+template<typename DataType>
+void MappedArray<DataType>::GrowthFactor(float factor)
+{
+    if (!(factor > 1.0f))
+        throw ArrayException::InvalidParameter;
+    m_growth = factor;
+}
+/**Get how fast the file grows when it fills up.
+\return The factor the capacity is multiplied by.*/
+template<typename DataType>
+float MappedArray<DataType>::GrowthFactor() const
+{
+    return m_growth;
+}
+/**Get the path of the file.
+\return The path.*/
+template<typename DataType>
+const std::string& MappedArray<DataType>::Path() const
+{
+    return m_file.Path();
+}
+///////////////////////////////////////////////////////////////////////////
+/**Get the header at the start of the file.
+\return The header.*/
+template<typename DataType>
+typename MappedArray<DataType>::Header* MappedArray<DataType>::Head()
+{
+    return reinterpret_cast<Header*>(m_file.Data());
+}
+/**Get the header at the start of the file.
+\return The header.*/
+template<typename DataType>
+const typename MappedArray<DataType>::Header*
+MappedArray<DataType>::Head() const
+{
+    return reinterpret_cast<const Header*>(m_file.Data());
+}
+/**Get the address of the data.  Only good until the file is resized.
+\param i the offset.
+\return The address of the data.*/
+template<typename DataType>
+DataType* MappedArray<DataType>::Addr(cg::SizeType i)
+{
+    return reinterpret_cast<DataType*>(m_file.Data() + HeaderSize) + i;
+}
+/**Get the address of the data.  Only good until the file is resized.
+\param i the offset.
+\return The address of the data.*/
+template<typename DataType>
+const DataType* MappedArray<DataType>::Addr(cg::SizeType i) const
+{
+    return reinterpret_cast<const DataType*>(m_file.Data() + HeaderSize) + i;
+}
+/**Grow the file to hold X amount of elements.  The elements stay where they
+are in the file, so nothing is copied, but the view may move.
+\param amt The amount to hold. If m_cap is >=, nothing happens.
+\throw cg::FileSystemException if the file could not be grown.*/
+template<typename DataType>
+void MappedArray<DataType>::ExpandTo(cg::SizeType amt)
+{
+    if (m_cap >= amt)
+        return;
+    m_file.Resize(HeaderSize + amt * sizeof(DataType));
+    m_cap = amt;
+}
+/**Get the capacity to grow to.  The capacity is multiplied so that n pushes
+resize the file O(log n) times.
+\param amt The least amount that has to fit.
+\return The new capacity.*/
+template<typename DataType>
+cg::SizeType MappedArray<DataType>::Grown(cg::SizeType amt) const
+{
+    cg::SizeType cap = (cg::SizeType)(m_cap * m_growth);
+    if (cap < m_cap + ExpandAmount)
+        cap = m_cap + ExpandAmount;
+    return cap < amt ? amt : cap;
+}
+
+template class MappedArray<int>;
+
+}
@@ -0,0 +1,186 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "Array.hpp"
+#include "../../../FileSystem.hpp"
+
+namespace cg {
+
+/**Mapped array exceptions*/
+enum class MappedArrayException {
+    /**The file is not a mapped array, or holds a different type.*/
+    BadFile,
+};
+
+/**An array that lives in a file mapped into memory.
+
+The elements are the bytes of the file, so nothing is read or written when
+the array is opened or closed: a reopen just maps the file and checks its
+header, and the pages are read in by the OS as they are touched.  Growing
+resizes the file and the view, which may move the view, so pointers,
+references and iterators are not good after anything that adds elements.
+
+Only types that can be copied with memcpy can be kept, since the bytes are
+all that is stored.  Changes reach the disk when the OS gets to them, or on
+Flush.
+\tparam DataType The type of data.*/
+template<typename DataType>
+class MappedArray
+{
+public:
+    static_assert(std::is_trivially_copyable<DataType>::value,
+        "A mapped array can only hold trivially copyable types.");
+    static_assert(alignof(DataType) <= 64,
+        "A mapped array can not align its elements past 64 bytes.");
+    /**The type of this object.*/
+    using SelfType = MappedArray<DataType>;
+    /**A reverse moving iterator type*/
+    using ReverseIterator = ArrayIterator<DataType, false, true>;
+    /**The standard forward iterator*/
+    using Iterator = ArrayIterator<DataType, false, false>;
+    /**A const reverse moving iterator*/
+    using ConstReverseIterator = ArrayIterator<DataType, true, true>;
+    /**A forward moving const iterator*/
+    using ConstIterator = ArrayIterator<DataType, true, false>;
+    /**The least amount to expand by when re allocating.*/
+    const static cg::SizeType ExpandAmount = 8;
+    /**The bytes before the first element.*/
+    const static cg::SizeType HeaderSize = 64;
+    /**The first 8 bytes of every mapped array file.*/
+    const static uint64_t Magic = 0x5952524150414d43ull;
+
+    MappedArray(const std::string& path, cg::SizeType initCap = 0);
+
+    MappedArray(const SelfType&) = delete;
+
+    void operator=(const SelfType&) = delete;
+
+    cg::SizeType Size() const;
+
+    cg::SizeType Capacity() const;
+
+    bool Empty() const;
+
+    template<typename...Ts>
+    void EmplaceBack(Ts&&... o);
+
+    void PushBack(const DataType& o);
+
+    void Append(const DataType* arr, cg::SizeType amt);
+
+    void Insert(cg::SizeType i, const DataType& o);
+
+    DataType& Get(cg::SizeType i);
+
+    const DataType& Get(cg::SizeType i) const;
+
+    DataType& operator[](cg::SizeType i);
+
+    const DataType& operator[](cg::SizeType i) const;
+
+    const DataType& Back() const;
+
+    DataType& Back();
+
+    const DataType& Front() const;
+
+    DataType& Front();
+
+    Iterator Begin();
+
+    ConstIterator Begin() const;
+
+    ReverseIterator RBegin();
+
+    ConstReverseIterator RBegin() const;
+
+    Iterator End();
+
+    ConstIterator End() const;
+
+    ReverseIterator REnd();
+
+    ConstReverseIterator REnd() const;
+
+    void Erase(cg::SizeType i);
+
+    void Erase(cg::SizeType i, cg::SizeType s);
+
+    void PopBack();
+
+    void PopBack(cg::SizeType amt);
+
+    void Clear();
+
+    bool Reserve(cg::SizeType amt);
+
+    void ShrinkToFit();
+
+    void Flush(bool async = false);
+
+    void GrowthFactor(float factor);
+
+    float GrowthFactor() const;
+
+    const std::string& Path() const;
+private:
+    /**The start of the file.  Only m_count changes after the file is made.*/
+    struct Header
+    {
+        /**Always Magic.*/
+        uint64_t m_magic;
+        /**sizeof(DataType) when the file was made.*/
+        uint64_t m_typeSize;
+        /**The amount of elements in use.*/
+        uint64_t m_count;
+        /**Room to add things later, and to put the elements at 64.*/
+        uint64_t m_reserved[5];
+    };
+    static_assert(sizeof(Header) == HeaderSize, "The header must be 64 bytes.");
+
+    Header* Head();
+
+    const Header* Head() const;
+
+    DataType* Addr(cg::SizeType i = 0);
+
+    const DataType* Addr(cg::SizeType i = 0) const;
+
+    void ExpandTo(cg::SizeType amt);
+
+    cg::SizeType Grown(cg::SizeType amt) const;
+
+    /**The file the elements live in.*/
+    cg::MappedFile m_file;
+    /**The amount of elements the file has room for.*/
+    cg::SizeType m_cap;
+    /**The capacity is multiplied by this when the file fills up.*/
+    float m_growth = 2.0f;
+};
+
+}
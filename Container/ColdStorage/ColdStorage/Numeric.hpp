@@ -0,0 +1,489 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+#include "NumericDef.hpp"
+
+namespace cg {
+
+/**Sort a range of integers or floats with a stable LSD radix sort.
+\param first The first element.
+\param last One past the last element.
+\throw ArrayException::OutOfMemory if the buffer could not be had.*/
+template<typename DataType>
+void RadixSort(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last)
+{
+    RadixSort(first, last, [](const DataType& x) { return x; });
+}
+/**Sort a range by a key with a stable LSD radix sort.
+
+The keys are turned into unsigned integers that sort the same way, and the
+elements are moved between the range and a buffer once for each byte of key,
+lowest byte first, so the order is linear in the size of the range.  The
+bytes are counted for every pass up front, and a pass is skipped when all the
+keys have the same byte there, so small keys in a wide type cost only the
+passes they use.  Short ranges go to Sort instead.
+\param first The first element.
+\param last One past the last element.
+\param key The functor that gets the key of an element.  The key must be an
+integer or float.  It is called once per element for each pass, so it should
+be cheap, and it must not throw.
+\throw ArrayException::OutOfMemory if the buffer could not be had.*/
+template<typename DataType, typename KeyFunc>
+void RadixSort(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last, KeyFunc key)
+{
+    using KeyType = typename std::decay<decltype(key(*first))>::type;
+    using Bits = typename impl::RadixKey<KeyType>::Type;
+    const SizeType digits = sizeof(Bits);
+    impl::RadixKey<KeyType> radix;
+    SizeType n = (SizeType)(last - first);
+    if (n < RadixMinimum)
+    {
+        Sort(first, last, [&](const DataType& a, const DataType& b) {
+            return radix(key(a)) < radix(key(b));
+        });
+        return;
+    }
+    DataType* a = first.Addr();
+    SizeType counts[digits][256] = {};
+    for (SizeType i = 0; i < n; ++i)
+    {
+        Bits bits = radix(key(a[i]));
+        for (SizeType d = 0; d < digits; ++d)
+            ++counts[d][(bits >> (d * 8)) & 0xFF];
+    }
+    DataType* buf = (DataType*)std::malloc(n * sizeof(DataType));
+    if (!buf)
+        throw ArrayException::OutOfMemory;
+    Bits some = radix(key(a[0]));
+    DataType* from = a;
+    DataType* to = buf;
+    for (SizeType d = 0; d < digits; ++d)
+    {
+        SizeType* count = counts[d];
+        if (count[(some >> (d * 8)) & 0xFF] == n)
+            continue;
+        SizeType start = 0;
+        for (SizeType b = 0; b < 256; ++b)
+        {
+            SizeType amt = count[b];
+            count[b] = start;
+            start += amt;
+        }
+        for (SizeType i = 0; i < n; ++i)
+        {
+            SizeType at = count[(radix(key(from[i])) >> (d * 8)) & 0xFF]++;
+            new (to + at) DataType(Move(from[i]));
+            from[i].~DataType();
+        }
+        DataType* t = from;
+        from = to;
+        to = t;
+    }
+    if (from != a)
+    {
+        for (SizeType i = 0; i < n; ++i)
+        {
+            new (a + i) DataType(Move(from[i]));
+            from[i].~DataType();
+        }
+    }
+    std::free(buf);
+}
+/**Find the first element equal to a value.  Integers and floats are checked
+a vector at a time, with the widest vectors the cpu has.
+\param first The first element.
+\param last One past the last element.
+\param value The value to look for.
+\return The element, or \p last if there is none.*/
+template<typename DataType, bool Const>
+ArrayIterator<DataType, Const, false> Find(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value)
+{
+    SizeType n = (SizeType)(last - first);
+    if (!n)
+        return last;
+    const DataType* a = first.Addr();
+    return first + (SizeType)(impl::FindIn(a, a + n, value,
+        impl::SimdCapable<DataType>()) - a);
+}
+/**Count the elements equal to a value.  Integers and floats are checked a
+vector at a time, with the widest vectors the cpu has.
+\param first The first element.
+\param last One past the last element.
+\param value The value to look for.
+\return The amount of elements equal to \p value.*/
+template<typename DataType, bool Const>
+SizeType Count(ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value)
+{
+    SizeType n = (SizeType)(last - first);
+    if (!n)
+        return 0;
+    const DataType* a = first.Addr();
+    return impl::CountIn(a, a + n, value, impl::SimdCapable<DataType>());
+}
+/**Find the first smallest element.  For integers and floats the smallest
+value is found a vector at a time, and then the first element equal to it.  If
+there is a NaN in the range, which element is picked is not specified.
+\param first The first element.
+\param last One past the last element.
+\return The element, or \p last if the range is empty.*/
+template<typename DataType, bool Const>
+ArrayIterator<DataType, Const, false> MinElement(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last)
+{
+    SizeType n = (SizeType)(last - first);
+    if (!n)
+        return last;
+    const DataType* a = first.Addr();
+    return first + (SizeType)(impl::ExtremeIn(a, n, SimdMin(),
+        impl::SimdCapable<DataType>()) - a);
+}
+/**Find the first largest element.  For integers and floats the largest value
+is found a vector at a time, and then the first element equal to it.  If there
+is a NaN in the range, which element is picked is not specified.
+\param first The first element.
+\param last One past the last element.
+\return The element, or \p last if the range is empty.*/
+template<typename DataType, bool Const>
+ArrayIterator<DataType, Const, false> MaxElement(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last)
+{
+    SizeType n = (SizeType)(last - first);
+    if (!n)
+        return last;
+    const DataType* a = first.Addr();
+    return first + (SizeType)(impl::ExtremeIn(a, n, SimdMax(),
+        impl::SimdCapable<DataType>()) - a);
+}
+/**Add up a range.  Integers and floats are added a vector at a time, with
+the widest vectors the cpu has.  Integers wrap around instead of overflowing.
+Floats are added in a different order than one at a time, so the last bits of
+the sum may not match a plain loop.
+\param first The first element.
+\param last One past the last element.
+\return The sum, or DataType() if the range is empty.*/
+template<typename DataType, bool Const>
+DataType Sum(ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last)
+{
+    SizeType n = (SizeType)(last - first);
+    if (!n)
+        return DataType();
+    return impl::FoldIn((const DataType*)first.Addr(), n, SimdAdd(),
+        impl::SimdCapable<DataType>());
+}
+
+namespace impl {
+
+/**Determine if \p a is picked over \p b for a min.*/
+template<typename T>
+bool Precedes(const T& a, const T& b, SimdMin)
+{
+    return a < b;
+}
+/**Determine if \p a is picked over \p b for a max.*/
+template<typename T>
+bool Precedes(const T& a, const T& b, SimdMax)
+{
+    return b < a;
+}
+/**Fold two values with a min or max.
+\return \p b if it is picked over \p a, otherwise \p a.*/
+template<typename T, typename Op>
+T ScalarApply(const T& a, const T& b, Op op)
+{
+    return Precedes(b, a, op) ? b : a;
+}
+/**Add two values.  Integers are added unsigned so they wrap.*/
+template<typename T>
+T ScalarApply(const T& a, const T& b, SimdAdd)
+{
+    using Wide = typename SumType<T>::Type;
+    return (T)((Wide)a + (Wide)b);
+}
+/**Fold a range one element at a time.
+\param a The range.
+\param n The amount of elements.  Must be at least 1.
+\param op SimdMin, SimdMax or SimdAdd.
+\return The folded value.*/
+template<typename T, typename Op>
+T ScalarFold(const T* a, SizeType n, Op op)
+{
+    T r = a[0];
+    for (SizeType i = 1; i < n; ++i)
+        r = ScalarApply(r, a[i], op);
+    return r;
+}
+/**Find the first element equal to a value, one element at a time.*/
+template<typename T>
+const T* FindIn(const T* a, const T* end, const T& value, std::false_type)
+{
+    for (; a != end; ++a)
+        if (*a == value)
+            break;
+    return a;
+}
+/**Find the first element equal to a value, with the widest vectors the cpu
+has.*/
+template<typename T>
+const T* FindIn(const T* a, const T* end, const T& value, std::true_type)
+{
+#ifdef CG_SIMD_AVX2
+    if (SimdSupported() == SimdLevel::Avx2)
+        return Avx2Find<Avx2Ops<T>>(a, end, value);
+#endif
+#ifdef CG_SIMD_SSE2
+    return Sse2Find<Sse2Ops<T>>(a, end, value);
+#else
+    return FindIn(a, end, value, std::false_type());
+#endif
+}
+/**Count the elements equal to a value, one element at a time.*/
+template<typename T>
+SizeType CountIn(const T* a, const T* end, const T& value, std::false_type)
+{
+    SizeType count = 0;
+    for (; a != end; ++a)
+        if (*a == value)
+            ++count;
+    return count;
+}
+/**Count the elements equal to a value, with the widest vectors the cpu
+has.*/
+template<typename T>
+SizeType CountIn(const T* a, const T* end, const T& value, std::true_type)
+{
+#ifdef CG_SIMD_AVX2
+    if (SimdSupported() == SimdLevel::Avx2)
+        return Avx2Count<Avx2Ops<T>>(a, end, value);
+#endif
+#ifdef CG_SIMD_SSE2
+    return Sse2Count<Sse2Ops<T>>(a, end, value);
+#else
+    return CountIn(a, end, value, std::false_type());
+#endif
+}
+/**Fold a range that has no vector ops.*/
+template<typename T, typename Op>
+T FoldIn(const T* a, SizeType n, Op op, std::false_type)
+{
+    return ScalarFold(a, n, op);
+}
+/**Fold a range with the widest vectors the cpu has.  The ops that the
+vectors can not do are done one element at a time.*/
+template<typename T, typename Op>
+T FoldIn(const T* a, SizeType n, Op op, std::true_type)
+{
+#ifdef CG_SIMD_AVX2
+    if (SimdSupported() == SimdLevel::Avx2)
+        return Avx2Fold<Avx2Ops<T>>(a, n, op, SimdHas<Avx2Ops<T>, Op>());
+#endif
+#ifdef CG_SIMD_SSE2
+    return Sse2Fold<Sse2Ops<T>>(a, n, op, SimdHas<Sse2Ops<T>, Op>());
+#else
+    return ScalarFold(a, n, op);
+#endif
+}
+/**Find the first smallest or largest element, one element at a time.
+\param a The range.
+\param n The amount of elements.  Must be at least 1.
+\param op SimdMin or SimdMax.
+\return The element.*/
+template<typename T, typename Op>
+const T* ExtremeIn(const T* a, SizeType n, Op op, std::false_type)
+{
+    const T* best = a;
+    for (SizeType i = 1; i < n; ++i)
+        if (Precedes(a[i], *best, op))
+            best = a + i;
+    return best;
+}
+/**Find the first smallest or largest element with vectors.  The value is
+folded first and then found, which is two fast passes instead of one slow
+one.*/
+template<typename T, typename Op>
+const T* ExtremeIn(const T* a, SizeType n, Op op, std::true_type)
+{
+    T best = FoldIn(a, n, op, std::true_type());
+    const T* at = FindIn(a, a + n, best, std::true_type());
+    /*a NaN can make the fold give a value that is not in the range.*/
+    return at != a + n ? at : ExtremeIn(a, n, op, std::false_type());
+}
+
+#ifdef CG_SIMD_SSE2
+
+/**Find the first element equal to a value, 16 bytes at a time.
+\tparam Ops The Sse2Ops of the elements.
+\param a The first element.
+\param end One past the last element.
+\param value The value to look for.
+\return The element, or \p end if there is none.*/
+template<typename Ops, typename T>
+const T* Sse2Find(const T* a, const T* end, T value)
+{
+    const SizeType lanes = Ops::Lanes;
+    typename Ops::Reg key = Ops::Splat(value);
+    for (; (SizeType)(end - a) >= lanes; a += lanes)
+    {
+        uint32_t hits = Ops::Eq(Ops::Load(a), key);
+        if (hits)
+            return a + SimdLowestBit(hits) / sizeof(T);
+    }
+    return FindIn(a, end, value, std::false_type());
+}
+/**Count the elements equal to a value, 16 bytes at a time.
+\tparam Ops The Sse2Ops of the elements.
+\param a The first element.
+\param end One past the last element.
+\param value The value to look for.
+\return The amount of elements equal to \p value.*/
+template<typename Ops, typename T>
+SizeType Sse2Count(const T* a, const T* end, T value)
+{
+    const SizeType lanes = Ops::Lanes;
+    typename Ops::Reg key = Ops::Splat(value);
+    SizeType bits = 0;
+    for (; (SizeType)(end - a) >= lanes; a += lanes)
+        bits += SimdBitCount(Ops::Eq(Ops::Load(a), key));
+    /*each match sets one bit per byte of the lane.*/
+    return bits / sizeof(T) + CountIn(a, end, value, std::false_type());
+}
+/**Fold a range 16 bytes at a time.  Two vectors are folded at once, so one
+op does not have to wait on the last.
+\tparam Ops The Sse2Ops of the elements.
+\param a The range.
+\param n The amount of elements.  Must be at least 1.
+\param op SimdMin, SimdMax or SimdAdd.
+\return The folded value.*/
+template<typename Ops, typename T, typename Op>
+T Sse2Fold(const T* a, SizeType n, Op op, std::true_type)
+{
+    const SizeType lanes = Ops::Lanes;
+    if (n < 2 * lanes)
+        return ScalarFold(a, n, op);
+    typename Ops::Reg acc0 = Ops::Load(a);
+    typename Ops::Reg acc1 = Ops::Load(a + lanes);
+    SizeType i = 2 * lanes;
+    for (; i + 2 * lanes <= n; i += 2 * lanes)
+    {
+        acc0 = Ops::Apply(acc0, Ops::Load(a + i), op);
+        acc1 = Ops::Apply(acc1, Ops::Load(a + i + lanes), op);
+    }
+    T part[lanes];
+    Ops::Store(part, Ops::Apply(acc0, acc1, op));
+    T r = ScalarFold(part, lanes, op);
+    for (; i < n; ++i)
+        r = ScalarApply(r, a[i], op);
+    return r;
+}
+/**Fold a range that the 16 byte ops can not fold.*/
+template<typename Ops, typename T, typename Op>
+T Sse2Fold(const T* a, SizeType n, Op op, std::false_type)
+{
+    return ScalarFold(a, n, op);
+}
+
+#endif
+
+#ifdef CG_SIMD_AVX2
+
+/**Find the first element equal to a value, 32 bytes at a time.
+\tparam Ops The Avx2Ops of the elements.
+\param a The first element.
+\param end One past the last element.
+\param value The value to look for.
+\return The element, or \p end if there is none.*/
+template<typename Ops, typename T>
+CG_SIMD_AVX2_TARGET const T* Avx2Find(const T* a, const T* end, T value)
+{
+    const SizeType lanes = Ops::Lanes;
+    typename Ops::Reg key = Ops::Splat(value);
+    for (; (SizeType)(end - a) >= lanes; a += lanes)
+    {
+        uint32_t hits = Ops::Eq(Ops::Load(a), key);
+        if (hits)
+            return a + SimdLowestBit(hits) / sizeof(T);
+    }
+    return FindIn(a, end, value, std::false_type());
+}
+/**Count the elements equal to a value, 32 bytes at a time.
+\tparam Ops The Avx2Ops of the elements.
+\param a The first element.
+\param end One past the last element.
+\param value The value to look for.
+\return The amount of elements equal to \p value.*/
+template<typename Ops, typename T>
+CG_SIMD_AVX2_TARGET SizeType Avx2Count(const T* a, const T* end, T value)
+{
+    const SizeType lanes = Ops::Lanes;
+    typename Ops::Reg key = Ops::Splat(value);
+    SizeType bits = 0;
+    for (; (SizeType)(end - a) >= lanes; a += lanes)
+        bits += SimdBitCount(Ops::Eq(Ops::Load(a), key));
+    return bits / sizeof(T) + CountIn(a, end, value, std::false_type());
+}
+/**Fold a range 32 bytes at a time, like Sse2Fold.
+\tparam Ops The Avx2Ops of the elements.
+\param a The range.
+\param n The amount of elements.  Must be at least 1.
+\param op SimdMin, SimdMax or SimdAdd.
+\return The folded value.*/
+template<typename Ops, typename T, typename Op>
+CG_SIMD_AVX2_TARGET T Avx2Fold(const T* a, SizeType n, Op op,
+    std::true_type)
+{
+    const SizeType lanes = Ops::Lanes;
+    if (n < 2 * lanes)
+        return ScalarFold(a, n, op);
+    typename Ops::Reg acc0 = Ops::Load(a);
+    typename Ops::Reg acc1 = Ops::Load(a + lanes);
+    SizeType i = 2 * lanes;
+    for (; i + 2 * lanes <= n; i += 2 * lanes)
+    {
+        acc0 = Ops::Apply(acc0, Ops::Load(a + i), op);
+        acc1 = Ops::Apply(acc1, Ops::Load(a + i + lanes), op);
+    }
+    T part[lanes];
+    Ops::Store(part, Ops::Apply(acc0, acc1, op));
+    T r = ScalarFold(part, lanes, op);
+    for (; i < n; ++i)
+        r = ScalarApply(r, a[i], op);
+    return r;
+}
+/**Fold a range that the 32 byte ops can not fold.*/
+template<typename Ops, typename T, typename Op>
+T Avx2Fold(const T* a, SizeType n, Op op, std::false_type)
+{
+    return ScalarFold(a, n, op);
+}
+
+#endif
+
+}
+
+}
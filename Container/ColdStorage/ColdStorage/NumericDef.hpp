@@ -0,0 +1,210 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "Algorithm.hpp"
+#include "SimdOps.hpp"
+
+namespace cg {
+
+/**The shortest range RadixSort does not hand to Sort.  Below this the
+histograms cost more than the compares they save.*/
+const SizeType RadixMinimum = 64;
+
+template<typename DataType>
+void RadixSort(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last);
+
+template<typename DataType, typename KeyFunc>
+void RadixSort(ArrayIterator<DataType, false, false> first,
+    ArrayIterator<DataType, false, false> last, KeyFunc key);
+
+template<typename DataType, bool Const>
+ArrayIterator<DataType, Const, false> Find(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value);
+
+template<typename DataType, bool Const>
+SizeType Count(ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last, const DataType& value);
+
+template<typename DataType, bool Const>
+ArrayIterator<DataType, Const, false> MinElement(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last);
+
+template<typename DataType, bool Const>
+ArrayIterator<DataType, Const, false> MaxElement(
+    ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last);
+
+template<typename DataType, bool Const>
+DataType Sum(ArrayIterator<DataType, Const, false> first,
+    ArrayIterator<DataType, Const, false> last);
+
+namespace impl {
+
+/**Turn a fundamental key into an unsigned integer that sorts the same way.
+\tparam T The type of key.*/
+template<typename T, bool Float = std::is_floating_point<T>::value>
+struct RadixKey
+{
+    static_assert(std::is_integral<T>::value,
+        "Radix keys must be integers or floats.");
+    /**The unsigned integer.*/
+    using Type = typename std::make_unsigned<
+        ConditionalType<std::is_same<T, bool>::value, unsigned char, T>>::type;
+    /**Get the unsigned integer for a key.  Signed keys have the sign bit
+    flipped so the negative ones come first.*/
+    Type operator()(T key) const
+    {
+        const Type sign = std::is_signed<T>::value ?
+            (Type)((Type)1 << (sizeof(Type) * 8 - 1)) : 0;
+        return (Type)((Type)key ^ sign);
+    }
+};
+
+/**Floats are turned into unsigned integers by their bits.  Negative floats
+have every bit flipped, since a bigger magnitude is a smaller number, and the
+rest have only the sign bit flipped.  NaNs sort by their bits.*/
+template<typename T>
+struct RadixKey<T, true>
+{
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8,
+        "Radix keys must be 4 or 8 byte floats.");
+    /**The unsigned integer.*/
+    using Type = ConditionalType<sizeof(T) == 4, uint32_t, uint64_t>;
+    /**Get the unsigned integer for a key.*/
+    Type operator()(T key) const
+    {
+        const Type sign = (Type)1 << (sizeof(Type) * 8 - 1);
+        Type bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        return (bits & sign) ? (Type)~bits : (Type)(bits | sign);
+    }
+};
+
+/**True if a type has vector ops.*/
+template<typename T>
+using SimdCapable = std::integral_constant<bool,
+    (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+    std::is_same<T, float>::value || std::is_same<T, double>::value>;
+
+/**True if a vector op can be used with a set of ops.*/
+template<typename Ops, typename Op>
+using SimdHas = std::integral_constant<bool,
+    Ops::Order || std::is_same<Op, SimdAdd>::value>;
+
+/**The type to add in, so signed integers wrap instead of overflowing.*/
+template<typename T, bool Int = std::is_integral<T>::value &&
+    !std::is_same<T, bool>::value>
+struct SumType
+{
+    using Type = T;
+};
+
+template<typename T>
+struct SumType<T, true>
+{
+    using Type = typename std::make_unsigned<T>::type;
+};
+
+template<typename T>
+bool Precedes(const T& a, const T& b, SimdMin);
+
+template<typename T>
+bool Precedes(const T& a, const T& b, SimdMax);
+
+template<typename T, typename Op>
+T ScalarApply(const T& a, const T& b, Op op);
+
+template<typename T>
+T ScalarApply(const T& a, const T& b, SimdAdd);
+
+template<typename T, typename Op>
+T ScalarFold(const T* a, SizeType n, Op op);
+
+template<typename T>
+const T* FindIn(const T* a, const T* end, const T& value, std::false_type);
+
+template<typename T>
+const T* FindIn(const T* a, const T* end, const T& value, std::true_type);
+
+template<typename T>
+SizeType CountIn(const T* a, const T* end, const T& value, std::false_type);
+
+template<typename T>
+SizeType CountIn(const T* a, const T* end, const T& value, std::true_type);
+
+template<typename T, typename Op>
+T FoldIn(const T* a, SizeType n, Op op, std::false_type);
+
+template<typename T, typename Op>
+T FoldIn(const T* a, SizeType n, Op op, std::true_type);
+
+template<typename T, typename Op>
+const T* ExtremeIn(const T* a, SizeType n, Op op, std::false_type);
+
+template<typename T, typename Op>
+const T* ExtremeIn(const T* a, SizeType n, Op op, std::true_type);
+
+#ifdef CG_SIMD_SSE2
+
+template<typename Ops, typename T>
+const T* Sse2Find(const T* a, const T* end, T value);
+
+template<typename Ops, typename T>
+SizeType Sse2Count(const T* a, const T* end, T value);
+
+template<typename Ops, typename T, typename Op>
+T Sse2Fold(const T* a, SizeType n, Op op, std::true_type);
+
+template<typename Ops, typename T, typename Op>
+T Sse2Fold(const T* a, SizeType n, Op op, std::false_type);
+
+#endif
+
+#ifdef CG_SIMD_AVX2
+
+template<typename Ops, typename T>
+CG_SIMD_AVX2_TARGET const T* Avx2Find(const T* a, const T* end, T value);
+
+template<typename Ops, typename T>
+CG_SIMD_AVX2_TARGET SizeType Avx2Count(const T* a, const T* end, T value);
+
+template<typename Ops, typename T, typename Op>
+CG_SIMD_AVX2_TARGET T Avx2Fold(const T* a, SizeType n, Op op,
+    std::true_type);
+
+template<typename Ops, typename T, typename Op>
+T Avx2Fold(const T* a, SizeType n, Op op, std::false_type);
+
+#endif
+
+}
+
+}
@@ -0,0 +1,614 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CG_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+/*the AVX2 ops are built into every x86 build and only used when the cpu has
+them, so no compiler flag is needed.*/
+#define CG_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(CG_SIMD_AVX2) && defined(__GNUC__)
+#define CG_SIMD_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define CG_SIMD_AVX2_TARGET
+#endif
+
+#include "cgdef.hpp"
+
+namespace cg {
+
+/**The widest set of vector instructions that can be used.*/
+enum class SimdLevel
+{
+    /**No vector instructions.*/
+    Scalar,
+    /**16 byte vectors.*/
+    Sse2,
+    /**32 byte vectors.*/
+    Avx2,
+};
+
+/**Ask the cpu which vector instructions it has.  AVX2 also needs the OS to
+save the wide registers, which is checked too.
+\return The widest level that can be used.*/
+inline SimdLevel SimdDetect()
+{
+#if defined(CG_SIMD_AVX2) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return SimdLevel::Sse2;
+    __cpuid(info, 1);
+    bool osSaves = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osSaves || !avx || (_xgetbv(0) & 6) != 6)
+        return SimdLevel::Sse2;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#elif defined(CG_SIMD_AVX2)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#elif defined(CG_SIMD_SSE2)
+    return SimdLevel::Sse2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+/**Get the widest vector instructions that can be used.  The cpu is only
+asked once.
+\return The level.*/
+inline SimdLevel SimdSupported()
+{
+    static const SimdLevel level = SimdDetect();
+    return level;
+}
+
+/**Get the index of the lowest set bit.
+\pre \p bits must not be 0.
+\param bits The bits to look at.
+\return The index of the lowest set bit.*/
+inline SizeType SimdLowestBit(uint32_t bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return (SizeType)index;
+#else
+    return (SizeType)__builtin_ctz(bits);
+#endif
+}
+
+/**Count the set bits.  It does not need the popcnt instruction, which SSE2
+cpus may not have.
+\param bits The bits to count.
+\return The amount of set bits.*/
+inline SizeType SimdBitCount(uint32_t bits)
+{
+    bits = bits - ((bits >> 1) & 0x55555555u);
+    bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+    bits = (bits + (bits >> 4)) & 0x0F0F0F0Fu;
+    return (SizeType)((bits * 0x01010101u) >> 24);
+}
+
+/**Pick the smaller lanes in SimdOps::Apply.*/
+struct SimdMin {};
+/**Pick the larger lanes in SimdOps::Apply.*/
+struct SimdMax {};
+/**Add the lanes in SimdOps::Apply.  Integers wrap around.*/
+struct SimdAdd {};
+
+#ifdef CG_SIMD_SSE2
+
+/**The parts of the 16 byte integer ops that do not care about lane size.*/
+struct Sse2IntCommon
+{
+    /**A vector.*/
+    using Reg = __m128i;
+    /**Load a vector from memory with any alignment.*/
+    static Reg Load(const void* p)
+    {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+    /**Store a vector to memory with any alignment.*/
+    static void Store(void* p, Reg a)
+    {
+        _mm_storeu_si128((__m128i*)p, a);
+    }
+    /**Take the lanes of \p a where \p mask is set and \p b elsewhere.*/
+    static Reg Select(Reg mask, Reg a, Reg b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+};
+
+/**Ops on 16 byte vectors of integers.
+
+Every op has the same form for each lane size: Splat fills the lanes with a
+value, Eq gives one bit per byte of the lanes that match, and Apply folds two
+vectors with SimdMin, SimdMax or SimdAdd.  Order is false when the lanes can
+not be compared, and then Apply only takes SimdAdd.  SSE2 only compares
+signed lanes, so unsigned lanes have their sign bits flipped first.
+\tparam Size The size of a lane in bytes.
+\tparam Signed True if the lanes are signed.*/
+template<SizeType Size, bool Signed>
+struct Sse2Int;
+
+template<bool Signed>
+struct Sse2Int<1, Signed> : Sse2IntCommon
+{
+    static const SizeType Lanes = 16;
+    static const bool Order = true;
+    template<typename T>
+    static Reg Splat(T v)
+    {
+        return _mm_set1_epi8((char)v);
+    }
+    static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+    }
+    static Reg Gt(Reg a, Reg b)
+    {
+        Reg bias = _mm_set1_epi8(Signed ? 0 : (char)0x80);
+        return _mm_cmpgt_epi8(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+    }
+    static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm_add_epi8(a, b);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return Select(Gt(a, b), b, a);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return Select(Gt(a, b), a, b);
+    }
+};
+
+template<bool Signed>
+struct Sse2Int<2, Signed> : Sse2IntCommon
+{
+    static const SizeType Lanes = 8;
+    static const bool Order = true;
+    template<typename T>
+    static Reg Splat(T v)
+    {
+        return _mm_set1_epi16((short)v);
+    }
+    static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(a, b));
+    }
+    static Reg Gt(Reg a, Reg b)
+    {
+        Reg bias = _mm_set1_epi16(Signed ? 0 : (short)0x8000);
+        return _mm_cmpgt_epi16(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+    }
+    static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm_add_epi16(a, b);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return Select(Gt(a, b), b, a);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return Select(Gt(a, b), a, b);
+    }
+};
+
+template<bool Signed>
+struct Sse2Int<4, Signed> : Sse2IntCommon
+{
+    static const SizeType Lanes = 4;
+    static const bool Order = true;
+    template<typename T>
+    static Reg Splat(T v)
+    {
+        return _mm_set1_epi32((int)v);
+    }
+    static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi32(a, b));
+    }
+    static Reg Gt(Reg a, Reg b)
+    {
+        Reg bias = _mm_set1_epi32(Signed ? 0 : INT32_MIN);
+        return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+    }
+    static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm_add_epi32(a, b);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return Select(Gt(a, b), b, a);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return Select(Gt(a, b), a, b);
+    }
+};
+
+/**SSE2 has no 64 bit compares, so these lanes can only be matched and
+added.*/
+template<bool Signed>
+struct Sse2Int<8, Signed> : Sse2IntCommon
+{
+    static const SizeType Lanes = 2;
+    static const bool Order = false;
+    template<typename T>
+    static Reg Splat(T v)
+    {
+        return _mm_set1_epi64x((long long)v);
+    }
+    static uint32_t Eq(Reg a, Reg b)
+    {
+        /*both halves of a lane have to match.*/
+        Reg half = _mm_cmpeq_epi32(a, b);
+        Reg swap = _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1));
+        return (uint32_t)_mm_movemask_epi8(_mm_and_si128(half, swap));
+    }
+    static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm_add_epi64(a, b);
+    }
+};
+
+/**Ops on 16 byte vectors of floats, in the same form as Sse2Int.  A NaN in
+either lane of a min or max gives the lane of the second vector.
+\tparam T float or double.*/
+template<typename T>
+struct Sse2Float;
+
+template<>
+struct Sse2Float<float>
+{
+    using Reg = __m128;
+    static const SizeType Lanes = 4;
+    static const bool Order = true;
+    static Reg Load(const void* p)
+    {
+        return _mm_loadu_ps((const float*)p);
+    }
+    static void Store(void* p, Reg a)
+    {
+        _mm_storeu_ps((float*)p, a);
+    }
+    static Reg Splat(float v)
+    {
+        return _mm_set1_ps(v);
+    }
+    static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm_movemask_epi8(
+            _mm_castps_si128(_mm_cmpeq_ps(a, b)));
+    }
+    static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm_add_ps(a, b);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return _mm_min_ps(a, b);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return _mm_max_ps(a, b);
+    }
+};
+
+template<>
+struct Sse2Float<double>
+{
+    using Reg = __m128d;
+    static const SizeType Lanes = 2;
+    static const bool Order = true;
+    static Reg Load(const void* p)
+    {
+        return _mm_loadu_pd((const double*)p);
+    }
+    static void Store(void* p, Reg a)
+    {
+        _mm_storeu_pd((double*)p, a);
+    }
+    static Reg Splat(double v)
+    {
+        return _mm_set1_pd(v);
+    }
+    static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm_movemask_epi8(
+            _mm_castpd_si128(_mm_cmpeq_pd(a, b)));
+    }
+    static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm_add_pd(a, b);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return _mm_min_pd(a, b);
+    }
+    static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return _mm_max_pd(a, b);
+    }
+};
+
+/**The 16 byte ops for a type of element.
+\tparam T An integer other than bool, float or double.*/
+template<typename T>
+using Sse2Ops = ConditionalType<std::is_floating_point<T>::value,
+    Sse2Float<T>, Sse2Int<sizeof(T), std::is_signed<T>::value>>;
+
+#endif
+
+#ifdef CG_SIMD_AVX2
+
+/**The parts of the 32 byte integer ops that do not care about lane size.*/
+struct Avx2IntCommon
+{
+    /**A vector.*/
+    using Reg = __m256i;
+    /**Load a vector from memory with any alignment.*/
+    CG_SIMD_AVX2_TARGET static Reg Load(const void* p)
+    {
+        return _mm256_loadu_si256((const __m256i*)p);
+    }
+    /**Store a vector to memory with any alignment.*/
+    CG_SIMD_AVX2_TARGET static void Store(void* p, Reg a)
+    {
+        _mm256_storeu_si256((__m256i*)p, a);
+    }
+};
+
+/**Ops on 32 byte vectors of integers, in the same form as Sse2Int.  Every
+lane size can be compared.
+\tparam Size The size of a lane in bytes.
+\tparam Signed True if the lanes are signed.*/
+template<SizeType Size, bool Signed>
+struct Avx2Int;
+
+template<bool Signed>
+struct Avx2Int<1, Signed> : Avx2IntCommon
+{
+    static const SizeType Lanes = 32;
+    static const bool Order = true;
+    template<typename T>
+    CG_SIMD_AVX2_TARGET static Reg Splat(T v)
+    {
+        return _mm256_set1_epi8((char)v);
+    }
+    CG_SIMD_AVX2_TARGET static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm256_add_epi8(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return Signed ? _mm256_min_epi8(a, b) : _mm256_min_epu8(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return Signed ? _mm256_max_epi8(a, b) : _mm256_max_epu8(a, b);
+    }
+};
+
+template<bool Signed>
+struct Avx2Int<2, Signed> : Avx2IntCommon
+{
+    static const SizeType Lanes = 16;
+    static const bool Order = true;
+    template<typename T>
+    CG_SIMD_AVX2_TARGET static Reg Splat(T v)
+    {
+        return _mm256_set1_epi16((short)v);
+    }
+    CG_SIMD_AVX2_TARGET static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b));
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm256_add_epi16(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return Signed ? _mm256_min_epi16(a, b) : _mm256_min_epu16(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return Signed ? _mm256_max_epi16(a, b) : _mm256_max_epu16(a, b);
+    }
+};
+
+template<bool Signed>
+struct Avx2Int<4, Signed> : Avx2IntCommon
+{
+    static const SizeType Lanes = 8;
+    static const bool Order = true;
+    template<typename T>
+    CG_SIMD_AVX2_TARGET static Reg Splat(T v)
+    {
+        return _mm256_set1_epi32((int)v);
+    }
+    CG_SIMD_AVX2_TARGET static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b));
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm256_add_epi32(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return Signed ? _mm256_min_epi32(a, b) : _mm256_min_epu32(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return Signed ? _mm256_max_epi32(a, b) : _mm256_max_epu32(a, b);
+    }
+};
+
+/**AVX2 has no 64 bit min or max, so they are made from a compare.*/
+template<bool Signed>
+struct Avx2Int<8, Signed> : Avx2IntCommon
+{
+    static const SizeType Lanes = 4;
+    static const bool Order = true;
+    template<typename T>
+    CG_SIMD_AVX2_TARGET static Reg Splat(T v)
+    {
+        return _mm256_set1_epi64x((long long)v);
+    }
+    CG_SIMD_AVX2_TARGET static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi64(a, b));
+    }
+    CG_SIMD_AVX2_TARGET static Reg Gt(Reg a, Reg b)
+    {
+        Reg bias = _mm256_set1_epi64x(Signed ? 0 : INT64_MIN);
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias),
+            _mm256_xor_si256(b, bias));
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm256_add_epi64(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return _mm256_blendv_epi8(a, b, Gt(a, b));
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return _mm256_blendv_epi8(b, a, Gt(a, b));
+    }
+};
+
+/**Ops on 32 byte vectors of floats, in the same form as Sse2Float.
+\tparam T float or double.*/
+template<typename T>
+struct Avx2Float;
+
+template<>
+struct Avx2Float<float>
+{
+    using Reg = __m256;
+    static const SizeType Lanes = 8;
+    static const bool Order = true;
+    CG_SIMD_AVX2_TARGET static Reg Load(const void* p)
+    {
+        return _mm256_loadu_ps((const float*)p);
+    }
+    CG_SIMD_AVX2_TARGET static void Store(void* p, Reg a)
+    {
+        _mm256_storeu_ps((float*)p, a);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Splat(float v)
+    {
+        return _mm256_set1_ps(v);
+    }
+    CG_SIMD_AVX2_TARGET static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm256_movemask_epi8(
+            _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)));
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm256_add_ps(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return _mm256_min_ps(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return _mm256_max_ps(a, b);
+    }
+};
+
+template<>
+struct Avx2Float<double>
+{
+    using Reg = __m256d;
+    static const SizeType Lanes = 4;
+    static const bool Order = true;
+    CG_SIMD_AVX2_TARGET static Reg Load(const void* p)
+    {
+        return _mm256_loadu_pd((const double*)p);
+    }
+    CG_SIMD_AVX2_TARGET static void Store(void* p, Reg a)
+    {
+        _mm256_storeu_pd((double*)p, a);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Splat(double v)
+    {
+        return _mm256_set1_pd(v);
+    }
+    CG_SIMD_AVX2_TARGET static uint32_t Eq(Reg a, Reg b)
+    {
+        return (uint32_t)_mm256_movemask_epi8(
+            _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)));
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdAdd)
+    {
+        return _mm256_add_pd(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMin)
+    {
+        return _mm256_min_pd(a, b);
+    }
+    CG_SIMD_AVX2_TARGET static Reg Apply(Reg a, Reg b, SimdMax)
+    {
+        return _mm256_max_pd(a, b);
+    }
+};
+
+/**The 32 byte ops for a type of element.
+\tparam T An integer other than bool, float or double.*/
+template<typename T>
+using Avx2Ops = ConditionalType<std::is_floating_point<T>::value,
+    Avx2Float<T>, Avx2Int<sizeof(T), std::is_signed<T>::value>>;
+
+#endif
+
+}
@@ -0,0 +1,293 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include "TieredArrayDef.hpp"
+
+namespace cg {
+
+/**Make an empty tiered array.
+\param path The backing file.  Anything in it is thrown away.
+\param budget The most bytes of blocks to keep in memory.  At least one block
+is always kept.
+\param blockBytes The size of a block.  It is rounded down to a whole amount
+of elements, and up to one element.
+\throw ArrayException::OutOfMemory if the frames could not be had.
+\throw TieredArrayException::IOError if the file could not be made.*/
+template<typename DataType>
+TieredArray<DataType>::TieredArray(const std::string& path,
+    cg::SizeType budget, cg::SizeType blockBytes)
+    :m_file(path)
+{
+    m_perBlock = blockBytes / sizeof(DataType);
+    if (m_perBlock == 0)
+        m_perBlock = 1;
+    m_blockBytes = m_perBlock * sizeof(DataType);
+    m_frameCount = budget / m_blockBytes;
+    if (m_frameCount == 0)
+        m_frameCount = 1;
+    m_file.Remove();
+    if (!m_file.Touch())
+        throw TieredArrayException::IOError;
+    m_data = (char*)std::malloc(m_frameCount * m_blockBytes);
+    if (!m_data)
+        throw ArrayException::OutOfMemory;
+    m_frames.Reserve(m_frameCount);
+}
+/**Free the frames and remove the backing file.*/
+template<typename DataType>
+TieredArray<DataType>::~TieredArray()
+{
+    std::free(m_data);
+    m_file.Remove();
+}
+/**Get the amount of elements.
+\return The amount of elements.*/
+template<typename DataType>
+cg::SizeType TieredArray<DataType>::Size() const
+{
+    return m_size;
+}
+/**Determine if there are no elements.
+\return True if there are none.*/
+template<typename DataType>
+bool TieredArray<DataType>::Empty() const
+{
+    return m_size == 0;
+}
+/**Copy an object to the back of the list.
+\param o The object.*/
+template<typename DataType>
+void TieredArray<DataType>::PushBack(const DataType& o)
+{
+    if (m_size == m_blocks.Size() * m_perBlock)
+        m_blocks.PushBack(Slot{ NoFrame, false });
+    ++m_size;
+    std::memcpy(Fault(m_size - 1, true), &o, sizeof(DataType));
+}
+/**Get a copy of an element, faulting its block in if it is not in memory.
+\param i The index.
+\return The element.
+\throw ArrayException::IndexOutOfBounds if \p i is not an element.*/
+template<typename DataType>
+DataType TieredArray<DataType>::Get(cg::SizeType i)
+{
+    if (i >= m_size)
+        throw ArrayException::IndexOutOfBounds;
+    DataType o;
+    std::memcpy(&o, Fault(i, false), sizeof(DataType));
+    return o;
+}
+/**Change an element, faulting its block in if it is not in memory.
+\param i The index.
+\param o The new value.
+\throw ArrayException::IndexOutOfBounds if \p i is not an element.*/
+template<typename DataType>
+void TieredArray<DataType>::Set(cg::SizeType i, const DataType& o)
+{
+    if (i >= m_size)
+        throw ArrayException::IndexOutOfBounds;
+    std::memcpy(Fault(i, true), &o, sizeof(DataType));
+}
+/**Get a copy of the last element.
+\return The last element.
+\throw ArrayException::ListEmpty if there are no elements.*/
+template<typename DataType>
+DataType TieredArray<DataType>::Back()
+{
+    if (m_size == 0)
+        throw ArrayException::ListEmpty;
+    return Get(m_size - 1);
+}
+/**Pop off the last element.  If that empties its block, the block is
+dropped without being written.
+\throw ArrayException::ListEmpty if there are no elements.*/
+template<typename DataType>
+void TieredArray<DataType>::PopBack()
+{
+    if (m_size == 0)
+        throw ArrayException::ListEmpty;
+    --m_size;
+    if (m_size != (m_blocks.Size() - 1) * m_perBlock)
+        return;
+    cg::SizeType f = m_blocks.Back().m_frame;
+    if (f != NoFrame)
+        m_frames.Get(f) = Frame{ NoFrame, false, false };
+    m_blocks.PopBack();
+}
+/**Remove every element and empty the backing file.  The frames are kept for
+the next elements.
+\throw TieredArrayException::IOError if the file could not be emptied.*/
+template<typename DataType>
+void TieredArray<DataType>::Clear()
+{
+    for (cg::SizeType f = 0; f < m_frames.Size(); ++f)
+        m_frames.Get(f) = Frame{ NoFrame, false, false };
+    m_blocks.PopBack(m_blocks.Size());
+    m_size = 0;
+    m_file.Remove();
+    if (!m_file.Touch())
+        throw TieredArrayException::IOError;
+}
+/**Write every changed block to the file.  The blocks stay in memory.
+\throw TieredArrayException::IOError if a block could not be written.*/
+template<typename DataType>
+void TieredArray<DataType>::Flush()
+{
+    for (cg::SizeType f = 0; f < m_frames.Size(); ++f)
+        if (m_frames.Get(f).m_dirty)
+            WriteBack(f);
+}
+/**Get the most bytes of blocks that are kept in memory.
+\return The budget, rounded down to whole blocks.*/
+template<typename DataType>
+cg::SizeType TieredArray<DataType>::Budget() const
+{
+    return m_frameCount * m_blockBytes;
+}
+/**Get the bytes of blocks that are in memory now.
+\return The bytes in use.*/
+template<typename DataType>
+cg::SizeType TieredArray<DataType>::HotBytes() const
+{
+    return m_frames.Size() * m_blockBytes;
+}
+/**Get the size of a block.
+\return The size of a block in bytes.*/
+template<typename DataType>
+cg::SizeType TieredArray<DataType>::BlockSize() const
+{
+    return m_blockBytes;
+}
+/**Get what has been done since the array was made or ResetStats was
+called.
+\return The counts.*/
+template<typename DataType>
+const TieredArrayStats& TieredArray<DataType>::Stats() const
+{
+    return m_stats;
+}
+/**Set the counts back to zero.*/
+template<typename DataType>
+void TieredArray<DataType>::ResetStats()
+{
+    m_stats = TieredArrayStats();
+}
+///////////////////////////////////////////////////////////////////////////
+/**Get an element in memory, faulting its block in if it has to.
+\param i The index.
+\param write True if the element will be changed.
+\return The address of the element.  Only good until the next fault.
+\throw TieredArrayException::IOError if a block could not be moved.*/
+template<typename DataType>
+DataType* TieredArray<DataType>::Fault(cg::SizeType i, bool write)
+{
+    cg::SizeType block = i / m_perBlock;
+    Slot& slot = m_blocks.Get(block);
+    cg::SizeType f = slot.m_frame;
+    if (f != NoFrame)
+        ++m_stats.m_hits;
+    else
+    {
+        ++m_stats.m_misses;
+        if (m_frames.Size() < m_frameCount)
+        {
+            f = m_frames.Size();
+            m_frames.PushBack(Frame{ NoFrame, false, false });
+        }
+        else
+        {
+            f = Victim();
+            Evict(f);
+        }
+        if (slot.m_stored)
+        {
+            if (!m_file.Read(FrameData(f), m_blockBytes,
+                (std::ptrdiff_t)(block * m_blockBytes)))
+                throw TieredArrayException::IOError;
+            ++m_stats.m_reads;
+        }
+        /*a block that was never written can not have anything in it yet.*/
+        m_frames.Get(f).m_block = block;
+        slot.m_frame = f;
+    }
+    Frame& frame = m_frames.Get(f);
+    frame.m_ref = true;
+    frame.m_dirty = frame.m_dirty || write;
+    return (DataType*)FrameData(f) + (i - block * m_perBlock);
+}
+/**Move the clock hand to a frame that was not touched since it last went
+by, clearing the marks it passes.
+\return The frame to drop.*/
+template<typename DataType>
+cg::SizeType TieredArray<DataType>::Victim()
+{
+    for (;;)
+    {
+        cg::SizeType f = m_hand;
+        m_hand = (m_hand + 1) % m_frameCount;
+        Frame& frame = m_frames.Get(f);
+        if (!frame.m_ref)
+            return f;
+        frame.m_ref = false;
+    }
+}
+/**Drop the block in a frame, writing it first if it was changed.
+\param f The frame.*/
+template<typename DataType>
+void TieredArray<DataType>::Evict(cg::SizeType f)
+{
+    Frame& frame = m_frames.Get(f);
+    if (frame.m_block == NoFrame)
+        return;
+    if (frame.m_dirty)
+        WriteBack(f);
+    m_blocks.Get(frame.m_block).m_frame = NoFrame;
+    frame = Frame{ NoFrame, false, false };
+    ++m_stats.m_evictions;
+}
+/**Write the block in a frame to its place in the file.
+\param f The frame.
+\throw TieredArrayException::IOError if the block could not be written.*/
+template<typename DataType>
+void TieredArray<DataType>::WriteBack(cg::SizeType f)
+{
+    Frame& frame = m_frames.Get(f);
+    if (!m_file.Write(FrameData(f), m_blockBytes,
+        (std::ptrdiff_t)(frame.m_block * m_blockBytes)))
+        throw TieredArrayException::IOError;
+    m_blocks.Get(frame.m_block).m_stored = true;
+    frame.m_dirty = false;
+    ++m_stats.m_writeBacks;
+}
+/**Get the memory of a frame.
+\param f The frame.
+\return The first byte of the frame.*/
+template<typename DataType>
+char* TieredArray<DataType>::FrameData(cg::SizeType f)
+{
+    return m_data + f * m_blockBytes;
+}
+
+template class TieredArray<int>;
+
+}
@@ -0,0 +1,178 @@
+/*
+
+(C) Matthew Swanson
+
+This file is part of ColdStorage.
+
+ColdStorage is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+any later version.
+
+ColdStorage is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with ColdStorage.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "Array.hpp"
+#include "../../../FileSystem.hpp"
+
+namespace cg {
+
+/**Tiered array exceptions*/
+enum class TieredArrayException {
+    /**A block could not be written to or read from the backing file.*/
+    IOError,
+};
+
+/**Counts of what a TieredArray has done since it was made or the counts were
+reset.*/
+struct TieredArrayStats
+{
+    /**Accesses to a block that was in memory.*/
+    cg::SizeType m_hits = 0;
+    /**Accesses to a block that had to be faulted in.*/
+    cg::SizeType m_misses = 0;
+    /**Blocks read back from the file.*/
+    cg::SizeType m_reads = 0;
+    /**Blocks dropped from memory to make room.*/
+    cg::SizeType m_evictions = 0;
+    /**Blocks written to the file.*/
+    cg::SizeType m_writeBacks = 0;
+};
+
+/**An array that keeps only its hot blocks in memory.
+
+The elements are split into fixed size blocks.  At most Budget() bytes of
+blocks are held in memory; the rest live in a backing file, and are read
+back when an element in them is touched.  When a block has to be faulted in
+and the budget is used up, a block that was not touched lately is dropped to
+make room.  It is only written to the file if it was changed since it was
+last read, so reading a data set that is bigger than the budget costs one
+read per miss and no writes.
+
+The blocks to drop are picked with a clock: each touch marks a block, and
+the hand clears marks until it finds a block that was not touched since the
+last time it went by.  It is close to LRU and a touch costs one store.
+
+The backing file is scratch space.  It is emptied when the array is made and
+removed when the array is destroyed; MappedArray is the one to keep.
+
+Elements are handed out by value, since a reference would point into a
+block that the next access may drop.
+\tparam DataType The type of data.  It must be trivially copyable, since
+blocks are moved to and from the file as bytes.*/
+template<typename DataType>
+class TieredArray
+{
+public:
+    static_assert(std::is_trivially_copyable<DataType>::value,
+        "A tiered array can only hold trivially copyable types.");
+    /**The type of this object.*/
+    using SelfType = TieredArray<DataType>;
+    /**The size of a block when none is given.*/
+    const static cg::SizeType DefaultBlockBytes = 64 * 1024;
+
+    TieredArray(const std::string& path, cg::SizeType budget,
+        cg::SizeType blockBytes = DefaultBlockBytes);
+
+    ~TieredArray();
+
+    TieredArray(const SelfType&) = delete;
+
+    void operator=(const SelfType&) = delete;
+
+    cg::SizeType Size() const;
+
+    bool Empty() const;
+
+    void PushBack(const DataType& o);
+
+    DataType Get(cg::SizeType i);
+
+    void Set(cg::SizeType i, const DataType& o);
+
+    DataType Back();
+
+    void PopBack();
+
+    void Clear();
+
+    void Flush();
+
+    cg::SizeType Budget() const;
+
+    cg::SizeType HotBytes() const;
+
+    cg::SizeType BlockSize() const;
+
+    const TieredArrayStats& Stats() const;
+
+    void ResetStats();
+private:
+    /**Marks a block that is not in memory, or a frame with no block.*/
+    const static cg::SizeType NoFrame = (cg::SizeType)-1;
+    /**Where a block is.*/
+    struct Slot
+    {
+        /**The frame holding the block, or NoFrame.*/
+        cg::SizeType m_frame;
+        /**True once the block has been written to the file.*/
+        bool m_stored;
+    };
+    /**A place in memory for one block.*/
+    struct Frame
+    {
+        /**The block in the frame, or NoFrame.*/
+        cg::SizeType m_block;
+        /**True if the block was changed since it was read.*/
+        bool m_dirty;
+        /**True if the block was touched since the hand last went by.*/
+        bool m_ref;
+    };
+
+    DataType* Fault(cg::SizeType i, bool write);
+
+    cg::SizeType Victim();
+
+    void Evict(cg::SizeType f);
+
+    void WriteBack(cg::SizeType f);
+
+    char* FrameData(cg::SizeType f);
+
+    /**The backing file.*/
+    cg::File m_file;
+    /**Where each block is.*/
+    cg::Array<Slot, 0> m_blocks;
+    /**The frames in use.  Never more than m_frameCount.*/
+    cg::Array<Frame, 0> m_frames;
+    /**The memory for the frames.*/
+    char* m_data;
+    /**The most frames there can be.*/
+    cg::SizeType m_frameCount;
+    /**The amount of elements in a block.*/
+    cg::SizeType m_perBlock;
+    /**The size of a block in bytes.*/
+    cg::SizeType m_blockBytes;
+    /**The amount of elements.*/
+    cg::SizeType m_size = 0;
+    /**The next frame the clock looks at.*/
+    cg::SizeType m_hand = 0;
+    /**What has been done.*/
+    TieredArrayStats m_stats;
+};
+
+}
@@ -207,6 +207,18 @@ template<typename T>
 using RemoveReference = typename RemoveReferenceImpl<T>::Type;
 
 
+/**How a container lays out the keys and data of its items.*/
+enum class NodeLayout
+{
+    /**Each key sits next to its data, in a Pair.  Best when the data is
+    small or is read every time a key is.*/
+    Interleaved,
+    /**The keys are kept apart from the data, so searching and reordering
+    only touch keys.  The data is only touched when it is asked for.  Best
+    when the data is large.*/
+    Split,
+};
+
 /**Swap two things with moves.
 \param a The first thing.
 \param b The second thing.*/
@@ -245,4 +257,23 @@ struct Greater
     }
 };
 
+/**Get the larger of two things.
+\param a The first thing.
+\param b The second thing.
+\return \p b if it is larger than \p a, otherwise \p a.*/
+template<typename T>
+inline const T& Max(const T& a, const T& b)
+{
+    return a < b ? b : a;
+}
+/**Get the smaller of two things.
+\param a The first thing.
+\param b The second thing.
+\return \p b if it is smaller than \p a, otherwise \p a.*/
+template<typename T>
+inline const T& Min(const T& a, const T& b)
+{
+    return b < a ? b : a;
+}
+
 }
\ No newline at end of file
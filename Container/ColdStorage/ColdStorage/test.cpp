@@ -4,9 +4,16 @@
 #include <string>
 #include <queue>
 #include <cstdlib>
+#include <cstdio>
 #include <cassert>
 
 #include "BinaryTree.hpp"
+#include "ArrayHeap.hpp"
+#include "DiskBTree.hpp"
+
+template class cg::ArrayHeap<int, int, 0, cg::Less<int>, 4>;
+template class cg::ArrayHeap<int, int, 0, cg::Less<int>, 4,
+    cg::NodeLayout::Split>;
 
 
 int main()
@@ -23,6 +30,31 @@ int main()
 
     t.ShowKeys(std::cout);
 
+    {
+        /*the free list of a commit goes in free pages, so changing and
+        committing over and over does not grow the file.*/
+        std::remove("DiskBTreeTest.bin");
+        cg::DiskBTree<int, int> d("DiskBTreeTest.bin");
+        for (int i = 0; i < 2000; ++i)
+            d.Push(i, i);
+        d.Commit();
+        for (int i = 0; i < 4; ++i)
+        {
+            d.Push(i, -i);
+            d.Commit();
+        }
+        cg::SizeType pages = d.Pages();
+        for (int i = 0; i < 200; ++i)
+        {
+            d.Push(i, -i);
+            d.Commit();
+            assert(d.Pages() == pages);
+        }
+        int got = 0;
+        assert(d.Get(150, got) && got == -150);
+    }
+    std::remove("DiskBTreeTest.bin");
+
     int stop = 0;
     return 0;
 }
@@ -0,0 +1,161 @@
+#include "Executor.hpp"
+
+#include <algorithm>
+
+namespace cg {
+
+const std::size_t Executor::ms_minSharedThreads;
+
+namespace {
+/**The executor that owns the current thread, if any.*/
+thread_local const Executor* t_owner = nullptr;
+}
+
+Executor::Executor(std::size_t threads, std::size_t maxQueue)
+	:m_maxQueue(maxQueue == 0 ? 1 : maxQueue)
+{
+	if (!ms_log)
+		EnableLogs(true, "Executor");
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+	m_run = true;
+	m_threads.reserve(threads);
+	for (std::size_t i = 0; i < threads; ++i)
+		m_threads.emplace_back(&Executor::WorkLoop, this);
+	LogNote(3, "Started ", threads, " workers with a queue of ", m_maxQueue,
+		".");
+}
+
+Executor::~Executor()
+{
+	Stop();
+}
+
+bool Executor::Post(Task task)
+{
+	return Push(std::move(task), true);
+}
+
+bool Executor::TryPost(Task task)
+{
+	return Push(std::move(task), false);
+}
+
+std::size_t Executor::Pending() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_queue.size();
+}
+
+std::size_t Executor::ThreadCount() const
+{
+	return m_threads.size();
+}
+
+std::size_t Executor::MaxQueue() const
+{
+	return m_maxQueue;
+}
+
+void Executor::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_run)
+			return;
+		m_run = false;
+	}
+	mcv_notEmpty.notify_all();
+	mcv_notFull.notify_all();
+	for (auto& t : m_threads)
+	{
+		if (!t.joinable())
+			continue;
+		/*a worker can not join itself. It is let go instead, so destroying
+		the executor later does not find a joinable thread.*/
+		if (t.get_id() == std::this_thread::get_id())
+			t.detach();
+		else
+			t.join();
+	}
+	LogNote(3, "Stopped.");
+}
+
+bool Executor::InWorker() const
+{
+	return t_owner == this;
+}
+
+Executor & Executor::Shared()
+{
+	/*the async I/O calls block on sockets and files, so keep a few workers
+	around even on small machines.*/
+	static Executor shared(std::max<std::size_t>(
+		std::thread::hardware_concurrency(), ms_minSharedThreads));
+	return shared;
+}
+
+bool Executor::Push(Task && task, bool block)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (!m_run)
+		return false;
+	if (m_queue.size() >= m_maxQueue)
+	{
+		if (!block)
+			return false;
+		if (InWorker())
+		{
+			/*waiting here could deadlock the pool on itself.*/
+			lock.unlock();
+			task();
+			return true;
+		}
+		mcv_notFull.wait(lock, [&]() {
+			return m_queue.size() < m_maxQueue || !m_run;
+		});
+		if (!m_run)
+			return false;
+	}
+	m_queue.push_back(std::move(task));
+	lock.unlock();
+	mcv_notEmpty.notify_one();
+	return true;
+}
+
+void Executor::WorkLoop()
+{
+	t_owner = this;
+	while (true)
+	{
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			mcv_notEmpty.wait(lock, [&]() {
+				return !m_queue.empty() || !m_run;
+			});
+			/*drain whatever is left before stopping.*/
+			if (m_queue.empty())
+				break;
+			task = std::move(m_queue.front());
+			m_queue.pop_front();
+		}
+		mcv_notFull.notify_one();
+		try {
+			task();
+		}
+		catch (const std::exception& e)
+		{
+			LogError("A posted task threw: ", e.what());
+		}
+		catch (...)
+		{
+			LogError("A posted task threw an unknown exception.");
+		}
+	}
+	t_owner = nullptr;
+}
+
+}
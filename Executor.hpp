@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "LogAdaptor.hpp"
+#include "NoCopyMove.hpp"
+
+namespace cg {
+
+/**A fixed pool of worker threads that run queued tasks.
+
+The queue is bounded.  When it is full, Submit and Post will block until a
+worker frees a slot.  If the caller is itself one of the workers, the task is
+run inline instead so a worker can never deadlock waiting on its own pool.*/
+class Executor :
+	private cg::NoCopy,
+	public cg::LogAdaptor<Executor>
+{
+public:
+	/**A unit of work.*/
+	using Task = std::function<void()>;
+	/**Create the pool and start the workers.
+	\param threads The amount of worker threads. ZERO will use the hardware
+	concurrency (at least 1).
+	\param maxQueue The max amount of tasks that may wait in the queue before
+	producers block. ZERO is treated as 1.*/
+	Executor(std::size_t threads = 0, std::size_t maxQueue = 1024);
+	/**Stop the workers. Tasks already in the queue are run first.*/
+	~Executor();
+	/**Queue a callable and get a future for its result.  The arguments are
+	decay-copied into the task, so they need to stay valid only for the call
+	itself (pointers still need to point at something that outlives the task).
+	\param call The callable to run on a worker.
+	\param args The arguments to copy and send to the callable.
+	\return A future that will hold the result of the call, or the exception
+	it threw.*/
+	template<typename Call, typename...Args>
+	auto Submit(Call&& call, Args&&...args)
+		-> std::future<std::result_of_t<std::decay_t<Call>(std::decay_t<Args>&...)>>;
+	/**Queue a task with no result. Will block if the queue is full.
+	\param task The task to run.
+	\return False if the executor is stopped and the task was dropped.*/
+	bool Post(Task task);
+	/**Queue a task with no result without blocking.
+	\param task The task to run.
+	\return True if the task was queued, false if the queue was full or the
+	executor is stopped.*/
+	bool TryPost(Task task);
+	/**Get the amount of tasks waiting to be run.
+	\return The size of the queue.*/
+	std::size_t Pending() const;
+	/**Get the amount of worker threads.
+	\return The amount of workers in the pool.*/
+	std::size_t ThreadCount() const;
+	/**Get the max size of the queue.
+	\return The amount of tasks that can wait before producers block.*/
+	std::size_t MaxQueue() const;
+	/**Stop accepting tasks, drain the queue, and join the workers.  Called
+	from a worker, that worker is detached instead of joined, and finishes on
+	its own once its task returns.*/
+	void Stop();
+	/**Determine if the calling thread is one of this pool's workers.
+	\return True if called from a worker of this executor.*/
+	bool InWorker() const;
+	/**Get the executor shared by the library (Writer, Reader, Filter async
+	calls).  It is created on first use.
+	\return A reference to the shared executor.*/
+	static Executor& Shared();
+	/**The least amount of workers the shared executor will start with.*/
+	const static std::size_t ms_minSharedThreads = 4;
+private:
+	using cg::LogAdaptor<Executor>::EnableLogs;
+	using cg::LogAdaptor<Executor>::LogNote;
+	using cg::LogAdaptor<Executor>::LogWarn;
+	using cg::LogAdaptor<Executor>::LogError;
+	using cg::LogAdaptor<Executor>::Log;
+	using cg::LogAdaptor<Executor>::ms_log;
+	using cg::LogAdaptor<Executor>::ms_name;
+	/**Put a task on the queue.
+	\param task The task to queue.
+	\param block True to wait for a free slot if the queue is full.
+	\return True if the task was queued (or run inline).*/
+	bool Push(Task&& task, bool block);
+	/**The loop each worker runs.*/
+	void WorkLoop();
+	/**The queued tasks.*/
+	std::deque<Task> m_queue;
+	/**Guards the queue.*/
+	mutable std::mutex m_mutex;
+	/**Signaled when a task is queued or the pool stops.*/
+	std::condition_variable mcv_notEmpty;
+	/**Signaled when a task is taken off the queue.*/
+	std::condition_variable mcv_notFull;
+	/**The worker threads.*/
+	std::vector<std::thread> m_threads;
+	/**The max size of the queue.*/
+	std::size_t m_maxQueue;
+	/**False when the pool is stopping.*/
+	std::atomic_bool m_run;
+};
+
+template<typename Call, typename...Args>
+inline auto Executor::Submit(Call&& call, Args&&...args)
+	-> std::future<std::result_of_t<std::decay_t<Call>(std::decay_t<Args>&...)>>
+{
+	using Ret = std::result_of_t<std::decay_t<Call>(std::decay_t<Args>&...)>;
+	/*packaged_task is move only, std::function needs copyable, so share it.*/
+	auto task = std::make_shared<std::packaged_task<Ret()>>(
+		std::bind(std::forward<Call>(call), std::forward<Args>(args)...));
+	auto future = task->get_future();
+	if (!Push([task]() { (*task)(); }, true))
+	{
+		LogError("Task submitted to a stopped executor.");
+		throw std::runtime_error("The executor is stopped.");
+	}
+	return future;
+}
+
+}
@@ -156,6 +156,8 @@ bool File::Touch() const
 
 bool File::Remove() const
 {
+	if (m_stream.is_open())
+		m_stream.close();
 	int ret = std::remove(FullPath().c_str());
 	if (ret == 0)
 		return true;
@@ -163,25 +165,39 @@ bool File::Remove() const
 		return false;
 }
 
-bool File::Write(const char * data, std::size_t size, std::ptrdiff_t pos)
+bool File::Open(bool create)
 {
-	if (FileSystem::AutoCreate())
+	if (m_stream.is_open())
+		return true;
+	if (create)
 	{
 		m_dir.Touch();
 		FileSystem::Touch(FullPath());
 	}
-	if (!m_stream.is_open())
-		m_stream.open(FullPath().c_str());
+	m_stream.open(FullPath().c_str(), std::ios::binary | std::ios::in
+		| std::ios::out);
 	if (!m_stream.is_open())
 	{
 		LogError("The file could not be opened: ", FullPath());
 		return false;
 	}
+	return true;
+}
+
+bool File::Write(const char * data, std::size_t size, std::ptrdiff_t pos)
+{
+	if (!Open(FileSystem::AutoCreate()))
+		return false;
+	/*a seek is needed to go from reading to writing, so always do one.*/
 	if (pos != -1)
-		m_stream.seekg(pos);
+		m_stream.seekp(pos);
+	else
+		m_stream.seekp(0, std::ios::cur);
 	m_stream.write(data, size);
-	m_stream.close();
-	return true;
+	bool good = !m_stream.fail();
+	/*the stream stays open, so a failure must not stick to the next call.*/
+	m_stream.clear();
+	return good;
 }
 
 bool File::Write(char bt, std::size_t size, std::ptrdiff_t pos)
@@ -220,18 +236,16 @@ bool File::Read(cg::Serial & s, std::ptrdiff_t pos)
 
 bool File::Read(char * data, std::size_t size, std::ptrdiff_t pos)
 {
-	if (!m_stream.is_open())
-		m_stream.open(FullPath().c_str());
-	if (!m_stream.is_open())
-	{
-		LogError("The file could not be opened: ", FullPath());
+	if (!Open(false))
 		return false;
-	}
 	if (pos != -1)
 		m_stream.seekg(pos);
+	else
+		m_stream.seekg(0, std::ios::cur);
 	m_stream.read(data, size);
-	m_stream.close();
-	return true;
+	bool good = !m_stream.fail();
+	m_stream.clear();
+	return good;
 }
 
 bool File::Read(cg::ArrayView& data, std::ptrdiff_t pos)
@@ -259,6 +273,7 @@ std::string File::Ext() const
 void File::ShiftRight(std::size_t pos, std::size_t amt,
 	char fillByte, bool arrayLike)
 {
+	Close();
 	auto size = FileSystem::FileSize(FullPath()) - pos;
 	cg::ArrayView data(size);
 	m_stream.open(FullPath().c_str(), std::ios::binary | std::ios::in);
@@ -280,7 +295,7 @@ void File::ShiftRight(std::size_t pos, std::size_t amt,
 }
 void File::ShiftLeft(std::size_t pos, std::size_t amt, char fillByte)
 {
-
+	Close();
 	auto size = pos;
 	cg::ArrayView data(size);
 	m_stream.open(FullPath().c_str(), std::ios::binary | std::ios::in);
@@ -299,6 +314,8 @@ void File::ShiftLeft(std::size_t pos, std::size_t amt, char fillByte)
 }
 std::size_t File::Size() const
 {
+	if (m_stream.is_open())
+		m_stream.flush();
 	return FileSystem::FileSize(FullPath());
 }
 void File::Close()
@@ -311,12 +328,43 @@ void File::Flush()
 	if (m_stream.is_open())
 		m_stream.flush();
 }
+bool File::Sync()
+{
+	if (m_stream.is_open())
+	{
+		m_stream.flush();
+		if (m_stream.fail())
+		{
+			m_stream.clear();
+			return false;
+		}
+	}
+	/*the OS caches the file, not the handle, so a handle of our own can
+	write it out.*/
+#if defined(_WIN32)
+	HANDLE file = CreateFile(FullPath().c_str(), GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	bool good = FlushFileBuffers(file) != 0;
+	CloseHandle(file);
+#else
+	int fd = open(FullPath().c_str(), O_WRONLY);
+	if (fd < 0)
+		return false;
+	bool good = fsync(fd) == 0;
+	close(fd);
+#endif
+	return good;
+}
 bool File::Exists() const
 {
 	return cg::FileSystem::FileExists(FullPath().c_str()) == 1;
 }
 void File::SetPath(std::string path)
 {
+	Close();
 	for (std::size_t i = 0; path[i] != 0; ++i)
 	{
 		if (path[i] == '\\')
@@ -337,6 +385,7 @@ void File::SetPath(std::string path)
 void File::SetPath(const cg::Dir & dir, 
 	const std::string & name)
 {
+	Close();
 	m_dir = dir;
 	m_name = name;
 }
@@ -427,4 +476,168 @@ bool FileSystem::IsFile(const std::string & file)
 {
 	return FileExists(file) == 1;
 }
+
+/*************************************************************************************************/
+
+MappedFile::MappedFile(const std::string & path, std::size_t minSize)
+	:m_path(path)
+{
+	EnableLogs(true, "FileSystem::MappedFile");
+#if defined(_WIN32)
+	m_file = CreateFile(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		throw FileSystemException(FileSystemException::FileNotFound);
+	LARGE_INTEGER size;
+	GetFileSizeEx(m_file, &size);
+	m_size = (std::size_t)size.QuadPart;
+#else
+	m_fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (m_fd < 0)
+		throw FileSystemException((FileSystemException::Error)errno);
+	struct stat sb;
+	fstat(m_fd, &sb);
+	m_size = (std::size_t)sb.st_size;
+#endif
+	try {
+		if (m_size < minSize)
+			Resize(minSize);
+		else
+			Map();
+	}
+	catch (...)
+	{
+#if defined(_WIN32)
+		CloseHandle(m_file);
+#else
+		close(m_fd);
+#endif
+		throw;
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	Unmap();
+#if defined(_WIN32)
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+#else
+	if (m_fd >= 0)
+		close(m_fd);
+#endif
+}
+
+void MappedFile::Resize(std::size_t size)
+{
+#if defined(_WIN32)
+	/*a file can not be resized while a view of it is open.*/
+	Unmap();
+	LARGE_INTEGER end;
+	end.QuadPart = (LONGLONG)size;
+	if (!SetFilePointerEx(m_file, end, NULL, FILE_BEGIN)
+		|| !SetEndOfFile(m_file))
+		throw FileSystemException(FileSystemException::NoSpace);
+	m_size = size;
+	Map();
+#else
+	if (ftruncate(m_fd, (off_t)size) != 0)
+		throw FileSystemException((FileSystemException::Error)errno);
+#if defined(__linux__)
+	if (m_data && size)
+	{
+		/*the kernel moves the page tables, nothing is copied.*/
+		void* view = mremap(m_data, m_size, size, MREMAP_MAYMOVE);
+		if (view == MAP_FAILED)
+		{
+			int err = errno;
+			/*the old view is still good, so put the file back to fit it.*/
+			if (ftruncate(m_fd, (off_t)m_size) != 0)
+				LogNote(1, "Could not restore the size of ", m_path);
+			throw FileSystemException((FileSystemException::Error)err);
+		}
+		m_data = (char*)view;
+		m_size = size;
+		return;
+	}
+#endif
+	Unmap();
+	m_size = size;
+	Map();
+#endif
+}
+
+void MappedFile::Sync(bool async)
+{
+	if (!m_data)
+		return;
+#if defined(_WIN32)
+	if (!FlushViewOfFile(m_data, 0))
+		throw FileSystemException(FileSystemException::Unknown);
+	if (!async && !FlushFileBuffers(m_file))
+		throw FileSystemException(FileSystemException::Unknown);
+#else
+	if (msync(m_data, m_size, async ? MS_ASYNC : MS_SYNC) != 0)
+		throw FileSystemException((FileSystemException::Error)errno);
+#endif
+}
+
+char * MappedFile::Data()
+{
+	return m_data;
+}
+
+const char * MappedFile::Data() const
+{
+	return m_data;
+}
+
+std::size_t MappedFile::Size() const
+{
+	return m_size;
+}
+
+const std::string & MappedFile::Path() const
+{
+	return m_path;
+}
+
+void MappedFile::Map()
+{
+	if (m_size == 0)
+		return;
+#if defined(_WIN32)
+	m_map = CreateFileMapping(m_file, NULL, PAGE_READWRITE, 0, 0, NULL);
+	if (!m_map)
+		throw FileSystemException(FileSystemException::NoMemory);
+	m_data = (char*)MapViewOfFile(m_map, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (!m_data)
+	{
+		CloseHandle(m_map);
+		m_map = NULL;
+		throw FileSystemException(FileSystemException::NoMemory);
+	}
+#else
+	void* view = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		m_fd, 0);
+	if (view == MAP_FAILED)
+		throw FileSystemException((FileSystemException::Error)errno);
+	m_data = (char*)view;
+#endif
+	LogNote(1, "Mapped ", m_size, " bytes of ", m_path);
+}
+
+void MappedFile::Unmap()
+{
+	if (!m_data)
+		return;
+#if defined(_WIN32)
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_map);
+	m_map = NULL;
+#else
+	munmap(m_data, m_size);
+#endif
+	m_data = nullptr;
+}
 }
\ No newline at end of file
@@ -249,7 +249,9 @@ private:
 	std::vector<std::string> m_path;
 };
 
-/**A file object containing a cg::Dir path and file name.*/
+/**A file object containing a cg::Dir path and file name.  The stream is
+opened by the first read or write and kept open until Close, so many small
+reads and writes do not each open the file.*/
 class File : public cg::LogAdaptor<File>
 {
 public:
@@ -346,6 +348,10 @@ public:
 	void Close();
 	/**Flush the stream*/
 	void Flush();
+	/**Flush the stream and have the OS write the file out to the disk, so
+	what was written is kept if the machine goes down.
+	\return True if the file reached the disk.*/
+	bool Sync();
 	/**Determine if this file exists.
 	\return True if the file exists and is not a directory.*/
 	bool Exists() const;
@@ -364,12 +370,80 @@ private:
 	using cg::LogAdaptor<File>::Log;
 	using cg::LogAdaptor<File>::ms_log;
 	using cg::LogAdaptor<File>::ms_name;
-	/**an  for writing or reading.*/
-	std::fstream m_stream;
+	/**Open the stream if it is not open yet.
+	\param create True to create the file if it is not there.
+	\return True if the stream is open.*/
+	bool Open(bool create);
+	/**The stream for writing or reading.  Kept open between calls, so the
+	const functions that look at the file flush it first.*/
+	mutable std::fstream m_stream;
 	/**The directory for which the file will exist.*/
 	cg::Dir m_dir;
 	/**The name of the file.*/
 	std::string m_name;
 };
 
+
+/**A file mapped into memory for reading and writing.  The whole file is one
+view, so a byte at offset i of the file is at Data() + i, and pages are read
+in by the OS the first time they are touched.  Changes reach the file when
+the OS gets to them, or on Sync.*/
+class MappedFile : public cg::LogAdaptor<MappedFile>
+{
+public:
+	/**Open or create a file and map it.
+	\param path The path to the file.
+	\param minSize The least size the file should have. It is grown to this
+	if it is smaller, and never shrunk.
+	\throws cg::FileSystemException if the file can not be opened or
+	mapped.*/
+	MappedFile(const std::string& path, std::size_t minSize = 0);
+	/**Unmap and close the file. Does not sync.*/
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	void operator=(const MappedFile&) = delete;
+	/**Change the size of the file and the view.  The view may move, so
+	pointers from Data() are not good after this.
+	\param size The new size in bytes.
+	\throws cg::FileSystemException if the file could not be resized or
+	mapped again.*/
+	void Resize(std::size_t size);
+	/**Write the changed pages back to the file.
+	\param async True to only start the writes and return right away.
+	\throws cg::FileSystemException if the pages could not be written.*/
+	void Sync(bool async = false);
+	/**Get the mapped bytes.
+	\return A pointer to the first byte, or nullptr if the file is empty.*/
+	char* Data();
+	/**Get the mapped bytes.
+	\return A pointer to the first byte, or nullptr if the file is empty.*/
+	const char* Data() const;
+	/**Get the size of the file.
+	\return The size in bytes.*/
+	std::size_t Size() const;
+	/**Get the path of the file.
+	\return The path.*/
+	const std::string& Path() const;
+private:
+	/**Map the file at its current size.*/
+	void Map();
+	/**Drop the view.*/
+	void Unmap();
+	/**The path of the file.*/
+	std::string m_path;
+	/**The start of the view.*/
+	char* m_data = nullptr;
+	/**The size of the file and the view.*/
+	std::size_t m_size = 0;
+#if defined(_WIN32)
+	/**The file handle.*/
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	/**The mapping handle.*/
+	HANDLE m_map = NULL;
+#else
+	/**The file descriptor.*/
+	int m_fd = -1;
+#endif
+};
+
 }
\ No newline at end of file
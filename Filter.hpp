@@ -1,9 +1,10 @@
 #pragma once
 
 
-#include <thread>
+#include <future>
 
 #include "ArrayView.hpp"
+#include "Executor.hpp"
 
 namespace cg {
 /**The filter interface.*/
@@ -43,27 +44,30 @@ public:
 	{
 		return TransformCopy(av.data(), av.size());
 	}
-	/**Transform with any set of aprameters as log as there is an overload for
-	them.
-
-	\return A future with the result.*/
+	/**Transform a copy on the shared executor with any set of parameters as
+	long as there is an overload for them.  The source must stay valid until
+	the future is ready.
+	\param args The arguments for one of the TransformCopy overloads.
+	\return A future with the transformed copy.*/
 	template<typename...Args>
-	inline void AsyncTransformCopy(Args...args)
+	inline std::future<ArrayView> AsyncTransformCopy(Args&&...args)
 	{
-		return std::async(std::launch::async, [&]() {
-			this->TransformCopy(std::forward<Args>(args)...);
-		});
+		return cg::Executor::Shared().Submit([this](auto&...a) {
+			return this->TransformCopy(a...);
+		}, std::forward<Args>(args)...);
 	}
-	/**Transform with any set of aprameters as log as there is an overload for
-	them.
-
-	\return A future with the result.*/
+	/**Transform in place on the shared executor with any set of parameters
+	as long as there is an overload for them.  The data must stay valid until
+	the future is ready. Wrap an ArrayView with std::ref to transform it in
+	place instead of transforming a copy.
+	\param args The arguments for one of the Transform overloads.
+	\return A future that is ready when the transform is done.*/
 	template<typename...Args>
-	inline void AsyncTransform(Args...args)
+	inline std::future<void> AsyncTransform(Args&&...args)
 	{
-		return std::async(std::launch::async, [&]() {
-			this->TransformInPlace(std::forward<Args>(args)...);
-		});
+		return cg::Executor::Shared().Submit([this](auto&...a) {
+			this->Transform(a...);
+		}, std::forward<Args>(args)...);
 	}
 };
 
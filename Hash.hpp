@@ -1,47 +1,257 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#endif
 
 namespace cg {
 
+namespace impl {
+/**The default secret for the hash functions.  Odd, with 32 bits set in each
+word and each byte, so every bit of input reaches every bit of output.*/
+const uint64_t g_hashSecret[4] = {
+	0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+	0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+/**Multiply two 64 bit numbers into 128 bits.
+\param a The first number. Will hold the low 64 bits of the product.
+\param b The second number. Will hold the high 64 bits of the product.*/
+inline void HashMum(uint64_t& a, uint64_t& b)
+{
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = a;
+	r *= b;
+	a = (uint64_t)r;
+	b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	a = _umul128(a, b, &b);
+#else
+	uint64_t ha = a >> 32, hb = b >> 32;
+	uint64_t la = (uint32_t)a, lb = (uint32_t)b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32);
+	uint64_t c = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	c += lo < t;
+	a = lo;
+	b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+/**Multiply and fold the 128 bit product to 64 bits.
+\param a The first number.
+\param b The second number.
+\return The low half xor the high half of a*b.*/
+inline uint64_t HashMix(uint64_t a, uint64_t b)
+{
+	HashMum(a, b);
+	return a ^ b;
+}
+/**Read 8 bytes. Unaligned reads are fine.*/
+inline uint64_t HashRead8(const uint8_t* p)
+{
+	uint64_t v;
+	std::memcpy(&v, p, 8);
+	return v;
+}
+/**Read 4 bytes. Unaligned reads are fine.*/
+inline uint64_t HashRead4(const uint8_t* p)
+{
+	uint32_t v;
+	std::memcpy(&v, p, 4);
+	return v;
+}
+/**Read 1 to 3 bytes.*/
+inline uint64_t HashRead3(const uint8_t* p, std::size_t k)
+{
+	return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+}
+
+/**Hash a range of bytes.
 
-/**Hash an. The paramter T for this object must be fundamental or have a
-.Hash() const; function.
+A wyhash style hash.  Inputs up to 16 bytes are read with two overlapping
+loads and no loop.  Longer inputs are eaten 48 bytes at a time by three
+independent multiply lanes, which the CPU runs side by side.  That beats SSE2
+here since it has no 64 bit multiply.  Values are only stable for the same
+endianness.
+\param data The bytes to hash.
+\param size The amount of bytes.
+\param seed A seed. Different seeds give unrelated hashes.
+\return A 64bit hash number. Not fit for security purposes.*/
+inline uint64_t HashBytes(const void* data, std::size_t size, uint64_t seed = 0)
+{
+	using namespace impl;
+	const uint64_t* s = g_hashSecret;
+	const uint8_t* p = (const uint8_t*)data;
+	seed ^= HashMix(seed ^ s[0], s[1]);
+	uint64_t a;
+	uint64_t b;
+	if (size <= 16)
+	{
+		if (size >= 4)
+		{
+			a = (HashRead4(p) << 32) | HashRead4(p + ((size >> 3) << 2));
+			b = (HashRead4(p + size - 4) << 32)
+				| HashRead4(p + size - 4 - ((size >> 3) << 2));
+		}
+		else if (size > 0)
+		{
+			a = HashRead3(p, size);
+			b = 0;
+		}
+		else
+		{
+			a = b = 0;
+		}
+	}
+	else
+	{
+		std::size_t i = size;
+		if (i > 48)
+		{
+			uint64_t see1 = seed;
+			uint64_t see2 = seed;
+			do {
+				seed = HashMix(HashRead8(p) ^ s[1], HashRead8(p + 8) ^ seed);
+				see1 = HashMix(HashRead8(p + 16) ^ s[2],
+					HashRead8(p + 24) ^ see1);
+				see2 = HashMix(HashRead8(p + 32) ^ s[3],
+					HashRead8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16)
+		{
+			seed = HashMix(HashRead8(p) ^ s[1], HashRead8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		/*the last 16 bytes, overlapping what was already eaten if needed.*/
+		a = HashRead8(p + i - 16);
+		b = HashRead8(p + i - 8);
+	}
+	a ^= s[1];
+	b ^= seed;
+	HashMum(a, b);
+	return HashMix(a ^ s[0] ^ size, b ^ s[1]);
+}
+/**Hash a single 64 bit value. Much cheaper than HashBytes on 8 bytes.
+\param value The value.
+\param seed A seed.
+\return A 64bit hash number. Not fit for security purposes.*/
+inline uint64_t HashU64(uint64_t value, uint64_t seed = 0)
+{
+	uint64_t a = value ^ impl::g_hashSecret[0];
+	uint64_t b = seed ^ impl::g_hashSecret[1];
+	impl::HashMum(a, b);
+	return impl::HashMix(a ^ impl::g_hashSecret[0], b ^ impl::g_hashSecret[1]);
+}
+/**Fold another hash into a running hash, for keys made of several parts.
+The order of the parts matters.
+\param seed The running hash.
+\param hash The hash of the next part.
+\return The new running hash.*/
+inline std::size_t HashCombine(std::size_t seed, std::size_t hash)
+{
+	return (std::size_t)impl::HashMix(seed ^ impl::g_hashSecret[2],
+		hash ^ impl::g_hashSecret[3]);
+}
+
+/**Hash a string.
+\param str The string to hash.
+\param seed A seed.
+\return A 64bit hash number. Not fit for security purposes.*/
+inline std::size_t Hash(const std::string& str, uint64_t seed = 0)
+{
+	return (std::size_t)HashBytes(str.data(), str.size(), seed);
+}
+/**Hash a null terminated string. Hashes the same as the std::string.
+\param str The string to hash.
+\param seed A seed.
+\return A 64bit hash number. Not fit for security purposes.*/
+inline std::size_t Hash(const char* str, uint64_t seed = 0)
+{
+	return (std::size_t)HashBytes(str, std::strlen(str), seed);
+}
+/**Hash a null terminated string in a mutable buffer. Without this a char*
+would pick the pointer overload and hash the address.
+\param str The string to hash.
+\param seed A seed.
+\return A 64bit hash number. Not fit for security purposes.*/
+inline std::size_t Hash(char* str, uint64_t seed = 0)
+{
+	return Hash((const char*)str, seed);
+}
+/**Hash an integer, enum, or pointer.
 \param obj The object to hash.
-\tparam T A fundamental/std::string object or an object with .Hash() const; 
-implimented.
+\param seed A seed.
+\tparam T An integral, enum, or pointer type.
 \return A 64bit hash number. Not fit for security purposes.*/
-inline std::size_t Hash(const std::string& str)
+template<typename T>
+inline std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value
+	|| std::is_pointer<T>::value, std::size_t>
+Hash(const T& obj, uint64_t seed = 0)
 {
-	std::size_t hash = 31;
-	for (auto i = 0; str[i] != 0; ++i)
-		hash += str[i] * 59;
-	return hash;
+	uint64_t bits = 0;
+	std::memcpy(&bits, &obj, sizeof(T) < 8 ? sizeof(T) : 8);
+	return (std::size_t)HashU64(bits, seed);
 }
-/**Hash an. The paramter T for this object must be fundamental or have a
-.Hash() const; function.
+/**Hash a floating point number.  0.0 and -0.0 hash the same since they
+compare equal.
 \param obj The object to hash.
-\tparam T A fundamental/std::string object or an object with .Hash() const;
-implimented.
+\param seed A seed.
+\tparam T A floating point type.
 \return A 64bit hash number. Not fit for security purposes.*/
 template<typename T>
-inline std::enable_if_t<std::is_fundamental<T>::value, std::size_t>
-Hash(const T& obj)
+inline std::enable_if_t<std::is_floating_point<T>::value, std::size_t>
+Hash(const T& obj, uint64_t seed = 0)
 {
-	return obj * 59;
+	if (obj == 0)
+		return (std::size_t)HashU64(0, seed);
+	return (std::size_t)HashBytes(&obj, sizeof(T), seed);
 }
-/**Hash an. The paramter T for this object must be fundamental or have a
-.Hash() const; function.
+/**Hash an object that has a .Hash() const; function.
 \param obj The object to hash.
-\tparam T A fundamental/std::string object or an object with .Hash() const;
-implimented.
+\param seed A seed. It is mixed in after obj.Hash().
+\tparam T A class type with .Hash() const; implimented.
 \return A 64bit hash number. Not fit for security purposes.*/
 template<typename T>
-inline std::enable_if_t<!std::is_fundamental<T>::value, std::size_t>
-Hash(const T& obj)
+inline auto Hash(const T& obj, uint64_t seed = 0)
+	-> std::enable_if_t<std::is_class<T>::value,
+	decltype((std::size_t)obj.Hash())>
+{
+	std::size_t hash = (std::size_t)obj.Hash();
+	return seed == 0 ? hash : HashCombine((std::size_t)seed, hash);
+}
+/**Hash a pair by combining both halves.
+\param obj The pair to hash.
+\param seed A seed.
+\return A 64bit hash number. Not fit for security purposes.*/
+template<typename A, typename B>
+inline std::size_t Hash(const std::pair<A, B>& obj, uint64_t seed = 0)
 {
-	return T.Hash() * 59;
+	return HashCombine(Hash(obj.first, seed), Hash(obj.second, seed));
+}
+/**Hash several values as one composite key.
+\param first The first value.
+\param rest The other values.
+\return A 64bit hash number. Not fit for security purposes.*/
+template<typename First, typename...Rest>
+inline std::size_t HashAll(const First& first, const Rest&...rest)
+{
+	std::size_t hash = Hash(first);
+	using Expand = int[];
+	(void)Expand{ 0, (hash = HashCombine(hash, Hash(rest)), 0)... };
+	return hash;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "LogAdaptor.hpp"
+#include "Memory.hpp"
+
+namespace cg {
+
+/**A bounded queue that many threads can push to and pop from at once without
+taking a lock.
+
+Each slot in the ring has a sequence number that says whose turn it is: a
+pusher may fill slot i when the sequence is the push position, and a popper
+may empty it when the sequence is one past it.  A push or pop is one compare
+and swap on a position and one store to the slot, and nothing is allocated
+after the queue is made.  When the queue is full TryPush returns false instead
+of waiting, so the capacity should be picked so that it never fills in normal
+use.
+
+Waiting works like LockBox::WaitForElements.  The mutex is only touched by a
+push when some thread is asleep in a wait.
+\tparam T The type to hold.  It must be move constructible.*/
+template<typename T>
+class MPMCQueue :
+	public LogAdaptor<MPMCQueue<T>>
+{
+public:
+	/**The type of value being used.*/
+	using Type = T;
+	/**Create the queue.  The ring is allocated here and never again.
+	\param capacity The most things the queue can hold.  It is rounded up to
+	a power of 2.*/
+	MPMCQueue(std::size_t capacity);
+	/**Destroy anything left in the queue.*/
+	~MPMCQueue();
+	MPMCQueue(const MPMCQueue<T>&) = delete;
+	MPMCQueue<T>& operator=(const MPMCQueue<T>&) = delete;
+	/**Try to add something to the back of the queue.
+	\param o The thing to add.
+	\return True if it was added, false if the queue was full.*/
+	template<typename U>
+	bool TryPush(U&& o);
+	/**Try to take something from the front of the queue.
+	\param out Set to the thing that was taken.
+	\return True if something was taken, false if the queue was empty.*/
+	bool TryPop(T& out);
+	/**Get the amount of things in the queue.  Other threads may change it at
+	any time, so it is only a hint.
+	\return The amount of things.*/
+	std::size_t Size() const;
+	/**Determine if the front of the queue is ready to be popped.
+	\return True if there is nothing to pop.*/
+	bool Empty() const;
+	/**Get the most things the queue can hold.
+	\return The capacity.*/
+	std::size_t Capacity() const;
+	/**Wait on this queue untill it is not empty any more. If it is already
+	not empty, then it returns immediatly.*/
+	void WaitForElements();
+	/**Wait on this queue untill it is not empty any more. If it is already
+	not empty, then it returns immediatly.
+	\param extBool A reference to a boolean that when its false, the waiting
+	will stop.*/
+	void WaitForElements(bool& extBool);
+	/**Wait on this queue untill it is not empty any more. If it is already
+	not empty, then it returns immediatly.
+	\param extBool A reference to and atomic bool that will stop the waiting
+	when made to be false*/
+	void WaitForElements(std::atomic_bool& extBool);
+	/**Notify the waiter that somehting has happened and should wake up.*/
+	void Notify();
+	/**NotifyAll on the waiter that somehting has happened and should wake up.
+	*/
+	void NotifyAll();
+private:
+	using LogAdaptor<MPMCQueue<T>>::LogNote;
+	/**The size to keep the positions apart by, so pushers and poppers do not
+	fight over one cache line.*/
+	static const std::size_t CacheLine = 64;
+	/**A slot in the ring.*/
+	struct Cell
+	{
+		/**Whose turn it is to use the slot.*/
+		std::atomic<std::size_t> m_seq;
+		/**The storage for the thing in the slot.*/
+		alignas(T) unsigned char m_data[sizeof(T)];
+		/**Get the thing in the slot.*/
+		T* Data()
+		{
+			return reinterpret_cast<T*>(m_data);
+		}
+	};
+	/**Wait untill \p stop returns true.
+	\param stop A function that returns true when the wait is over.*/
+	template<typename Pred>
+	void WaitUntil(Pred&& stop);
+	/**Wake a waiter if there is one.*/
+	void WakeOne();
+
+	/**The ring.*/
+	Cell* m_cells;
+	/**The capacity minus 1, to get a slot from a position.*/
+	const std::size_t m_mask;
+	/**The next position to push to.*/
+	alignas(CacheLine) std::atomic<std::size_t> m_pushPos;
+	/**The next position to pop from.*/
+	alignas(CacheLine) std::atomic<std::size_t> m_popPos;
+	/**The amount of threads waiting.*/
+	alignas(CacheLine) std::atomic<std::size_t> m_waiting;
+	/**A unique mutex for waiting.*/
+	std::mutex m_waitMutex;
+	/**A condition variable for waiting.*/
+	std::condition_variable mcv_waiter;
+};
+
+}
+
+#include "MPMCQueue_Impl.hpp"
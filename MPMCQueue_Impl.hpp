@@ -0,0 +1,193 @@
+
+#pragma once
+
+#include <new>
+#include <utility>
+
+#include "MPMCQueue.hpp"
+
+namespace cg {
+
+/**Round up to a power of 2 that is at least 2.  With one slot a full queue
+and an empty one would look the same.*/
+inline std::size_t MPMCQueueRing(std::size_t capacity)
+{
+	std::size_t n = 2;
+	while (n < capacity)
+		n <<= 1;
+	return n;
+}
+
+template<typename T>
+inline MPMCQueue<T>::MPMCQueue(std::size_t capacity)
+	:m_cells(cg::NewA<Cell>(__FUNCSTR__, MPMCQueueRing(capacity))),
+	m_mask(MPMCQueueRing(capacity) - 1)
+{
+	for (std::size_t i = 0; i <= m_mask; ++i)
+		m_cells[i].m_seq.store(i, std::memory_order_relaxed);
+	m_pushPos.store(0, std::memory_order_relaxed);
+	m_popPos.store(0, std::memory_order_relaxed);
+	m_waiting.store(0, std::memory_order_relaxed);
+}
+
+template<typename T>
+inline MPMCQueue<T>::~MPMCQueue()
+{
+	std::size_t end = m_pushPos.load(std::memory_order_relaxed);
+	for (std::size_t pos = m_popPos.load(std::memory_order_relaxed);
+		pos != end; ++pos)
+		m_cells[pos & m_mask].Data()->~T();
+	cg::DeleteA(__FUNCSTR__, m_cells);
+}
+
+template<typename T>
+template<typename U>
+inline bool MPMCQueue<T>::TryPush(U&& o)
+{
+	Cell* cell;
+	std::size_t pos = m_pushPos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		cell = &m_cells[pos & m_mask];
+		std::size_t seq = cell->m_seq.load(std::memory_order_acquire);
+		auto dif = (std::ptrdiff_t)(seq - pos);
+		if (dif == 0)
+		{
+			if (m_pushPos.compare_exchange_weak(pos, pos + 1,
+				std::memory_order_relaxed))
+				break;
+		}
+		else if (dif < 0)
+			/*the slot still holds what was pushed a lap ago.*/
+			return false;
+		else
+			pos = m_pushPos.load(std::memory_order_relaxed);
+	}
+	new (cell->Data()) T(std::forward<U>(o));
+	cell->m_seq.store(pos + 1, std::memory_order_release);
+	WakeOne();
+	return true;
+}
+
+template<typename T>
+inline bool MPMCQueue<T>::TryPop(T& out)
+{
+	Cell* cell;
+	std::size_t pos = m_popPos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		cell = &m_cells[pos & m_mask];
+		std::size_t seq = cell->m_seq.load(std::memory_order_acquire);
+		auto dif = (std::ptrdiff_t)(seq - (pos + 1));
+		if (dif == 0)
+		{
+			if (m_popPos.compare_exchange_weak(pos, pos + 1,
+				std::memory_order_relaxed))
+				break;
+		}
+		else if (dif < 0)
+			/*the slot has not been filled yet.*/
+			return false;
+		else
+			pos = m_popPos.load(std::memory_order_relaxed);
+	}
+	out = std::move(*cell->Data());
+	cell->Data()->~T();
+	/*free the slot for the push one lap from now.*/
+	cell->m_seq.store(pos + m_mask + 1, std::memory_order_release);
+	return true;
+}
+
+template<typename T>
+inline std::size_t MPMCQueue<T>::Size() const
+{
+	std::size_t pop = m_popPos.load(std::memory_order_relaxed);
+	std::size_t push = m_pushPos.load(std::memory_order_relaxed);
+	return push > pop ? push - pop : 0;
+}
+
+template<typename T>
+inline bool MPMCQueue<T>::Empty() const
+{
+	std::size_t pos = m_popPos.load(std::memory_order_acquire);
+	std::size_t seq =
+		m_cells[pos & m_mask].m_seq.load(std::memory_order_acquire);
+	return (std::ptrdiff_t)(seq - (pos + 1)) < 0;
+}
+
+template<typename T>
+inline std::size_t MPMCQueue<T>::Capacity() const
+{
+	return m_mask + 1;
+}
+
+template<typename T>
+inline void MPMCQueue<T>::WaitForElements()
+{
+	WaitUntil([&]() {
+		return !this->Empty();
+	});
+}
+
+template<typename T>
+inline void MPMCQueue<T>::WaitForElements(bool& extBool)
+{
+	WaitUntil([&]() {
+		return (!this->Empty() || !extBool);
+	});
+}
+
+template<typename T>
+inline void MPMCQueue<T>::WaitForElements(std::atomic_bool & extBool)
+{
+	WaitUntil([&]() {
+		return (!this->Empty() || !extBool.load());
+	});
+}
+
+template<typename T>
+inline void MPMCQueue<T>::Notify()
+{
+	/*take the mutex so a waiter that just checked its flag is asleep before
+	it is woken.*/
+	{
+		std::lock_guard<std::mutex> lock(m_waitMutex);
+	}
+	mcv_waiter.notify_one();
+}
+
+template<typename T>
+inline void MPMCQueue<T>::NotifyAll()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_waitMutex);
+	}
+	mcv_waiter.notify_all();
+}
+
+template<typename T>
+template<typename Pred>
+inline void MPMCQueue<T>::WaitUntil(Pred&& stop)
+{
+	if (stop())
+		return;
+	std::unique_lock<std::mutex> lock(m_waitMutex);
+	/*paired with the fence in WakeOne: either the pusher sees this count, or
+	this thread sees the push when it checks below.*/
+	m_waiting.fetch_add(1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	mcv_waiter.wait(lock, stop);
+	m_waiting.fetch_sub(1, std::memory_order_relaxed);
+	LogNote(1, "Finished waiting.");
+}
+
+template<typename T>
+inline void MPMCQueue<T>::WakeOne()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_waiting.load(std::memory_order_relaxed) == 0)
+		return;
+	Notify();
+}
+
+}
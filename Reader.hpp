@@ -4,6 +4,7 @@
 
 #include "LogAdaptor.hpp"
 #include "ArrayView.hpp"
+#include "Executor.hpp"
 
 #define _DEBUGREADER _DEBUG && 1
 
@@ -43,17 +44,17 @@ public:
 	{
 		return Read(data.data(), data.size(), timeout);
 	}
-	/**Read data in async mode. 
-
-	\tparam T An object that has .data()  and .size() const for reading
-	its data.
-	\return A future containing the amount of bytes written.*/
+	/**Read data in async mode on the shared executor. The arguments are
+	copied into the task, but any destination must stay valid until the
+	future is ready.
+	\param args The arguments for one of the Read overloads.
+	\return A future containing the result of the Read call.*/
 	template<typename...Args>
-	inline std::future<std::ptrdiff_t> AsyncRead(Args&&...args)
+	inline auto AsyncRead(Args&&...args)
 	{
-		return std::async(std::launch::async, [&]() {
-			return this->Read(std::forward<Args>(args)...);
-		});
+		return cg::Executor::Shared().Submit([this](auto&...a) {
+			return this->Read(a...);
+		}, std::forward<Args>(args)...);
 	}
 protected:
 	using cg::LogAdaptor<Reader>::EnableLogs;
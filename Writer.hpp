@@ -4,6 +4,7 @@
 
 #include "LogAdaptor.hpp"
 #include "ArrayView.hpp"
+#include "Executor.hpp"
 
 namespace cg {
 
@@ -52,15 +53,17 @@ public:
 	{
 		return Write(data.data(), data.size(), timeout);
 	}
-	/**Write data in async mode.
-
-	\return A future containing the amount of bytes written.*/
+	/**Write data in async mode on the shared executor. The arguments are
+	copied into the task, but any data pointer must stay valid until the
+	future is ready.
+	\param args The arguments for one of the Write overloads.
+	\return A future containing the result of the Write call.*/
 	template<typename...Args>
-	inline std::future<std::ptrdiff_t> AsyncWrite(Args&&...args)
+	inline auto AsyncWrite(Args&&...args)
 	{
-		return std::async(std::launch::async, [&]() {
-			return this->Write(std::forward<Args>(args)...);
-		});
+		return cg::Executor::Shared().Submit([this](auto&...a) {
+			return this->Write(a...);
+		}, std::forward<Args>(args)...);
 	}
 protected:
 	using cg::LogAdaptor<Writer>::EnableLogs;
@@ -3,63 +3,100 @@
 #include "../Filter.hpp"
 
 namespace cg {
-/**A reader/writing filter for AES encryption.*/
+/**A reader/writing filter for AES encryption.
+
+The cipher is keyed once and the CTR counter keeps running from one message
+to the next, so no two messages share keystream.  The other side has to run
+an AESDecryptFilter over the same messages in the same order.*/
 class AESEncryptFilter : public cg::Filter
 {
 public:
+	/**The keyed cipher context type.*/
+	using Cipher = CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption;
 	/**always returns false because the size will never change.*/
 	virtual bool SizeChanges() const
 	{
 		return false;
 	}
-	/**Create it.
+	/**Create it with its own cipher context.
 	\param key The key for encryption
-	\param iv The IV for encryption*/
+	\param iv The IV for encryption. It is the starting counter.*/
 	AESEncryptFilter(const CryptoPP::SecByteBlock& key,
 		const CryptoPP::SecByteBlock& iv)
-		:m_key(key), m_iv(iv) {}
+		:m_cipher(&m_ownCipher)
+	{
+		if (key.size() == 0)
+			throw EncryptionException(EncryptionException::Code::BadKey);
+		if (iv.size() == 0)
+			throw EncryptionException(EncryptionException::Code::BadIv);
+		m_ownCipher.SetKeyWithIV(key, key.size(), iv, iv.size());
+	}
+	/**Create it using a cipher context that lives somewhere else (like a
+	client descriptor) so the counter carries over between filters.
+	\param cipher The keyed cipher. It must outlive the filter.*/
+	AESEncryptFilter(Cipher& cipher)
+		:m_cipher(&cipher) {}
 	/**Transform data in place (no copies).
 	\param data The data place.
 	\param size The data size.*/
 	virtual void Transform(char* data, std::size_t size)
 	{
-		cg::SecureHelpers::AESEncrypt(data, data, size, size, m_key, m_iv);
+		if (size == 0)
+			return;
+		m_cipher->ProcessData((byte*)data, (const byte*)data, size);
 	}
 private:
-	/**The key used.*/
-	const CryptoPP::SecByteBlock& m_key;
-	/**The IV used.*/
-	const CryptoPP::SecByteBlock& m_iv;
+	/**The cipher used when the filter was keyed itself.*/
+	Cipher m_ownCipher;
+	/**The cipher in use.*/
+	Cipher* m_cipher;
 };
 
-/**A reader/writing filter for AES decryption.*/
+/**A reader/writing filter for AES decryption.
+
+\sa AESEncryptFilter for how the counter is kept.*/
 class AESDecryptFilter : public cg::Filter
 {
 public:
+	/**The keyed cipher context type.*/
+	using Cipher = CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption;
 	/**always returns false because the size will never change.*/
 	virtual bool SizeChanges() const
 	{
 		return false;
 	}
-	/**Create it.
+	/**Create it with its own cipher context.
 	\param key The key for decryption
-	\param iv The IV for decryption*/
+	\param iv The IV for decryption. It is the starting counter.*/
 	AESDecryptFilter(const CryptoPP::SecByteBlock& key,
 		const CryptoPP::SecByteBlock& iv)
-		:m_key(key), m_iv(iv) {}
+		:m_cipher(&m_ownCipher)
+	{
+		if (key.size() == 0)
+			throw EncryptionException(EncryptionException::Code::BadKey);
+		if (iv.size() == 0)
+			throw EncryptionException(EncryptionException::Code::BadIv);
+		m_ownCipher.SetKeyWithIV(key, key.size(), iv, iv.size());
+	}
+	/**Create it using a cipher context that lives somewhere else (like a
+	client descriptor) so the counter carries over between filters.
+	\param cipher The keyed cipher. It must outlive the filter.*/
+	AESDecryptFilter(Cipher& cipher)
+		:m_cipher(&cipher) {}
 	/**Transform data in place (no copies).
 	\param data The data place.
 	\param size The data size.*/
 	virtual void Transform(char* data, std::size_t size)
 	{
-		cg::SecureHelpers::AESDecrypt(data, data, size, size, m_key, m_iv);
+		if (size == 0)
+			return;
+		m_cipher->ProcessData((byte*)data, (const byte*)data, size);
 	}
 private:
-	/**The key used.*/
-	const CryptoPP::SecByteBlock& m_key;
-	/**The IV used.*/
-	const CryptoPP::SecByteBlock& m_iv;
-
+	/**The cipher used when the filter was keyed itself.*/
+	Cipher m_ownCipher;
+	/**The cipher in use.*/
+	Cipher* m_cipher;
 };
 
 
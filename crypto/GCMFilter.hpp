@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cryptopp/gcm.h>
+
+#include "SecureHelpers.hpp"
+#include "../Filter.hpp"
+#include "../Logger.hpp"
+
+namespace cg {
+
+/**A keyed AES-GCM context for one direction of a session.
+
+The key schedule and GHASH tables are set up once.  Each message gets its own
+nonce made from the session IV and a message counter (like TLS 1.3), so the
+nonce never has to be sent.  Both ends must process the same messages in the
+same order.
+\tparam Cipher GCM<AES>::Encryption or GCM<AES>::Decryption.*/
+template<typename Cipher>
+class AESGCMContext
+{
+public:
+	/**The size of the nonce in bytes.*/
+	const static std::size_t NonceSize = 12;
+	/**The size of the tag in bytes.*/
+	const static std::size_t TagSize = 16;
+	/**Create an unkeyed context.*/
+	AESGCMContext() :m_nonce(NonceSize) {};
+	/**Create and key the context.
+	\param key The AES key.
+	\param iv The IV for this direction. The first 12 bytes are the nonce
+	base.*/
+	AESGCMContext(const CryptoPP::SecByteBlock& key,
+		const CryptoPP::SecByteBlock& iv) :m_nonce(NonceSize)
+	{
+		Key(key, iv);
+	}
+	/**Key the context and reset the message counter.
+	\param key The AES key.
+	\param iv The IV for this direction. The first 12 bytes are the nonce
+	base.*/
+	void Key(const CryptoPP::SecByteBlock& key,
+		const CryptoPP::SecByteBlock& iv)
+	{
+		if (key.size() == 0)
+			throw EncryptionException(EncryptionException::Code::BadKey);
+		if (iv.size() < NonceSize)
+			throw EncryptionException(EncryptionException::Code::BadIv);
+		std::memcpy(m_nonce, iv, NonceSize);
+		m_cipher.SetKeyWithIV(key, key.size(), m_nonce, NonceSize);
+		m_sequence = 0;
+	}
+	/**Make the nonce for the next message and advance the counter.
+	\param out A place for NonceSize bytes.*/
+	void NextNonce(byte* out)
+	{
+		std::memcpy(out, m_nonce, NonceSize);
+		uint64_t seq = m_sequence++;
+		/*xor the big endian counter into the low 8 bytes.*/
+		for (std::size_t i = 0; i < 8; ++i)
+			out[NonceSize - 1 - i] ^= (byte)(seq >> (8 * i));
+	}
+	/**The keyed cipher.*/
+	Cipher m_cipher;
+private:
+	/**The nonce base.*/
+	CryptoPP::SecByteBlock m_nonce;
+	/**The amount of messages processed.*/
+	uint64_t m_sequence = 0;
+};
+
+/**A reader/writing filter for AES-GCM authenticated encryption.  Encrypts
+and authenticates in one pass.  The output is the cipher text followed by a
+16 byte tag.*/
+class AESGCMEncryptFilter : public cg::Filter
+{
+public:
+	/**The context type.*/
+	using Context =
+		AESGCMContext<CryptoPP::GCM<CryptoPP::AES>::Encryption>;
+	/**always returns true because the tag is added.*/
+	virtual bool SizeChanges() const
+	{
+		return true;
+	}
+	/**Create it with its own context.
+	\param key The key for encryption.
+	\param iv The IV for this direction.*/
+	AESGCMEncryptFilter(const CryptoPP::SecByteBlock& key,
+		const CryptoPP::SecByteBlock& iv)
+		:m_ownContext(key, iv), m_context(&m_ownContext) {}
+	/**Create it using a context that lives somewhere else (like a client
+	descriptor) so the message counter carries over between filters.
+	\param context The keyed context. It must outlive the filter.*/
+	AESGCMEncryptFilter(Context& context)
+		:m_context(&context) {}
+	/**Encrypt and tag the data.
+	\param src The place to read the data from.
+	\param size The size of the data.
+	\return An array view with the cipher text and tag.*/
+	virtual ArrayView TransformCopy(const char* src, std::size_t size) override
+	{
+		ArrayView av(size + Context::TagSize);
+		byte nonce[Context::NonceSize];
+		m_context->NextNonce(nonce);
+		m_context->m_cipher.EncryptAndAuthenticate((byte*)av.data(),
+			(byte*)av.data() + size, Context::TagSize,
+			nonce, Context::NonceSize, nullptr, 0, (const byte*)src, size);
+		return av;
+	}
+	/**Transform data in place (no copies).
+	\param data The data place.
+	\param size The data size.*/
+	virtual void Transform(char* data, std::size_t size)
+	{
+		cg::Logger::LogError("Cannot transform GCM in place. The tag needs ",
+			"room.");
+		throw EncryptionException(EncryptionException::Code::BadMem);
+	}
+private:
+	/**The context used when the filter was keyed itself.*/
+	Context m_ownContext;
+	/**The context in use.*/
+	Context* m_context;
+};
+
+/**A reader/writing filter for AES-GCM authenticated decryption.  Verifies
+the tag and decrypts in one pass.*/
+class AESGCMDecryptFilter : public cg::Filter
+{
+public:
+	/**The context type.*/
+	using Context =
+		AESGCMContext<CryptoPP::GCM<CryptoPP::AES>::Decryption>;
+	/**always returns true because the tag is removed.*/
+	virtual bool SizeChanges() const
+	{
+		return true;
+	}
+	/**Create it with its own context.
+	\param key The key for decryption.
+	\param iv The IV for this direction.*/
+	AESGCMDecryptFilter(const CryptoPP::SecByteBlock& key,
+		const CryptoPP::SecByteBlock& iv)
+		:m_ownContext(key, iv), m_context(&m_ownContext) {}
+	/**Create it using a context that lives somewhere else (like a client
+	descriptor) so the message counter carries over between filters.
+	\param context The keyed context. It must outlive the filter.*/
+	AESGCMDecryptFilter(Context& context)
+		:m_context(&context) {}
+	/**Verify and decrypt the data.
+	\param src The cipher text followed by the tag.
+	\param size The size of the cipher text and tag.
+	\throw EncryptionException with Code::AuthFailed if the tag does not
+	match.
+	\return An array view with the plain text.*/
+	virtual ArrayView TransformCopy(const char* src, std::size_t size) override
+	{
+		if (size < Context::TagSize)
+			throw EncryptionException(EncryptionException::Code::AuthFailed);
+		std::size_t textSize = size - Context::TagSize;
+		ArrayView av(textSize);
+		byte nonce[Context::NonceSize];
+		m_context->NextNonce(nonce);
+		bool ok = m_context->m_cipher.DecryptAndVerify((byte*)av.data(),
+			(const byte*)src + textSize, Context::TagSize,
+			nonce, Context::NonceSize, nullptr, 0, (const byte*)src, textSize);
+		if (!ok)
+		{
+			cg::Logger::LogError("The GCM tag did not verify.");
+			throw EncryptionException(EncryptionException::Code::AuthFailed);
+		}
+		return av;
+	}
+	/**Transform data in place (no copies).
+	\param data The data place.
+	\param size The data size.*/
+	virtual void Transform(char* data, std::size_t size)
+	{
+		cg::Logger::LogError("Cannot transform GCM in place. The tag needs ",
+			"to be removed.");
+		throw EncryptionException(EncryptionException::Code::BadMem);
+	}
+private:
+	/**The context used when the filter was keyed itself.*/
+	Context m_ownContext;
+	/**The context in use.*/
+	Context* m_context;
+};
+
+}
\ No newline at end of file
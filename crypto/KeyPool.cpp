@@ -0,0 +1,175 @@
+#include "KeyPool.hpp"
+
+#ifdef _WIN32
+#include "../OSInclude.hpp"
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace cg {
+
+KeyPool::KeyPool(std::size_t rsaDepth, std::size_t aesDepth)
+{
+	if (!ms_log)
+		EnableLogs(true, "KeyPool");
+	m_rsa.m_depth = rsaDepth;
+	m_aesKeys.m_depth = aesDepth;
+	m_aesIvs.m_depth = aesDepth;
+	m_run = true;
+	mt_filler = std::thread(&KeyPool::FillLoop, this);
+}
+
+KeyPool::~KeyPool()
+{
+	Stop();
+}
+
+KeyPair KeyPool::TakeRSAKeys()
+{
+	KeyPair keys;
+	if (Take(m_rsa, keys))
+		return keys;
+	return cg::SecureHelpers::MakeRSAKeys();
+}
+
+CryptoPP::SecByteBlock KeyPool::TakeAESKey()
+{
+	CryptoPP::SecByteBlock key;
+	if (Take(m_aesKeys, key))
+		return key;
+	return cg::SecureHelpers::MakeAESKey();
+}
+
+CryptoPP::SecByteBlock KeyPool::TakeAESIv()
+{
+	CryptoPP::SecByteBlock iv;
+	if (Take(m_aesIvs, iv))
+		return iv;
+	return cg::SecureHelpers::MakeAESIv();
+}
+
+void KeyPool::Depth(std::size_t rsaDepth, std::size_t aesDepth)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_rsa.m_depth = rsaDepth;
+		m_aesKeys.m_depth = aesDepth;
+		m_aesIvs.m_depth = aesDepth;
+		/*drop the extras so a smaller depth frees the memory.*/
+		while (m_rsa.m_items.size() > rsaDepth)
+			m_rsa.m_items.pop_back();
+		while (m_aesKeys.m_items.size() > aesDepth)
+			m_aesKeys.m_items.pop_back();
+		while (m_aesIvs.m_items.size() > aesDepth)
+			m_aesIvs.m_items.pop_back();
+	}
+	mcv_low.notify_one();
+}
+
+KeyPool::Stats KeyPool::RSAStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return MakeStats(m_rsa);
+}
+
+KeyPool::Stats KeyPool::AESKeyStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return MakeStats(m_aesKeys);
+}
+
+KeyPool::Stats KeyPool::AESIvStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return MakeStats(m_aesIvs);
+}
+
+void KeyPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_run)
+			return;
+		m_run = false;
+	}
+	mcv_low.notify_all();
+	if (mt_filler.joinable())
+		mt_filler.join();
+	LogNote(3, "Stopped.");
+}
+
+KeyPool & KeyPool::Shared()
+{
+	static KeyPool shared;
+	return shared;
+}
+
+bool KeyPool::AnyLow() const
+{
+	return m_rsa.Low() || m_aesKeys.Low() || m_aesIvs.Low();
+}
+
+void KeyPool::FillLoop()
+{
+	LowerPriority();
+	/*one generator for everything instead of one per key.*/
+	CryptoPP::AutoSeededRandomPool rng;
+	while (true)
+	{
+		bool rsa = false;
+		bool aesKey = false;
+		bool aesIv = false;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			mcv_low.wait(lock, [&]() { return !m_run || AnyLow(); });
+			if (!m_run)
+				break;
+			aesKey = m_aesKeys.Low();
+			aesIv = m_aesIvs.Low();
+			rsa = m_rsa.Low();
+		}
+		/*make one of each that is low, cheap ones first, then let the lock
+		go so takers are never held up by key generation.*/
+		try {
+			if (aesKey)
+			{
+				auto key = cg::SecureHelpers::MakeAESKey(rng);
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_aesKeys.Low())
+					m_aesKeys.m_items.push_back(std::move(key));
+			}
+			if (aesIv)
+			{
+				auto iv = cg::SecureHelpers::MakeAESIv(rng);
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_aesIvs.Low())
+					m_aesIvs.m_items.push_back(std::move(iv));
+			}
+			if (rsa && m_run)
+			{
+				auto keys = cg::SecureHelpers::MakeRSAKeys(rng);
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_rsa.Low())
+					m_rsa.m_items.push_back(std::move(keys));
+			}
+		}
+		catch (const std::exception& e)
+		{
+			LogError("Could not make key material: ", e.what());
+		}
+	}
+}
+
+void KeyPool::LowerPriority()
+{
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+	/*on linux the nice value belongs to the thread, not the process.*/
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+#endif
+}
+
+}
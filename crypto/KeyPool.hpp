@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "SecureHelpers.hpp"
+#include "../LogAdaptor.hpp"
+#include "../NoCopyMove.hpp"
+
+namespace cg {
+
+/**A pool of ready made key material.
+
+A low priority thread keeps RSA key pairs, AES keys and AES IVs stocked up to a
+target depth with a single random pool, so taking one is O(1).  If a kind runs
+dry the caller makes its own (a miss) and the filler is woken up.*/
+class KeyPool :
+	private cg::NoCopy,
+	public cg::LogAdaptor<KeyPool>
+{
+public:
+	/**Hit and miss counts for one kind of key material.*/
+	struct Stats
+	{
+		/**The amount of takes that were served from the pool.*/
+		std::size_t m_hits = 0;
+		/**The amount of takes that had to make their own.*/
+		std::size_t m_misses = 0;
+		/**The amount currently in the pool.*/
+		std::size_t m_depth = 0;
+	};
+	/**Create the pool and start the filler.
+	\param rsaDepth The amount of RSA key pairs to keep ready.
+	\param aesDepth The amount of AES keys, and of AES IVs, to keep ready.*/
+	KeyPool(std::size_t rsaDepth = 4, std::size_t aesDepth = 64);
+	/**Stop the filler.*/
+	~KeyPool();
+	/**Take an RSA key pair of the default size.
+	\return The keys.*/
+	KeyPair TakeRSAKeys();
+	/**Take an AES key of the default size.
+	\return The key.*/
+	CryptoPP::SecByteBlock TakeAESKey();
+	/**Take an AES IV of the default size.
+	\return The IV.*/
+	CryptoPP::SecByteBlock TakeAESIv();
+	/**Change the target depths. The filler catches up in the background.
+	\param rsaDepth The amount of RSA key pairs to keep ready.
+	\param aesDepth The amount of AES keys, and of AES IVs, to keep ready.*/
+	void Depth(std::size_t rsaDepth, std::size_t aesDepth);
+	/**Get the counts for RSA key pairs.
+	\return The stats.*/
+	Stats RSAStats() const;
+	/**Get the counts for AES keys.
+	\return The stats.*/
+	Stats AESKeyStats() const;
+	/**Get the counts for AES IVs.
+	\return The stats.*/
+	Stats AESIvStats() const;
+	/**Stop the filler. Takes still work, they just all miss once the pool
+	is empty.*/
+	void Stop();
+	/**Get the pool shared by the library.  It is created on first use.
+	\return A reference to the shared pool.*/
+	static KeyPool& Shared();
+private:
+	using cg::LogAdaptor<KeyPool>::EnableLogs;
+	using cg::LogAdaptor<KeyPool>::LogNote;
+	using cg::LogAdaptor<KeyPool>::LogWarn;
+	using cg::LogAdaptor<KeyPool>::LogError;
+	using cg::LogAdaptor<KeyPool>::Log;
+	using cg::LogAdaptor<KeyPool>::ms_log;
+	using cg::LogAdaptor<KeyPool>::ms_name;
+	/**The store for one kind of key material.*/
+	template<typename T>
+	struct Stock
+	{
+		/**The ready items.*/
+		std::deque<T> m_items;
+		/**The amount to keep ready.*/
+		std::size_t m_depth = 0;
+		/**The amount of hits.*/
+		std::size_t m_hits = 0;
+		/**The amount of misses.*/
+		std::size_t m_misses = 0;
+		/**Determine if the stock needs more.
+		\return True if it is under its depth.*/
+		bool Low() const { return m_items.size() < m_depth; }
+	};
+	/**Take one item from a stock.  The mutex must not be held.
+	\param stock The stock to take from.
+	\param out Will hold the item on a hit.
+	\return True on a hit.*/
+	template<typename T>
+	bool Take(Stock<T>& stock, T& out);
+	/**Make the counts for a stock. The mutex must be held.
+	\param stock The stock.
+	\return The stats.*/
+	template<typename T>
+	static Stats MakeStats(const Stock<T>& stock);
+	/**Determine if any stock is low. The mutex must be held.
+	\return True if the filler has work.*/
+	bool AnyLow() const;
+	/**The loop the filler runs.*/
+	void FillLoop();
+	/**Drop the priority of the calling thread.*/
+	static void LowerPriority();
+	/**The ready RSA keys.*/
+	Stock<KeyPair> m_rsa;
+	/**The ready AES keys.*/
+	Stock<CryptoPP::SecByteBlock> m_aesKeys;
+	/**The ready AES IVs.*/
+	Stock<CryptoPP::SecByteBlock> m_aesIvs;
+	/**Guards the stocks.*/
+	mutable std::mutex m_mutex;
+	/**Signaled when something is taken or the pool stops.*/
+	std::condition_variable mcv_low;
+	/**False when the filler should stop.*/
+	std::atomic_bool m_run;
+	/**The filler.*/
+	std::thread mt_filler;
+};
+
+template<typename T>
+inline bool KeyPool::Take(Stock<T>& stock, T & out)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (stock.m_items.empty())
+	{
+		++stock.m_misses;
+		lock.unlock();
+		mcv_low.notify_one();
+		return false;
+	}
+	out = std::move(stock.m_items.front());
+	stock.m_items.pop_front();
+	++stock.m_hits;
+	lock.unlock();
+	mcv_low.notify_one();
+	return true;
+}
+
+template<typename T>
+inline KeyPool::Stats KeyPool::MakeStats(const Stock<T>& stock)
+{
+	Stats stats;
+	stats.m_hits = stock.m_hits;
+	stats.m_misses = stock.m_misses;
+	stats.m_depth = stock.m_items.size();
+	return stats;
+}
+
+}
@@ -1,7 +1,133 @@
 #include "SecureHelpers.hpp"
 
+#include <algorithm>
+#include <exception>
+
+#include "../Executor.hpp"
+#include "../FileSystem.hpp"
+
 namespace cg {
 
+namespace {
+/**Run work(i) for each i in [0,count), split in contiguous parts across the
+shared executor.  The calling thread runs the last part itself.
+\param count The amount of items.
+\param work The work to run for each item.*/
+template<typename Work>
+void ParallelFor(std::size_t count, const Work& work)
+{
+	auto& ex = cg::Executor::Shared();
+	/*a worker waiting on its own pool could starve it.*/
+	if (count < SecureHelpers::ms_minParallelBatch || ex.InWorker())
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			work(i);
+		return;
+	}
+	std::size_t parts = std::min(count, ex.ThreadCount() + 1);
+	std::size_t per = count / parts;
+	std::size_t extra = count % parts;
+	std::vector<std::future<void>> futures;
+	futures.reserve(parts - 1);
+	std::size_t begin = 0;
+	for (std::size_t p = 0; p + 1 < parts; ++p)
+	{
+		std::size_t end = begin + per + (p < extra ? 1 : 0);
+		futures.push_back(ex.Submit([&work, begin, end]() {
+			for (std::size_t i = begin; i < end; ++i)
+				work(i);
+		}));
+		begin = end;
+	}
+	std::exception_ptr error;
+	try {
+		for (std::size_t i = begin; i < count; ++i)
+			work(i);
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+	/*every part must finish before work goes out of scope.*/
+	for (auto& f : futures)
+	{
+		try {
+			f.get();
+		}
+		catch (...)
+		{
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
+}
+
+StreamHash::StreamHash(HashKind kind)
+{
+	if (kind == HashKind::SHA512)
+		m_hash = &m_sha512;
+	else
+		m_hash = &m_sha256;
+}
+
+StreamHash::StreamHash(HashKind kind, const CryptoPP::SecByteBlock & salt)
+	:StreamHash(kind)
+{
+	m_salt = salt;
+	m_hash->Update(m_salt, m_salt.size());
+}
+
+void StreamHash::Update(const char * data, std::size_t size)
+{
+	m_hash->Update((const byte*)data, size);
+}
+
+void StreamHash::Update(const cg::ArrayView & data)
+{
+	Update(data.data(), data.size());
+}
+
+bool StreamHash::Update(cg::File & file, std::size_t chunkSize)
+{
+	if (chunkSize == 0)
+		chunkSize = ms_defaultChunkSize;
+	std::size_t size = file.Size();
+	std::vector<char> chunk(std::min(size, chunkSize));
+	for (std::size_t pos = 0; pos < size; pos += chunk.size())
+	{
+		std::size_t amt = std::min(chunk.size(), size - pos);
+		if (!file.Read(chunk.data(), amt, (std::ptrdiff_t)pos))
+			return false;
+		Update(chunk.data(), amt);
+	}
+	return true;
+}
+
+CryptoPP::SecByteBlock StreamHash::Final()
+{
+	CryptoPP::SecByteBlock digest(m_hash->DigestSize());
+	m_hash->Final(digest);
+	if (m_salt.size() != 0)
+		m_hash->Update(m_salt, m_salt.size());
+	return digest;
+}
+
+void StreamHash::Restart()
+{
+	m_hash->Restart();
+	if (m_salt.size() != 0)
+		m_hash->Update(m_salt, m_salt.size());
+}
+
+std::size_t StreamHash::DigestSize() const
+{
+	return m_hash->DigestSize();
+}
+
+
 CryptoPP::SecByteBlock SecureHelpers::CopySecByteBlock(
 	const CryptoPP::SecByteBlock & b)
 {
@@ -29,6 +155,30 @@ void SecureHelpers::HashIt256(HashData & hashData)
 	hashData.m_data.CleanNew(hash.DIGESTSIZE);
 	hash.Final(hashData.m_data);
 }
+std::vector<CryptoPP::SecByteBlock> SecureHelpers::HashBatch(
+	const std::vector<cg::ArrayView>& buffers,
+	HashKind kind)
+{
+	std::vector<CryptoPP::SecByteBlock> digests(buffers.size());
+	ParallelFor(buffers.size(), [&](std::size_t i) {
+		StreamHash hash(kind);
+		hash.Update(buffers[i]);
+		digests[i] = hash.Final();
+	});
+	return digests;
+}
+void SecureHelpers::HashIt256(std::vector<HashData>& batch)
+{
+	ParallelFor(batch.size(), [&](std::size_t i) {
+		HashIt256(batch[i]);
+	});
+}
+void SecureHelpers::HashIt512(std::vector<HashData>& batch)
+{
+	ParallelFor(batch.size(), [&](std::size_t i) {
+		HashIt512(batch[i]);
+	});
+}
 CryptoPP::SecByteBlock SecureHelpers::GetSaltData(int amt)
 {
 	CryptoPP::AutoSeededRandomPool rng;
@@ -197,8 +347,14 @@ void SecureHelpers::AESDecrypt(char * dest,
 CryptoPP::SecByteBlock SecureHelpers::MakeAESKey()
 {
 	CryptoPP::AutoSeededRandomPool rnd;
+	return MakeAESKey(rnd);
+}
+
+CryptoPP::SecByteBlock SecureHelpers::MakeAESKey(
+	CryptoPP::RandomNumberGenerator & rng)
+{
 	CryptoPP::SecByteBlock key(0x00, ms_defaultAesKeySize);
-	rnd.GenerateBlock(key, key.size());
+	rng.GenerateBlock(key, key.size());
 	return key;
 }
 
@@ -224,14 +380,78 @@ CryptoPP::SecByteBlock SecureHelpers::MakeAESKey(const std::string & pass,
 CryptoPP::SecByteBlock SecureHelpers::MakeAESIv()
 {
 	CryptoPP::AutoSeededRandomPool rnd;
+	return MakeAESIv(rnd);
+}
+
+CryptoPP::SecByteBlock SecureHelpers::MakeAESIv(
+	CryptoPP::RandomNumberGenerator & rng)
+{
 	CryptoPP::SecByteBlock iv(ms_defaultIvSize);
-	rnd.GenerateBlock(iv, iv.size());
+	rng.GenerateBlock(iv, iv.size());
 	return iv;
 }
 
+CryptoPP::SecByteBlock SecureHelpers::AESDirectionIv(
+	const CryptoPP::SecByteBlock & iv,
+	bool toClient)
+{
+	if (iv.size() == 0)
+		throw EncryptionException(EncryptionException::Code::BadIv);
+	CryptoPP::SecByteBlock dIv = CopySecByteBlock(iv);
+	/*the counter counts up from the low bytes, so flipping the top bit puts
+	the two directions 2^127 blocks apart.*/
+	if (!toClient)
+		dIv[0] ^= 0x80;
+	return dIv;
+}
+
+void SecureHelpers::MakeX25519Keys(CryptoPP::SecByteBlock & priv,
+	CryptoPP::SecByteBlock & pub)
+{
+	CryptoPP::AutoSeededRandomPool rng;
+	CryptoPP::x25519 ecdh;
+	priv.New(ecdh.PrivateKeyLength());
+	pub.New(ecdh.PublicKeyLength());
+	ecdh.GenerateKeyPair(rng, priv, pub);
+}
+
+CryptoPP::SecByteBlock SecureHelpers::X25519Agree(
+	const CryptoPP::SecByteBlock & priv,
+	const CryptoPP::SecByteBlock & peerPub)
+{
+	CryptoPP::x25519 ecdh;
+	if (priv.size() != ecdh.PrivateKeyLength()
+		|| peerPub.size() != ecdh.PublicKeyLength())
+		throw EncryptionException(EncryptionException::Code::BadKey);
+	CryptoPP::SecByteBlock shared(ecdh.AgreedValueLength());
+	/*Agree checks the peer key, so small order points are refused here.*/
+	if (!ecdh.Agree(shared, priv, peerPub))
+		throw EncryptionException(EncryptionException::Code::BadKey);
+	return shared;
+}
+
+CryptoPP::SecByteBlock SecureHelpers::DeriveKey(
+	const CryptoPP::SecByteBlock & secret,
+	const CryptoPP::SecByteBlock & salt,
+	const std::string & info,
+	std::size_t size)
+{
+	CryptoPP::HKDF<CryptoPP::SHA256> hkdf;
+	CryptoPP::SecByteBlock out(size);
+	hkdf.DeriveKey(out, out.size(), secret, secret.size(), salt, salt.size(),
+		(const byte*)info.data(), info.size());
+	return out;
+}
+
 KeyPair SecureHelpers::MakeRSAKeys(uint16_t size)
 {
 	CryptoPP::AutoSeededRandomPool rng;
+	return MakeRSAKeys(rng, size);
+}
+
+KeyPair SecureHelpers::MakeRSAKeys(CryptoPP::RandomNumberGenerator & rng,
+	uint16_t size)
+{
 	CryptoPP::InvertibleRSAFunction params;
 	params.GenerateRandomWithKeySize(rng, size);
 	auto ret = KeyPair(params);
@@ -311,6 +531,10 @@ std::string EncryptionException::ToString() const
 		return "There is no data to encrypt.";
 	case cg::EncryptionException::AlreadyExists:
 		return "The store location already exists.";
+	case cg::EncryptionException::BadMem:
+		return "The destination is too small.";
+	case cg::EncryptionException::AuthFailed:
+		return "The data failed authentication.";
 	default:
 		return "Unknown issue.";
 	}
@@ -13,9 +13,15 @@
 #include <cryptopp/hex.h>
 #include <cryptopp/cryptlib.h>
 #include <cryptopp/secblock.h>
+#include <cryptopp/hkdf.h>
+#include <cryptopp/xed25519.h>
 
+#include <vector>
+
+#include "../ArrayView.hpp"
 #include "../exception.hpp"
 #include "../Memory.hpp"
+#include "../NoCopyMove.hpp"
 
 
 namespace cg {
@@ -36,6 +42,8 @@ public:
 		AlreadyExists,
 		/**Destination to small*/
 		BadMem,
+		/**The authentication tag did not match.*/
+		AuthFailed,
 
 	};
 	/**Create the Exception
@@ -61,6 +69,67 @@ struct HashData
 	CryptoPP::SecByteBlock m_salt;
 };
 
+/**The hash functions a StreamHash can run.*/
+enum class HashKind
+{
+	/**SHA-256, 32 byte digests.*/
+	SHA256,
+	/**SHA-512, 64 byte digests.*/
+	SHA512,
+};
+
+class File;
+
+/**A hash that is fed a piece at a time.
+
+Update can be called any amount of times, with memory or with a cg::File that
+is read in chunks, so large inputs never have to be in memory at once.  Final
+gives the digest and restarts the context for reuse.*/
+class StreamHash : private cg::NoCopy
+{
+public:
+	/**Create an unsalted context.
+	\param kind The hash to run.*/
+	StreamHash(HashKind kind = HashKind::SHA256);
+	/**Create a salted context. The salt is hashed first, the same way
+	SecureHelpers::HashIt256 and HashIt512 do it.
+	\param kind The hash to run.
+	\param salt The salt.*/
+	StreamHash(HashKind kind, const CryptoPP::SecByteBlock& salt);
+	/**Feed some data.
+	\param data The data.
+	\param size The size of the data.*/
+	void Update(const char* data, std::size_t size);
+	/**Feed some data.
+	\param data The data.*/
+	void Update(const cg::ArrayView& data);
+	/**Feed a whole file a chunk at a time.
+	\param file The file to read.
+	\param chunkSize The amount to read at once.
+	\return False if a read failed. What was read so far stays hashed.*/
+	bool Update(cg::File& file, std::size_t chunkSize = ms_defaultChunkSize);
+	/**Finish the hash and restart the context.  A salt given at creation is
+	fed again.
+	\return The digest.*/
+	CryptoPP::SecByteBlock Final();
+	/**Throw away what was fed so far.*/
+	void Restart();
+	/**Get the size of the digests.
+	\return The digest size in bytes.*/
+	std::size_t DigestSize() const;
+	/**The default amount read from a file at once.*/
+	const static std::size_t ms_defaultChunkSize = 1 << 20;
+private:
+	/**The SHA-256 state.*/
+	CryptoPP::SHA256 m_sha256;
+	/**The SHA-512 state.*/
+	CryptoPP::SHA512 m_sha512;
+	/**The one in use.*/
+	CryptoPP::HashTransformation* m_hash;
+	/**The salt to feed first. May be empty.*/
+	CryptoPP::SecByteBlock m_salt;
+};
+
 /**The result of an AES encryption and key gen*/
 struct AESData
 {
@@ -130,6 +199,21 @@ public:
 	\param hashData A HashData with the salt and data to be hasehd. If the salt
 	is empty, it will be generated with the default size.*/
 	static void HashIt256(HashData& hashData);
+	/**Hash many independent buffers across the shared executor.  The hashes
+	are unsalted so equal buffers give equal digests.
+	\param buffers The buffers to hash. They must stay valid until the call
+	returns.
+	\param kind The hash to run.
+	\return The digests in the same order as the buffers.*/
+	static std::vector<CryptoPP::SecByteBlock> HashBatch(
+		const std::vector<cg::ArrayView>& buffers,
+		HashKind kind = HashKind::SHA256);
+	/**Run HashIt256 over many HashData across the shared executor.
+	\param batch The data to hash. Each is hashed in place.*/
+	static void HashIt256(std::vector<HashData>& batch);
+	/**Run HashIt512 over many HashData across the shared executor.
+	\param batch The data to hash. Each is hashed in place.*/
+	static void HashIt512(std::vector<HashData>& batch);
 	/**Get salty.
 	\param amt The amount of bytes to make the salt.
 	\return A secByteBlock That is the salt.*/
@@ -227,6 +311,11 @@ public:
 	/**Generate a random AES key with the max key length.
 	\return The key in the form of a secbyteblock.*/
 	static CryptoPP::SecByteBlock MakeAESKey();
+	/**Generate a random AES key with the max key length.
+	\param rng The generator to draw from.
+	\return The key in the form of a secbyteblock.*/
+	static CryptoPP::SecByteBlock MakeAESKey(
+		CryptoPP::RandomNumberGenerator& rng);
 	/**Create a sec byte block from a string.
 	\param str The string to make into a secbyteblock.
 	\return A SecByteBlock that is equal to the string supplied.*/
@@ -242,9 +331,55 @@ public:
 	/**Generate a random AES IV.
 	\return The IV in the form of a secbyteblock.*/
 	static CryptoPP::SecByteBlock MakeAESIv();
+	/**Generate a random AES IV.
+	\param rng The generator to draw from.
+	\return The IV in the form of a secbyteblock.*/
+	static CryptoPP::SecByteBlock MakeAESIv(
+		CryptoPP::RandomNumberGenerator& rng);
+	/**Get the starting counter for one direction of a session that shares a
+	single key and IV.  Each direction gets its own counter range so the two
+	streams never reuse keystream.
+	\param iv The session IV.
+	\param toClient True for data sent by the server to the client, false
+	for data sent by the client to the server.
+	\return The IV to key the cipher for that direction with.*/
+	static CryptoPP::SecByteBlock AESDirectionIv(
+		const CryptoPP::SecByteBlock& iv,
+		bool toClient);
+	/**Create an X25519 key pair for a single key agreement.
+	\param priv Will hold the private key.
+	\param pub Will hold the public key to send to the peer.*/
+	static void MakeX25519Keys(CryptoPP::SecByteBlock& priv,
+		CryptoPP::SecByteBlock& pub);
+	/**Agree on a shared secret with a peer.
+	\param priv Our private key from MakeX25519Keys.
+	\param peerPub The public key the peer sent.
+	\return The shared secret. Run it through DeriveKey before using it.
+	\throws cg::EncryptionException BadKey if either key is the wrong size or
+	the peer key is a weak point.*/
+	static CryptoPP::SecByteBlock X25519Agree(
+		const CryptoPP::SecByteBlock& priv,
+		const CryptoPP::SecByteBlock& peerPub);
+	/**Derive key material from a shared secret with HKDF-SHA256.
+	\param secret The shared secret.
+	\param salt The salt. May be empty.
+	\param info What the key is for, so different uses get different keys.
+	\param size The amount of bytes to derive.
+	\return The derived bytes.*/
+	static CryptoPP::SecByteBlock DeriveKey(
+		const CryptoPP::SecByteBlock& secret,
+		const CryptoPP::SecByteBlock& salt,
+		const std::string& info,
+		std::size_t size);
 	/**Create an RSA key. A pair of keys.
 	\return The pair of keys*/
 	static KeyPair MakeRSAKeys(uint16_t size = ms_defaultRSASize);
+	/**Create an RSA key. A pair of keys.
+	\param rng The generator to draw from.
+	\param size The size of the modulus in bits.
+	\return The pair of keys*/
+	static KeyPair MakeRSAKeys(CryptoPP::RandomNumberGenerator& rng,
+		uint16_t size = ms_defaultRSASize);
 	/**Create and store RSA keys.
 	\param path The path to save the keys.
 	\param size The size of the keys to make.
@@ -278,6 +413,10 @@ public:
 	const static int ms_defaultAesKeySize = 32;
 	/**The default iv size*/
 	const static int ms_defaultIvSize = 16;
+	/**The size of an X25519 public or private key.*/
+	const static int ms_x25519KeySize = 32;
+	/**Below this many items a batch is hashed on the calling thread.*/
+	const static std::size_t ms_minParallelBatch = 16;
 	/**Default rsa size*/
 	const static int ms_defaultRSASize = 2048;
 	/**The cipher text size for an rsa with default values.*/
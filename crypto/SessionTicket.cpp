@@ -0,0 +1,142 @@
+#include "SessionTicket.hpp"
+
+namespace cg {
+
+const std::size_t SessionTicketKeys::ms_nonceSize;
+const std::size_t SessionTicketKeys::ms_tagSize;
+
+namespace {
+/**The size of the key id in front of a ticket.*/
+const std::size_t g_idSize = 4;
+/**The size of the issue time inside a ticket.*/
+const std::size_t g_timeSize = 8;
+}
+
+SessionTicketKeys::SessionTicketKeys(std::chrono::seconds lifetime)
+	:m_lifetime(lifetime)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	DoRotate();
+}
+
+std::string SessionTicketKeys::Seal(const CryptoPP::SecByteBlock & secret)
+{
+	CryptoPP::SecByteBlock key;
+	uint32_t id;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		RotateIfDue();
+		key = m_current.m_key;
+		id = m_current.m_id;
+	}
+	CryptoPP::SecByteBlock plain(g_timeSize + secret.size());
+	uint64_t now = Now();
+	for (std::size_t i = 0; i < g_timeSize; ++i)
+		plain[i] = (byte)(now >> (8 * i));
+	std::memcpy(plain.data() + g_timeSize, secret.data(), secret.size());
+
+	std::string ticket(g_idSize + ms_nonceSize + plain.size() + ms_tagSize,
+		'\0');
+	byte* out = (byte*)&ticket[0];
+	for (std::size_t i = 0; i < g_idSize; ++i)
+		out[i] = (byte)(id >> (8 * i));
+	byte* nonce = out + g_idSize;
+	CryptoPP::AutoSeededRandomPool rng;
+	rng.GenerateBlock(nonce, ms_nonceSize);
+	byte* body = nonce + ms_nonceSize;
+
+	CryptoPP::GCM<CryptoPP::AES>::Encryption gcm;
+	gcm.SetKeyWithIV(key, key.size(), nonce, ms_nonceSize);
+	/*the key id is authenticated too, so it can not be swapped.*/
+	gcm.EncryptAndAuthenticate(body, body + plain.size(), ms_tagSize,
+		nonce, ms_nonceSize, out, g_idSize, plain, plain.size());
+	return ticket;
+}
+
+bool SessionTicketKeys::Open(const char * data, std::size_t size,
+	CryptoPP::SecByteBlock & secret)
+{
+	const std::size_t overhead = g_idSize + ms_nonceSize + ms_tagSize;
+	if (size <= overhead + g_timeSize)
+		return false;
+	const byte* in = (const byte*)data;
+	uint32_t id = 0;
+	for (std::size_t i = 0; i < g_idSize; ++i)
+		id |= (uint32_t)in[i] << (8 * i);
+	CryptoPP::SecByteBlock key;
+	std::chrono::seconds lifetime;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		RotateIfDue();
+		if (id == m_current.m_id)
+			key = m_current.m_key;
+		else if (id == m_previous.m_id && m_previous.m_key.size() != 0)
+			key = m_previous.m_key;
+		else
+			return false;
+		lifetime = m_lifetime;
+	}
+	const byte* nonce = in + g_idSize;
+	const byte* body = nonce + ms_nonceSize;
+	std::size_t bodySize = size - overhead;
+	CryptoPP::SecByteBlock plain(bodySize);
+
+	CryptoPP::GCM<CryptoPP::AES>::Decryption gcm;
+	gcm.SetKeyWithIV(key, key.size(), nonce, ms_nonceSize);
+	if (!gcm.DecryptAndVerify(plain, body + bodySize, ms_tagSize,
+		nonce, ms_nonceSize, in, g_idSize, body, bodySize))
+		return false;
+
+	uint64_t issued = 0;
+	for (std::size_t i = 0; i < g_timeSize; ++i)
+		issued |= (uint64_t)plain[i] << (8 * i);
+	uint64_t now = Now();
+	if (issued > now || now - issued > (uint64_t)lifetime.count())
+		return false;
+	secret.Assign(plain.data() + g_timeSize, plain.size() - g_timeSize);
+	return true;
+}
+
+void SessionTicketKeys::Rotate()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	DoRotate();
+}
+
+void SessionTicketKeys::Lifetime(std::chrono::seconds lifetime)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_lifetime = lifetime;
+}
+
+std::chrono::seconds SessionTicketKeys::Lifetime() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_lifetime;
+}
+
+void SessionTicketKeys::RotateIfDue()
+{
+	if (std::chrono::steady_clock::now() - m_current.m_created >= m_lifetime)
+		DoRotate();
+}
+
+void SessionTicketKeys::DoRotate()
+{
+	m_previous = m_current;
+	m_current.m_key = cg::SecureHelpers::MakeAESKey();
+	m_current.m_created = std::chrono::steady_clock::now();
+	/*random ids so tickets from before a restart are refused up front.*/
+	CryptoPP::AutoSeededRandomPool rng;
+	do {
+		rng.GenerateBlock((byte*)&m_current.m_id, sizeof(m_current.m_id));
+	} while (m_current.m_id == m_previous.m_id);
+}
+
+uint64_t SessionTicketKeys::Now()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}
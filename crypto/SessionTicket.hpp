@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include <cryptopp/aes.h>
+#include <cryptopp/gcm.h>
+
+#include "SecureHelpers.hpp"
+#include "../NoCopyMove.hpp"
+
+namespace cg {
+
+/**The keys a server seals its session tickets with.
+
+A ticket holds a resumption secret and the time it was issued, AES-GCM sealed
+under the current ticket key.  Only the server can open it, so the client
+just keeps it and hands it back when it reconnects.  The key rotates once per
+lifetime.  The key before it is kept, so a ticket stays usable for a full
+lifetime no matter when in the rotation it was issued.*/
+class SessionTicketKeys : private cg::NoCopy
+{
+public:
+	/**Create the keys.
+	\param lifetime How long a ticket is good for. The ticket key rotates at
+	the same rate.*/
+	SessionTicketKeys(std::chrono::seconds lifetime = std::chrono::hours(12));
+	/**Seal a resumption secret into a ticket.
+	\param secret The secret to seal.
+	\return The ticket to send to the client.*/
+	std::string Seal(const CryptoPP::SecByteBlock& secret);
+	/**Open a ticket.
+	\param data The ticket.
+	\param size The size of the ticket.
+	\param secret Will hold the resumption secret if the ticket is good.
+	\return True if the ticket was opened. False if it is expired, was sealed
+	with a retired key, or was tampered with.*/
+	bool Open(const char* data, std::size_t size,
+		CryptoPP::SecByteBlock& secret);
+	/**Retire the current key now. Tickets from the key before it stop
+	working.*/
+	void Rotate();
+	/**Change how long tickets are good for.
+	\param lifetime The new lifetime.*/
+	void Lifetime(std::chrono::seconds lifetime);
+	/**Get how long tickets are good for.
+	\return The lifetime.*/
+	std::chrono::seconds Lifetime() const;
+	/**The size of the ticket nonce.*/
+	const static std::size_t ms_nonceSize = 12;
+	/**The size of the ticket tag.*/
+	const static std::size_t ms_tagSize = 16;
+private:
+	/**One ticket key.*/
+	struct Key
+	{
+		/**The id that is sent in front of tickets sealed with this key.*/
+		uint32_t m_id = 0;
+		/**The AES key.*/
+		CryptoPP::SecByteBlock m_key;
+		/**When the key was made.*/
+		std::chrono::steady_clock::time_point m_created;
+	};
+	/**Rotate the keys if the current one is older than the lifetime.  The
+	mutex must be held.*/
+	void RotateIfDue();
+	/**Rotate the keys.  The mutex must be held.*/
+	void DoRotate();
+	/**The seconds sense epoch right now.
+	\return The time.*/
+	static uint64_t Now();
+	/**Guards the keys.*/
+	mutable std::mutex m_mutex;
+	/**The key new tickets are sealed with.*/
+	Key m_current;
+	/**The key before the current one. Still opens tickets.*/
+	Key m_previous;
+	/**How long a ticket is good for.*/
+	std::chrono::seconds m_lifetime;
+};
+
+}
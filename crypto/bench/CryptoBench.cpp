@@ -0,0 +1,291 @@
+/**Crypto throughput benchmark.
+
+Prints one JSON object per line so runs can be saved and compared by a script:
+	{"bench":"filter","name":"AESEncryptFilter","size":1024,"mb_per_s":812.40}
+	{"bench":"handshake","name":"X25519","per_s":1450.12}
+	{"bench":"keyexchange","name":"X25519","per_s":9120.55}
+	{"bench":"hash","name":"SHA256","size":16384,"mb_per_s":402.77}
+	{"bench":"keypool","name":"rsa","hits":4,"misses":9}
+
+Build it with CryptoBench.vcxproj, which compiles the library sources and
+links Crypto++, then run
+	CryptoBench [seconds per case] [port]
+The keyexchange cases time the key exchange calls of one handshake with no
+sockets.  The handshake cases start an ISecServerMT on the port, 55899 by
+default, so it must be free.*/
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../../Timer.hpp"
+#include "../AESFilter.hpp"
+#include "../GCMFilter.hpp"
+#include "../KeyPool.hpp"
+#include "../RSAFilter.hpp"
+#include "../SecureHelpers.hpp"
+#include "../../net/ISecServerMT.hpp"
+
+namespace {
+
+/**How long each case runs, in seconds.*/
+double g_seconds = 0.5;
+/**The message sizes the symmetric filters and hashes are run at.*/
+const std::size_t g_sizes[] = { 64, 1024, 16 * 1024, 1024 * 1024 };
+/**The port the handshake server listens on.*/
+uint16_t g_port = 55899;
+/**The speed of the server loops in the handshake cases.  The default of 100
+FPS would set the pace instead of the crypto.*/
+const double g_loopFps = 100000;
+/**The most bytes of sealed messages the GCM decrypt case keeps.*/
+const std::size_t g_ringBytes = 16 * 1024 * 1024;
+
+/**Call something over and over for g_seconds.
+\param call The thing to call.
+\return The amount of calls per second.*/
+template<typename Call>
+double Rate(Call&& call)
+{
+	/*once to warm up caches and key schedules.*/
+	call();
+	cg::Timer timer;
+	std::size_t count = 0;
+	double elapsed = 0;
+	do {
+		call();
+		++count;
+		elapsed = timer.GetTime().count();
+	} while (elapsed < g_seconds);
+	return count / elapsed;
+}
+
+/**Print a throughput line.
+\param bench The group.
+\param name The thing measured.
+\param size The size of each call in bytes.
+\param perSec The calls per second.*/
+void PrintThroughput(const char* bench, const std::string& name,
+	std::size_t size, double perSec)
+{
+	std::printf("{\"bench\":\"%s\",\"name\":\"%s\",\"size\":%zu,"
+		"\"mb_per_s\":%.2f}\n", bench, name.c_str(), size,
+		perSec * size / (1024.0 * 1024.0));
+	std::fflush(stdout);
+}
+
+/**Print a rate line.
+\param bench The group.
+\param name The thing measured.
+\param perSec The calls per second.*/
+void PrintRate(const char* bench, const std::string& name, double perSec)
+{
+	std::printf("{\"bench\":\"%s\",\"name\":\"%s\",\"per_s\":%.2f}\n",
+		bench, name.c_str(), perSec);
+	std::fflush(stdout);
+}
+
+/**Print the hit and miss counts of a key pool stock.
+\param name The stock.
+\param stats The counts.*/
+void PrintPool(const std::string& name, const cg::KeyPool::Stats& stats)
+{
+	std::printf("{\"bench\":\"keypool\",\"name\":\"%s\",\"hits\":%zu,"
+		"\"misses\":%zu}\n", name.c_str(), stats.m_hits, stats.m_misses);
+	std::fflush(stdout);
+}
+
+/**Measure the filters SocketRW runs on every message.*/
+void BenchFilters()
+{
+	auto key = cg::SecureHelpers::MakeAESKey();
+	auto iv = cg::SecureHelpers::MakeAESIv();
+	for (auto size : g_sizes)
+	{
+		std::vector<char> buffer(size, 'x');
+		cg::AESEncryptFilter ctrEnc(key, iv);
+		PrintThroughput("filter", "AESEncryptFilter", size, Rate([&]() {
+			ctrEnc.Transform(buffer.data(), buffer.size());
+		}));
+		cg::AESDecryptFilter ctrDec(key, iv);
+		PrintThroughput("filter", "AESDecryptFilter", size, Rate([&]() {
+			ctrDec.Transform(buffer.data(), buffer.size());
+		}));
+		/*SocketRW always writes through TransformCopy, so the allocation
+		is part of the cost.*/
+		cg::AESGCMEncryptFilter gcmEnc(key, iv);
+		PrintThroughput("filter", "AESGCMEncryptFilter", size, Rate([&]() {
+			gcmEnc.TransformCopy(buffer.data(), buffer.size());
+		}));
+		/*the decryptor has to see messages in the order they were sealed,
+		so a ring of them is sealed up front and the context is rekeyed
+		each lap.*/
+		std::size_t ring = g_ringBytes / size;
+		if (ring > 4096)
+			ring = 4096;
+		if (ring == 0)
+			ring = 1;
+		cg::AESGCMEncryptFilter sealer(key, iv);
+		std::vector<cg::ArrayView> sealed;
+		sealed.reserve(ring);
+		for (std::size_t i = 0; i < ring; ++i)
+			sealed.push_back(sealer.TransformCopy(buffer.data(),
+				buffer.size()));
+		cg::AESGCMDecryptFilter::Context gcmCtx(key, iv);
+		cg::AESGCMDecryptFilter gcmDec(gcmCtx);
+		std::size_t next = 0;
+		PrintThroughput("filter", "AESGCMDecryptFilter", size, Rate([&]() {
+			if (next == ring)
+			{
+				gcmCtx.Key(key, iv);
+				next = 0;
+			}
+			auto& msg = sealed[next++];
+			gcmDec.TransformCopy(msg.data(), msg.size());
+		}));
+	}
+	/*RSA can only take one small block at a time.*/
+	auto keys = cg::SecureHelpers::MakeRSAKeys();
+	std::vector<char> block(64, 'x');
+	cg::RSAEncryptFilter rsaEnc(keys);
+	PrintThroughput("filter", "RSAEncryptFilter", block.size(), Rate([&]() {
+		rsaEnc.TransformCopy(block.data(), block.size());
+	}));
+	auto sealed = rsaEnc.TransformCopy(block.data(), block.size());
+	cg::RSADecryptFilter rsaDec(keys);
+	PrintThroughput("filter", "RSADecryptFilter", block.size(), Rate([&]() {
+		rsaDec.TransformCopy(sealed.data(), sealed.size());
+	}));
+}
+
+/**Measure the hashes.*/
+void BenchHashes()
+{
+	for (auto size : g_sizes)
+	{
+		std::vector<char> buffer(size, 'x');
+		cg::StreamHash sha256(cg::HashKind::SHA256);
+		PrintThroughput("hash", "SHA256", size, Rate([&]() {
+			sha256.Update(buffer.data(), buffer.size());
+			sha256.Final();
+		}));
+		cg::StreamHash sha512(cg::HashKind::SHA512);
+		PrintThroughput("hash", "SHA512", size, Rate([&]() {
+			sha512.Update(buffer.data(), buffer.size());
+			sha512.Final();
+		}));
+		/*HashIt256 makes a new salt every call.*/
+		PrintThroughput("hash", "HashIt256", size, Rate([&]() {
+			cg::HashData data;
+			data.m_data.Assign((const byte*)buffer.data(), buffer.size());
+			cg::SecureHelpers::HashIt256(data);
+		}));
+	}
+	const std::size_t records = 1024;
+	const std::size_t recordSize = 4096;
+	std::vector<char> store(records * recordSize, 'x');
+	std::vector<cg::ArrayView> views;
+	for (std::size_t i = 0; i < records; ++i)
+		views.emplace_back(store.data() + i * recordSize, recordSize);
+	PrintThroughput("hash", "HashBatch.SHA256", store.size(), Rate([&]() {
+		cg::SecureHelpers::HashBatch(views);
+	}));
+}
+
+/**A server that accepts everyone and throws away what it gets.*/
+class BenchServer : public cg::net::ISecServerMT
+{
+public:
+	BenchServer() :ISecServerMT(1) {}
+	~BenchServer() { Stop(); }
+	/**Start, then lift the loop speeds.  Start sets them back to the
+	defaults, so it has to be after.
+	\param port The port to listen on.*/
+	void StartFast(uint16_t port)
+	{
+		Start(port);
+		ChangeAcceptorSpeed(g_loopFps);
+		ChangeScannerSpeed(g_loopFps);
+	}
+	bool SecSocketAccepted(cg::net::Socket& sock) override
+	{
+		return true;
+	}
+	bool SecProcessSocket(cg::net::Socket& sock) override
+	{
+		GetSocketRW(sock).Read();
+		return true;
+	}
+	void SecSocketClosed(cg::net::Socket& sock, bool grace) override {}
+};
+
+/**Connect, handshake and hang up.
+\param protocol The key exchange.
+\param ticket A ticket to resume with, or null.*/
+void Connect(cg::net::SecProtocol protocol,
+	cg::net::SessionTicket* ticket = nullptr)
+{
+	auto sp = cg::net::ISecServerMT::GetConnected("::1", g_port, protocol,
+		ticket);
+	sp.m_socket->Close();
+	sp.Delete();
+}
+
+/**Measure the key exchange of one handshake, both sides, with no sockets.*/
+void BenchKeyExchange()
+{
+	auto keys = cg::SecureHelpers::MakeRSAKeys();
+	auto session = cg::SecureHelpers::GetSaltData(32 + 16);
+	PrintRate("keyexchange", "RSA", Rate([&]() {
+		auto sealed = cg::SecureHelpers::RSAEncrypt(session,
+			keys.m_public);
+		cg::SecureHelpers::RSADecrypt(sealed, keys.m_private);
+	}));
+	CryptoPP::SecByteBlock salt;
+	PrintRate("keyexchange", "X25519", Rate([&]() {
+		CryptoPP::SecByteBlock clientPriv, clientPub, serverPriv, serverPub;
+		cg::SecureHelpers::MakeX25519Keys(clientPriv, clientPub);
+		cg::SecureHelpers::MakeX25519Keys(serverPriv, serverPub);
+		auto a = cg::SecureHelpers::X25519Agree(serverPriv, clientPub);
+		auto b = cg::SecureHelpers::X25519Agree(clientPriv, serverPub);
+		cg::SecureHelpers::DeriveKey(a, salt, "bench", 32 + 16);
+		cg::SecureHelpers::DeriveKey(b, salt, "bench", 32 + 16);
+	}));
+}
+
+/**Measure full connections through ISecServerMT for each key exchange.*/
+void BenchHandshakes()
+{
+	BenchServer server;
+	server.StartFast(g_port);
+	PrintRate("handshake", "RSA", Rate([&]() {
+		Connect(cg::net::SecProtocol::RSA);
+	}));
+	PrintRate("handshake", "X25519", Rate([&]() {
+		Connect(cg::net::SecProtocol::X25519);
+	}));
+	cg::net::SessionTicket ticket;
+	PrintRate("handshake", "Resume", Rate([&]() {
+		Connect(cg::net::SecProtocol::X25519, &ticket);
+	}));
+	auto& pool = cg::KeyPool::Shared();
+	PrintPool("rsa", pool.RSAStats());
+	PrintPool("aeskey", pool.AESKeyStats());
+	PrintPool("aesiv", pool.AESIvStats());
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1)
+		g_seconds = std::atof(argv[1]);
+	if (g_seconds <= 0)
+		g_seconds = 0.5;
+	if (argc > 2)
+		g_port = (uint16_t)std::atoi(argv[2]);
+	BenchFilters();
+	BenchHashes();
+	BenchKeyExchange();
+	BenchHandshakes();
+	return 0;
+}
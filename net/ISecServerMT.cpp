@@ -2,41 +2,189 @@
 
 namespace cg {
 namespace net {
+const std::size_t ISecServerMT::ms_handshakeTimeout;
+const std::ptrdiff_t ISecServerMT::ms_handshakePoll;
+const std::size_t ISecServerMT::ms_maxHello;
+const std::size_t ISecServerMT::ms_resumeNonceSize;
+
+ISecServerMT::ISecServerMT(int dataThreads, SecCipher cipher,
+	std::size_t handshakeThreads, std::size_t maxHandshakes,
+	std::size_t maxClients)
+	:IServerMT(dataThreads, maxClients),
+	m_maxHandshakes(maxHandshakes == 0 ? 1 : maxHandshakes),
+	/*each handshake has at most one step queued, so the queue never fills.*/
+	m_handshakePool(handshakeThreads == 0 ? 1 : handshakeThreads,
+		maxHandshakes == 0 ? 1 : maxHandshakes)
+{
+	m_cipher = cipher;
+	m_minProtocol = SecProtocol::RSA;
+	m_activeHandshakes = 0;
+	m_handshaking = true;
+}
 ISecServerMT::~ISecServerMT()
 {
-
+	/*queued steps will see this and drop their sockets.*/
+	m_handshaking = false;
+	m_handshakePool.Stop();
+}
+void ISecServerMT::Stop()
+{
+	/*steps that run from now on drop their sockets, and the ones past that
+	check are waited for.*/
+	m_handshaking = false;
+	while (m_activeHandshakes != 0)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	IServerMT::Stop();
+	/*the accept thread is joined, so nothing can start one now.*/
+	while (m_activeHandshakes != 0)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	m_handshaking = true;
+}
+void ISecServerMT::SessionCipher(SecCipher cipher)
+{
+	m_cipher = cipher;
+}
+SecCipher ISecServerMT::SessionCipher() const
+{
+	return m_cipher;
+}
+void ISecServerMT::MinProtocol(SecProtocol protocol)
+{
+	m_minProtocol = protocol;
+}
+SecProtocol ISecServerMT::MinProtocol() const
+{
+	return m_minProtocol;
+}
+cg::SessionTicketKeys & ISecServerMT::TicketKeys()
+{
+	return m_tickets;
+}
+std::size_t ISecServerMT::PendingHandshakes() const
+{
+	return m_activeHandshakes;
 }
 SocketRW ISecServerMT::GetSocketRW(Socket & sock)
 {
-	auto& cd = m_secClients.Writer()->at(sock.Id());
+	auto& cd = m_secClients.At(sock.Id());
+	if (cd.m_cipher == SecCipher::AESGCM)
+	{
+		SocketRW rw(&sock,
+			cg::New<AESGCMEncryptFilter>(__FUNCSTR__, cd.m_gcmEncryptor),
+			cg::New<AESGCMDecryptFilter>(__FUNCSTR__, cd.m_gcmDecryptor));
+		return rw;
+	}
 	SocketRW rw(&sock,
-		cg::New<AESEncryptFilter>(__FUNCSTR__, cd.m_aesKey, cd.m_aesIv),
-		cg::New<AESDecryptFilter>(__FUNCSTR__, cd.m_aesKey, cd.m_aesIv));
+		cg::New<AESEncryptFilter>(__FUNCSTR__, cd.m_encryptor),
+		cg::New<AESDecryptFilter>(__FUNCSTR__, cd.m_decryptor));
 	return rw;
 }
 
 SocketPair
-ISecServerMT::GetConnected(const std::string & address, uint16_t port)
+ISecServerMT::GetConnected(const std::string & address, uint16_t port,
+	SecProtocol protocol, SessionTicket* ticket)
 {
 	SocketPair sp;
 	sp.m_socket = cg::New<Socket>(__FUNCSTR__);
 	auto& sock = *sp.m_socket;
-	sock.Connect("::1", 55899);
+	sock.Connect(address, port);
 	sp.m_rw = cg::New<SocketRW>(__FUNCSTR__, &sock);
 	auto& rw = *sp.m_rw;
-	auto keys = cg::SecureHelpers::MakeRSAKeys();
-	cg::SendPublicKey(sock, keys.m_public);
-	rw.SetReaderFilter(cg::New<RSADecryptFilter>(__FUNCSTR__, keys.m_private));
-	auto key = rw.Read();
-	cg::Logger::LogWarn(3, __FUNCSTR__, "Got the aes key.");
-	CryptoPP::SecByteBlock keyBlock((const byte*)key.data(), key.size());
-	auto iv = rw.Read();
-	cg::Logger::LogWarn(3, __FUNCSTR__, "Got the aes iv.");
-	CryptoPP::SecByteBlock ivBlock((const byte*)iv.data(), iv.size());
-	rw.SetReaderFilter(cg::New<AESDecryptFilter>(__FUNCSTR__, keyBlock,
-		ivBlock));
-	rw.SetWriterFilter(cg::New<AESEncryptFilter>(__FUNCSTR__, keyBlock,
-		ivBlock));
+	CryptoPP::SecByteBlock keyBlock;
+	CryptoPP::SecByteBlock ivBlock;
+	SecCipher cipher = SecCipher::AESCTR;
+	bool resumed = false;
+	if (ticket && !ticket->Empty())
+	{
+		auto nonce = cg::SecureHelpers::GetSaltData(ms_resumeNonceSize);
+		std::string hello(1, (char)SecProtocol::Resume);
+		hello.append((const char*)nonce.data(), nonce.size());
+		hello.append(ticket->m_ticket);
+		rw.Write(hello.data(), hello.size());
+		auto reply = rw.Read();
+		if (reply.size() == ms_resumeNonceSize + 2 && reply[0] == 1)
+		{
+			CryptoPP::SecByteBlock serverNonce((const byte*)reply.data() + 1,
+				ms_resumeNonceSize);
+			cipher = (SecCipher)reply[ms_resumeNonceSize + 1];
+			DeriveSession(ticket->m_secret, nonce, serverNonce, keyBlock,
+				ivBlock, "cg::net::ISecServerMT resume");
+			resumed = true;
+			cg::Logger::LogNote(3, __FUNCSTR__, "Resumed the session.");
+		}
+		else
+		{
+			cg::Logger::LogNote(3, __FUNCSTR__, "The ticket was refused.");
+			ticket->m_ticket.clear();
+		}
+	}
+	if (!resumed && protocol == SecProtocol::X25519)
+	{
+		CryptoPP::SecByteBlock priv;
+		CryptoPP::SecByteBlock pub;
+		cg::SecureHelpers::MakeX25519Keys(priv, pub);
+		std::string hello(1, (char)SecProtocol::X25519);
+		hello.append((const char*)pub.data(), pub.size());
+		/*a trailing flag asks for a session ticket.*/
+		if (ticket)
+			hello.push_back(1);
+		rw.Write(hello.data(), hello.size());
+		auto reply = rw.Read();
+		if (reply.size() != pub.size() + 1)
+			throw EncryptionException(EncryptionException::Code::BadKey);
+		CryptoPP::SecByteBlock serverPub((const byte*)reply.data(),
+			pub.size());
+		cipher = (SecCipher)reply[pub.size()];
+		cg::Logger::LogNote(3, __FUNCSTR__, "Got the server public key.");
+		auto shared = cg::SecureHelpers::X25519Agree(priv, serverPub);
+		DeriveSession(shared, pub, serverPub, keyBlock, ivBlock);
+	}
+	else if (!resumed)
+	{
+		auto keys = cg::KeyPool::Shared().TakeRSAKeys();
+		cg::SendPublicKey(sock, keys.m_public);
+		rw.SetReaderFilter(cg::New<RSADecryptFilter>(__FUNCSTR__,
+			keys.m_private));
+		auto key = rw.Read();
+		cg::Logger::LogNote(3, __FUNCSTR__, "Got the aes key.");
+		keyBlock.Assign((const byte*)key.data(), key.size());
+		auto iv = rw.Read();
+		cg::Logger::LogNote(3, __FUNCSTR__, "Got the aes iv.");
+		ivBlock.Assign((const byte*)iv.data(), iv.size());
+		auto mode = rw.Read();
+		if (mode.size() == 1)
+			cipher = (SecCipher)mode[0];
+	}
+	auto toClient = cg::SecureHelpers::AESDirectionIv(ivBlock, true);
+	auto toServer = cg::SecureHelpers::AESDirectionIv(ivBlock, false);
+	if (cipher == SecCipher::AESGCM)
+	{
+		rw.SetReaderFilter(cg::New<AESGCMDecryptFilter>(__FUNCSTR__,
+			keyBlock, toClient));
+		rw.SetWriterFilter(cg::New<AESGCMEncryptFilter>(__FUNCSTR__,
+			keyBlock, toServer));
+	}
+	else
+	{
+		rw.SetReaderFilter(cg::New<AESDecryptFilter>(__FUNCSTR__, keyBlock,
+			toClient));
+		rw.SetWriterFilter(cg::New<AESEncryptFilter>(__FUNCSTR__, keyBlock,
+			toServer));
+	}
+	if (ticket)
+	{
+		if (resumed || protocol == SecProtocol::X25519)
+		{
+			/*the new ticket is the first thing the server sends.*/
+			auto next = rw.Read();
+			ticket->m_ticket.assign(next.data(), next.size());
+			ticket->m_secret = ResumptionSecret(keyBlock, ivBlock);
+		}
+		else
+		{
+			ticket->m_ticket.clear();
+		}
+	}
 #if _DEBUGISECSERVERMT
 	cg::Serial serial;
 	serial << std::string("Test!");
@@ -46,23 +194,314 @@ ISecServerMT::GetConnected(const std::string & address, uint16_t port)
 	return sp;
 }
 
+void ISecServerMT::Accepted(Socket * sock)
+{
+	if (!m_handshaking || m_activeHandshakes >= m_maxHandshakes)
+	{
+		cg::Logger::LogWarn(__FUNCSTR__, "Too many handshakes in flight, ",
+			"dropping a connection.");
+		DropClient(sock);
+		return;
+	}
+	if (Full())
+	{
+		cg::Logger::LogWarn(__FUNCSTR__, "The server is full, dropping a ",
+			"connection.");
+		DropClient(sock);
+		return;
+	}
+	auto hs = cg::New<Handshake>(__FUNCSTR__);
+	hs->m_sock = sock;
+	hs->m_deadline = std::chrono::steady_clock::now()
+		+ std::chrono::milliseconds(ms_handshakeTimeout);
+	++m_activeHandshakes;
+	if (!m_handshakePool.TryPost([this, hs]() { StepHandshake(hs); }))
+		FinishHandshake(hs, false);
+}
+
 bool ISecServerMT::SocketAccepted(Socket & sock)
 {
+	/*a refused ticket is followed by a full handshake, and a second refusal
+	throws, so this runs at most twice.*/
+	for (;;)
+	{
+		SocketRW rw(&sock);
+		auto hello = rw.Read();
+		if (ReadClientKey(sock, hello.data(), hello.size()))
+			break;
+	}
+	SendSession(sock);
+	return SecSocketAccepted(sock);
+}
+
+void ISecServerMT::StepHandshake(Handshake * hs)
+{
+	if (!m_handshaking || !Running())
+	{
+		FinishHandshake(hs, false);
+		return;
+	}
+	try {
+		switch (hs->m_step)
+		{
+		case HandshakeStep::WaitKey:
+			if (!ReadHello(hs))
+			{
+				/*checked even when bytes came in, so a client can not hold
+				the slot by sending a byte at a time.*/
+				if (std::chrono::steady_clock::now() > hs->m_deadline)
+				{
+					cg::Logger::LogWarn(__FUNCSTR__,
+						"A client did not send its public key in time.");
+					hs->m_step = HandshakeStep::Failed;
+				}
+				break;
+			}
+			/*a refused ticket keeps waiting for the full handshake.*/
+			if (ReadClientKey(*hs->m_sock,
+				hs->m_hello.data() + sizeof(uint64_t),
+				hs->m_hello.size() - sizeof(uint64_t)))
+				hs->m_step = HandshakeStep::SendSession;
+			hs->m_hello.clear();
+			break;
+		case HandshakeStep::SendSession:
+			SendSession(*hs->m_sock);
+			hs->m_step = HandshakeStep::Done;
+			break;
+		default:
+			break;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		cg::Logger::LogError(__FUNCSTR__, "A handshake failed: ", e.what());
+		hs->m_step = HandshakeStep::Failed;
+	}
+	if (hs->m_step == HandshakeStep::Done
+		|| hs->m_step == HandshakeStep::Failed)
+	{
+		FinishHandshake(hs, hs->m_step == HandshakeStep::Done);
+		return;
+	}
+	/*go to the back of the queue so the other handshakes get a turn.*/
+	if (!m_handshakePool.TryPost([this, hs]() { StepHandshake(hs); }))
+		FinishHandshake(hs, false);
+}
+
+bool ISecServerMT::ReadHello(Handshake * hs)
+{
+	auto& in = hs->m_hello;
+	/*only the first wait uses the poll time, so a client that trickles bytes
+	still gives the thread back after one step.*/
+	std::ptrdiff_t poll = ms_handshakePoll;
+	for (;;)
+	{
+		/*the size comes first, as SocketRW writes it.*/
+		std::size_t want = sizeof(uint64_t);
+		if (in.size() >= want)
+		{
+			uint64_t size;
+			std::memcpy(&size, in.data(), sizeof(size));
+			if (size > ms_maxHello)
+				throw EncryptionException(EncryptionException::Code::BadKey);
+			want += (std::size_t)size;
+			if (in.size() == want)
+				return true;
+		}
+		if (!hs->m_sock->ReadReady(poll))
+			return false;
+		poll = 0;
+		char buf[512];
+		std::size_t amt = want - in.size();
+		if (amt > sizeof(buf))
+			amt = sizeof(buf);
+		auto got = hs->m_sock->Recv(buf, amt, false);
+		/*it was ready, so nothing to read means the client is gone.*/
+		if (got <= 0)
+			throw NetworkException(Error::NotConnected);
+		in.append(buf, (std::size_t)got);
+	}
+}
+
+void ISecServerMT::FinishHandshake(Handshake * hs, bool ok)
+{
+	auto sock = hs->m_sock;
+	cg::Delete(__FUNCSTR__, hs);
+	bool keep = false;
+	if (ok && m_handshaking && Running())
+	{
+		try {
+			keep = SecSocketAccepted(*sock);
+		}
+		catch (const std::exception& e)
+		{
+			cg::Logger::LogError(__FUNCSTR__, "SecSocketAccepted threw: ",
+				e.what());
+		}
+	}
+	if (keep)
+	{
+		/*if the server filled up during the handshake this closes it through
+		SocketClosed, which also lets go of the client descriptor.*/
+		AddClient(sock);
+	}
+	else
+	{
+		m_secClients.Erase(sock->Id());
+		DropClient(sock);
+	}
+	--m_activeHandshakes;
+}
+
+bool ISecServerMT::ReadClientKey(Socket & sock, const char* hello,
+	std::size_t size)
+{
+	/*map nodes do not move, and nothing else touches this client until it is
+	added to the client list, so the lock is only needed for the insert.*/
+	ClientDescriptor& cd = m_secClients.GetOrAdd(sock.Id());
+	cd.socket = &sock;
 	SocketRW rw(&sock);
-	auto cdl = m_secClients.Writer();
-	ClientDescriptor& cd = cdl->operator[](sock.Id());
-	cg::GetPublicKey(sock, cd.m_rsaPub);
+	const std::size_t keySize = cg::SecureHelpers::ms_x25519KeySize;
+	/*an RSA key is DER encoded and always starts with a SEQUENCE tag, so it
+	can not be mistaken for the X25519 or resume tags.*/
+	if (size > ms_resumeNonceSize + 1
+		&& hello[0] == (char)SecProtocol::Resume)
+	{
+		if (cd.m_resumeRefused)
+			throw EncryptionException(EncryptionException::Code::BadKey);
+		const char* sealed = hello + 1 + ms_resumeNonceSize;
+		std::size_t sealedSize = size - 1 - ms_resumeNonceSize;
+		if (!m_tickets.Open(sealed, sealedSize, cd.m_resumeSecret))
+		{
+			cd.m_resumeRefused = true;
+			char refused = 0;
+			rw.Write(&refused, 1);
+			cg::Logger::LogNote(3, __FUNCSTR__, "Refused a session ticket.");
+			return false;
+		}
+		cd.m_protocol = SecProtocol::Resume;
+		cd.m_peerKey.Assign((const byte*)hello + 1,
+			ms_resumeNonceSize);
+		cd.m_wantsTicket = true;
+		cg::Logger::LogNote(3, __FUNCSTR__, "Got a session ticket.");
+		return true;
+	}
+	if ((size == keySize + 1 || size == keySize + 2)
+		&& hello[0] == (char)SecProtocol::X25519)
+	{
+		cd.m_protocol = SecProtocol::X25519;
+		cd.m_peerKey.Assign((const byte*)hello + 1, keySize);
+		cd.m_wantsTicket = size == keySize + 2
+			&& (hello[keySize + 1] & 1);
+		cg::Logger::LogNote(3, __FUNCSTR__, "Got the X25519 public key.");
+		return true;
+	}
+	if (m_minProtocol > SecProtocol::RSA)
+		throw EncryptionException(EncryptionException::Code::BadKey);
+	cd.m_protocol = SecProtocol::RSA;
+	CryptoPP::ArraySource as((const byte*)hello, size, true);
+	cd.m_rsaPub.Load(as);
+	/*a key that loads can still be malformed or weak.*/
+	CryptoPP::AutoSeededRandomPool rng;
+	if (!cd.m_rsaPub.Validate(rng, 3))
+		throw EncryptionException(EncryptionException::Code::BadKey);
 	cg::Logger::LogNote(3, __FUNCSTR__, "Got the public key.");
-	rw.SetWriterFilter(cg::New<RSAEncryptFilter>(__FUNCSTR__, cd.m_rsaPub));
-	cd.m_aesKey = cg::SecureHelpers::MakeAESKey();
-	cd.m_aesIv = cg::SecureHelpers::MakeAESIv();
+	return true;
+}
+
+void ISecServerMT::SendSession(Socket & sock)
+{
+	ClientDescriptor& cd = m_secClients.At(sock.Id());
+	SocketRW rw(&sock);
+	cd.m_cipher = m_cipher;
+	char mode = (char)cd.m_cipher;
+	if (cd.m_protocol == SecProtocol::Resume)
+	{
+		auto nonce = cg::SecureHelpers::GetSaltData(ms_resumeNonceSize);
+		DeriveSession(cd.m_resumeSecret, cd.m_peerKey, nonce, cd.m_aesKey,
+			cd.m_aesIv, "cg::net::ISecServerMT resume");
+		std::string reply(1, (char)1);
+		reply.append((const char*)nonce.data(), nonce.size());
+		reply.push_back(mode);
+		rw.Write(reply.data(), reply.size());
+		cg::Logger::LogNote(3, __FUNCSTR__, "Resumed a session.");
+	}
+	else if (cd.m_protocol == SecProtocol::X25519)
+	{
+		CryptoPP::SecByteBlock priv;
+		CryptoPP::SecByteBlock pub;
+		cg::SecureHelpers::MakeX25519Keys(priv, pub);
+		auto shared = cg::SecureHelpers::X25519Agree(priv, cd.m_peerKey);
+		DeriveSession(shared, cd.m_peerKey, pub, cd.m_aesKey, cd.m_aesIv);
+		std::string reply((const char*)pub.data(), pub.size());
+		reply.push_back(mode);
+		rw.Write(reply.data(), reply.size());
+		cg::Logger::LogNote(3, __FUNCSTR__,
+			"sent the X25519 key and session cipher.");
+	}
+	else
+	{
+		rw.SetWriterFilter(cg::New<RSAEncryptFilter>(__FUNCSTR__,
+			cd.m_rsaPub));
+		cd.m_aesKey = cg::KeyPool::Shared().TakeAESKey();
+		cd.m_aesIv = cg::KeyPool::Shared().TakeAESIv();
+		rw.Write((char*)cd.m_aesKey.data(), cd.m_aesKey.size());
+		cg::Logger::LogNote(3, __FUNCSTR__, "sent the aes key.");
+		rw.Write((char*)cd.m_aesIv.data(), cd.m_aesIv.size());
+		cg::Logger::LogNote(3, __FUNCSTR__, "sent the aes iv.");
+		rw.Write(&mode, 1);
+		cg::Logger::LogNote(3, __FUNCSTR__, "sent the session cipher.");
+	}
 	auto& aesKey = cd.m_aesKey;
 	auto& aesIv = cd.m_aesIv;
-	rw.Write((char*)aesKey.data(), aesKey.size());
-	cg::Logger::LogNote(3, __FUNCSTR__, "sent the aes key.");
-	rw.Write((char*)aesIv.data(), aesIv.size());
-	cg::Logger::LogNote(3, __FUNCSTR__, "sent the aes iv.");
-	return SecSocketAccepted(sock);
+	auto toClient = cg::SecureHelpers::AESDirectionIv(aesIv, true);
+	auto toServer = cg::SecureHelpers::AESDirectionIv(aesIv, false);
+	if (cd.m_cipher == SecCipher::AESGCM)
+	{
+		cd.m_gcmEncryptor.Key(aesKey, toClient);
+		cd.m_gcmDecryptor.Key(aesKey, toServer);
+	}
+	else
+	{
+		cd.m_encryptor.SetKeyWithIV(aesKey, aesKey.size(), toClient,
+			toClient.size());
+		cd.m_decryptor.SetKeyWithIV(aesKey, aesKey.size(), toServer,
+			toServer.size());
+	}
+	if (cd.m_wantsTicket)
+	{
+		auto sealed = m_tickets.Seal(ResumptionSecret(aesKey, aesIv));
+		GetSocketRW(sock).Write(sealed.data(), sealed.size());
+		cg::Logger::LogNote(3, __FUNCSTR__, "sent a session ticket.");
+	}
+}
+
+void ISecServerMT::DeriveSession(const CryptoPP::SecByteBlock & shared,
+	const CryptoPP::SecByteBlock & clientPub,
+	const CryptoPP::SecByteBlock & serverPub,
+	CryptoPP::SecByteBlock & key,
+	CryptoPP::SecByteBlock & iv,
+	const std::string& info)
+{
+	CryptoPP::SecByteBlock salt(clientPub.size() + serverPub.size());
+	std::memcpy(salt.data(), clientPub.data(), clientPub.size());
+	std::memcpy(salt.data() + clientPub.size(), serverPub.data(),
+		serverPub.size());
+	auto okm = cg::SecureHelpers::DeriveKey(shared, salt, info,
+		cg::SecureHelpers::ms_defaultAesKeySize
+		+ cg::SecureHelpers::ms_defaultIvSize);
+	key.Assign(okm.data(), cg::SecureHelpers::ms_defaultAesKeySize);
+	iv.Assign(okm.data() + cg::SecureHelpers::ms_defaultAesKeySize,
+		cg::SecureHelpers::ms_defaultIvSize);
+}
+
+CryptoPP::SecByteBlock ISecServerMT::ResumptionSecret(
+	const CryptoPP::SecByteBlock & key,
+	const CryptoPP::SecByteBlock & iv)
+{
+	return cg::SecureHelpers::DeriveKey(key, iv,
+		"cg::net::ISecServerMT resumption",
+		cg::SecureHelpers::ms_defaultAesKeySize);
 }
 
 bool ISecServerMT::ProcessSocket(Socket & sock)
@@ -73,14 +512,14 @@ bool ISecServerMT::ProcessSocket(Socket & sock)
 void ISecServerMT::SocketClosed(Socket & sock,
 	bool grace)
 {
-	m_secClients.Writer()->erase(sock.Id());
+	m_secClients.Erase(sock.Id());
 	return SecSocketClosed(sock, grace);
 }
 
 const ClientDescriptor &
 ISecServerMT::GetClientDescriptor(const Socket& sock)
 {
-	return m_secClients.Writer()->at(sock.Id());
+	return m_secClients.At(sock.Id());
 }
 
 }
@@ -1,12 +1,17 @@
 #pragma once
 
-#include <map>
+#include <chrono>
 
 #include "IServerMT.hpp"
+#include "../ConcurrentMap.hpp"
+#include "../Executor.hpp"
 #include "../Serial.hpp"
 #include "../crypto/AESFilter.hpp"
+#include "../crypto/GCMFilter.hpp"
+#include "../crypto/KeyPool.hpp"
 #include "../crypto/RSAExchange.hpp"
 #include "../crypto/RSAFilter.hpp"
+#include "../crypto/SessionTicket.hpp"
 
 #define _DEBUGISECSERVERMT _DEBUG && 1
 
@@ -31,6 +36,42 @@ struct SocketPair
 	}
 };
 
+/**What a client keeps to resume a session with a ISecServerMT later.*/
+struct SessionTicket
+{
+	/**The ticket as the server sent it. The client can not read it.*/
+	std::string m_ticket;
+	/**The resumption secret sealed in the ticket.*/
+	CryptoPP::SecByteBlock m_secret;
+	/**Determine if there is a ticket to present.
+	\return True if there is no ticket.*/
+	bool Empty() const { return m_ticket.empty(); }
+};
+
+/**The session cipher a secure server uses after the key exchange.*/
+enum class SecCipher : uint8_t
+{
+	/**AES in CTR mode. Confidentiality only.*/
+	AESCTR = 0,
+	/**AES in GCM mode. Confidentiality and integrity in one pass.*/
+	AESGCM = 1,
+};
+
+/**The key exchange a client opens a secure connection with.*/
+enum class SecProtocol : uint8_t
+{
+	/**The client sends an RSA public key and the server sends the session
+	key and iv RSA encrypted.*/
+	RSA = 0,
+	/**The client and server swap X25519 public keys and both derive the
+	session key and iv with HKDF.  Much cheaper than making RSA keys.*/
+	X25519 = 1,
+	/**The client presents a session ticket and a nonce, the server answers
+	with its own nonce, and both sides derive the session key and iv from the
+	resumption secret in the ticket.  No public key work at all.*/
+	Resume = 2,
+};
+
 class ClientDescriptor
 {
 public:
@@ -42,16 +83,84 @@ public:
 	CryptoPP::SecByteBlock m_aesIv;
 	/**The RSA public key from the client.*/
 	CryptoPP::RSA::PublicKey m_rsaPub;
+	/**The cipher for data sent to the client. It is keyed once and its
+	counter runs for the life of the connection.*/
+	cg::AESEncryptFilter::Cipher m_encryptor;
+	/**The cipher for data received from the client.*/
+	cg::AESDecryptFilter::Cipher m_decryptor;
+	/**The key exchange the client opened with.*/
+	SecProtocol m_protocol = SecProtocol::RSA;
+	/**The X25519 public key from the client, or its nonce when resuming.*/
+	CryptoPP::SecByteBlock m_peerKey;
+	/**The resumption secret from the ticket the client presented.*/
+	CryptoPP::SecByteBlock m_resumeSecret;
+	/**True if the client asked for a session ticket.*/
+	bool m_wantsTicket = false;
+	/**True once a ticket from this client was refused. It only gets one.*/
+	bool m_resumeRefused = false;
+	/**The session cipher picked for this client.*/
+	SecCipher m_cipher = SecCipher::AESCTR;
+	/**The GCM context for data sent to the client.*/
+	cg::AESGCMEncryptFilter::Context m_gcmEncryptor;
+	/**The GCM context for data received from the client.*/
+	cg::AESGCMDecryptFilter::Context m_gcmDecryptor;
 };
 /**Create a secure server. Clients are expected to immediatly send an RSA
-public key and then an AES key.*/
+public key.  The server answers with the AES key, the IV and the session
+cipher, all RSA encrypted.  Clients may instead open with the X25519 tag and
+a public key, in which case the server answers with its own public key and
+the session cipher, and both sides derive the AES key and IV.  Those clients
+may ask for a session ticket, which is sent as the first encrypted message
+and lets them skip the key exchange when they reconnect.
+
+The accept thread only accepts.  Each handshake is a small state machine that
+is stepped on a handshake pool.  A step only reads what has already arrived
+and keeps it with the handshake, so a slow client only costs a pool slot while
+it has data ready, and a client that has not sent its whole opening message by
+the deadline is dropped.  The amount of handshakes in flight is capped, and no
+handshake is started while the server is full.*/
 class ISecServerMT : public IServerMT
 {
 public:
+	/**Create the server.
+	\param dataThreads The amount of threads that will receive and process
+	data from the clients.
+	\param cipher The session cipher new clients will use.
+	\param handshakeThreads The amount of threads that run handshakes.
+	\param maxHandshakes The max amount of handshakes in flight. Connections
+	accepted past this are closed right away.
+	\param maxClients The most clients that can be connected at once.
+	Connections accepted while the server is full are closed before the
+	handshake.*/
+	ISecServerMT(int dataThreads = 5, SecCipher cipher = SecCipher::AESCTR,
+		std::size_t handshakeThreads = 2, std::size_t maxHandshakes = 64,
+		std::size_t maxClients = 4096);
 	/**Destroy*/
 	virtual ~ISecServerMT();
+	/**Stop the server.  Handshakes in flight are dropped and waited for
+	first, so none can add a client after the client list is closed.*/
+	void Stop() override;
+	/**Change the session cipher for clients accepted from now on.
+	\param cipher The cipher to use.*/
+	void SessionCipher(SecCipher cipher);
+	/**Get the session cipher new clients will use.
+	\return The cipher.*/
+	SecCipher SessionCipher() const;
+	/**Set the oldest key exchange clients may open with. Clients using an
+	older one are dropped during the handshake.
+	\param protocol The oldest protocol to allow.*/
+	void MinProtocol(SecProtocol protocol);
+	/**Get the oldest key exchange clients may open with.
+	\return The protocol.*/
+	SecProtocol MinProtocol() const;
+	/**Get the keys session tickets are sealed with, to change the lifetime or
+	force a rotation.
+	\return The ticket keys.*/
+	cg::SessionTicketKeys& TicketKeys();
 	/**Do something after a socket is excepted.  Will run after the security
-	protocols have run on top of the IServerMT.
+	protocols have run on top of the IServerMT, on a handshake thread.  A
+	derived server should Stop() in its own destructor so no handshake can
+	call this after it is gone.
 	\param sock The socket that was excepted.*/
 	virtual bool SecSocketAccepted(cg::net::Socket& sock) = 0;
 	/**Do stuff on a socket that has data ready. Data should be accessed via a
@@ -70,17 +179,119 @@ public:
 	client.*/
 	cg::net::SocketRW GetSocketRW(cg::net::Socket& sock);
 	/**Get a connected socket and writer.
+	\param address The address of the server.
+	\param port The port the server listens on.
+	\param protocol The key exchange to open with if there is no ticket or
+	the server refuses it.
+	\param ticket If not null, a ticket to resume with.  It is replaced with
+	the new ticket the server sends, or emptied if none was sent.  Tickets are
+	only sent for X25519 and resumed sessions.
 	\return A socket pointer and SocketRW setup to send and receive data from
 	this server.*/
-	static SocketPair GetConnected(const std::string& address, uint16_t port);
+	static SocketPair GetConnected(const std::string& address, uint16_t port,
+		SecProtocol protocol = SecProtocol::X25519,
+		SessionTicket* ticket = nullptr);
+	/**The amount of handshakes in flight.
+	\return The amount of accepted sockets that are not clients yet.*/
+	std::size_t PendingHandshakes() const;
+	/**How long a client has to send its opening message, in milliseconds.*/
+	const static std::size_t ms_handshakeTimeout = 10000;
+	/**How long a handshake step waits on a quiet socket before giving the
+	other handshakes a turn, in microseconds.*/
+	const static std::ptrdiff_t ms_handshakePoll = 10000;
+	/**The largest opening message a client may send, in bytes.*/
+	const static std::size_t ms_maxHello = 4096;
 private:
-	/**The type of map used for the client descriptor.*/
-	using CDMap = std::map<std::size_t, ClientDescriptor>;
-	/**Do somthing on a socket right after it gets accepted.
+	/**The type of map used for the client descriptor.  Lookups by the data
+	threads only take a shared lock on one shard.*/
+	using CDMap = cg::ConcurrentMap<std::size_t, ClientDescriptor>;
+	/**The steps of a server side handshake.*/
+	enum class HandshakeStep : uint8_t
+	{
+		/**Waiting for the client public key.*/
+		WaitKey,
+		/**Sending the session key, iv and cipher.*/
+		SendSession,
+		/**Done, the socket can become a client.*/
+		Done,
+		/**Failed or timed out, the socket will be dropped.*/
+		Failed,
+	};
+	/**A handshake in flight.*/
+	struct Handshake
+	{
+		/**The socket being shaken. Owned by the handshake until it is done.*/
+		cg::net::Socket* m_sock = nullptr;
+		/**The next step to run.*/
+		HandshakeStep m_step = HandshakeStep::WaitKey;
+		/**When the handshake gives up waiting on the client.*/
+		std::chrono::steady_clock::time_point m_deadline;
+		/**The part of the opening message read so far, with its size.*/
+		std::string m_hello;
+	};
+	/**Start a handshake for a socket that was just accepted.
+	\param sock The socket that was just accepted.*/
+	void Accepted(cg::net::Socket* sock);
+	/**Run the whole handshake on the calling thread.
 	\param sock The socket that was just accepted.
 	\return True if the socket should stay in the list. False if it should be
 	closed and removed.*/
 	bool SocketAccepted(cg::net::Socket& sock);
+	/**Run the next step of a handshake and queue the one after it.
+	\param hs The handshake to step.*/
+	void StepHandshake(Handshake* hs);
+	/**Read what has arrived of the opening message of a client, without
+	blocking.
+	\param hs The handshake to read for.
+	\return True once the whole message is in hs->m_hello.
+	\throws cg::net::NetworkException NotConnected if the client closed the
+	socket, or sent nothing after it was reported ready.
+	\throws cg::EncryptionException BadKey if the message is bigger than
+	ms_maxHello.*/
+	bool ReadHello(Handshake* hs);
+	/**End a handshake and either add its socket to the clients or drop it.
+	\param hs The handshake to end. It is deleted.
+	\param ok True if the handshake went through.*/
+	void FinishHandshake(Handshake* hs, bool ok);
+	/**Read the opening message of a client into its descriptor.
+	\param sock The socket of the client.
+	\param hello The message, without its size.
+	\param size The size of the message.
+	\return False if the client presented a ticket that was refused.  The
+	client will follow up with a full handshake.
+	\throws cg::EncryptionException BadKey if the client used a protocol
+	older than MinProtocol, a second ticket after one was refused, or an RSA
+	key that does not validate.*/
+	bool ReadClientKey(cg::net::Socket& sock, const char* hello,
+		std::size_t size);
+	/**Make or agree on the session key and iv, send the client what it needs
+	and key the descriptor.
+	\param sock The socket of the client.*/
+	void SendSession(cg::net::Socket& sock);
+	/**Derive the session key and iv from an X25519 shared secret.  Both
+	public keys are mixed in so each side derives the same bytes.
+	\param shared The shared secret.
+	\param clientPub The public key of the client.
+	\param serverPub The public key of the server.
+	\param key Will hold the AES key.
+	\param iv Will hold the AES iv.
+	\param info What the session is derived for.*/
+	static void DeriveSession(const CryptoPP::SecByteBlock& shared,
+		const CryptoPP::SecByteBlock& clientPub,
+		const CryptoPP::SecByteBlock& serverPub,
+		CryptoPP::SecByteBlock& key,
+		CryptoPP::SecByteBlock& iv,
+		const std::string& info = "cg::net::ISecServerMT session");
+	/**Derive the secret a session ticket resumes from.  Both sides can work
+	it out from the session key and iv, so it is never sent in the clear.
+	\param key The session AES key.
+	\param iv The session AES iv.
+	\return The resumption secret.*/
+	static CryptoPP::SecByteBlock ResumptionSecret(
+		const CryptoPP::SecByteBlock& key,
+		const CryptoPP::SecByteBlock& iv);
+	/**The size of the nonces swapped when resuming.*/
+	const static std::size_t ms_resumeNonceSize = 32;
 	/**Process a ready socket.
 	\param sock The socket that was reported ready
 	\return True if the socket should stay active, false if it should be
@@ -98,7 +309,21 @@ private:
 		GetClientDescriptor(const cg::net::Socket& sock);
 
 	/**A list of client descriptors.*/
-	cg::LockBox<CDMap> m_secClients;
+	CDMap m_secClients;
+	/**The session cipher for new clients.*/
+	std::atomic<SecCipher> m_cipher;
+	/**The oldest key exchange clients may open with.*/
+	std::atomic<SecProtocol> m_minProtocol;
+	/**The keys for session tickets.*/
+	cg::SessionTicketKeys m_tickets;
+	/**The max amount of handshakes in flight.*/
+	std::size_t m_maxHandshakes;
+	/**The amount of handshakes in flight.*/
+	std::atomic<std::size_t> m_activeHandshakes;
+	/**False once the server is going away.*/
+	std::atomic_bool m_handshaking;
+	/**The threads that step the handshakes.*/
+	cg::Executor m_handshakePool;
 };
 
 }
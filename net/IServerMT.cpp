@@ -6,10 +6,12 @@ namespace net {
 
 
 
-IServerMT::IServerMT(int dataThreads)
-	:m_dataThreadCount(dataThreads)
+IServerMT::IServerMT(int dataThreads, std::size_t maxClients)
+	:m_clientQueue(maxClients), m_readyQueue(maxClients),
+	m_maxClients(maxClients), m_dataThreadCount(dataThreads)
 {
 	m_run = false;
+	m_clientCount = 0;
 }
 
 IServerMT::~IServerMT()
@@ -50,8 +52,8 @@ void IServerMT::Start(uint16_t port)
 void IServerMT::Stop()
 {
 	m_run = false;
-	m_readyBox.NotifyAll();
-	m_clientBox.NotifyAll();
+	m_readyQueue.NotifyAll();
+	m_clientQueue.NotifyAll();
 	CloseAll();
 	WaitForThreads();
 	m_serverStopped = true;
@@ -65,8 +67,44 @@ void IServerMT::Wait()
 
 void IServerMT::NotifyAllThreads()
 {
-	m_readyBox.Notify();
-	m_clientBox.Notify();
+	m_readyQueue.Notify();
+	m_clientQueue.Notify();
+}
+
+void IServerMT::Accepted(Socket * sock)
+{
+	if (!Full() && SocketAccepted(*sock))
+		AddClient(sock);
+	else
+		DropClient(sock);
+}
+
+void IServerMT::AddClient(Socket * sock)
+{
+	if (m_clientCount.fetch_add(1) < m_maxClients
+		&& m_clientQueue.TryPush(sock))
+		return;
+	--m_clientCount;
+	/*it was accepted, so it gets closed like a client would.*/
+	sock->Close();
+	SocketClosed(*sock, false);
+	cg::Delete(__FUNCSTR__, sock);
+}
+
+void IServerMT::DropClient(Socket * sock)
+{
+	sock->Close();
+	cg::Delete(__FUNCSTR__, sock);
+}
+
+bool IServerMT::Full() const
+{
+	return m_clientCount >= m_maxClients;
+}
+
+bool IServerMT::Running() const
+{
+	return m_run;
 }
 
 void IServerMT::ChangeAcceptorSpeed(double fps)
@@ -85,21 +123,24 @@ void IServerMT::DataLoop()
 	while (m_run)
 	{
 		/*will wait for elements.*/
-		m_readyBox.WaitForElements(std::ref(m_run));
+		m_readyQueue.WaitForElements(std::ref(m_run));
 		cg::net::Socket* sock = nullptr;
-		auto writer = m_readyBox.Writer();
-		if (writer->size() == 0)
+		if (!m_readyQueue.TryPop(sock))
 			continue;
-		sock = *writer->begin();
-		writer->pop_front();
-		if (sock->IsOpen() != 1)
+		int open = sock->IsOpen();
+		if (open != 1)
 		{
+			/*it closed after the scanner saw it ready, do not touch it again
+			after it is gone.*/
+			SocketClosed(*sock, open == 0 ? true : false);
 			cg::Delete(__FUNCSTR__,sock);
+			--m_clientCount;
+			continue;
 		}
 		/*sock should be ready beause it was in the ready list.*/
 		ProcessSocket(*sock);
-		/*put it back into the client box.*/
-		m_clientBox.Writer()->push_back(sock);
+		/*hand it back to the scanner. It was counted, so it fits.*/
+		m_clientQueue.TryPush(sock);
 	}
 	--m_activeDataThreads;
 }
@@ -119,28 +160,19 @@ void IServerMT::CloseAll()
 		c = m_activeDataThreads == 0;
 	}
 
-	if (m_clientBox.Size() == 0)
-		return;
+	/*the threads are stopped, so every socket is in a queue or the list.*/
+	cg::net::Socket* sock = nullptr;
+	while (m_clientQueue.TryPop(sock))
+		m_clients.push_back(sock);
+	while (m_readyQueue.TryPop(sock))
+		m_clients.push_back(sock);
+	for (auto s : m_clients)
 	{
-		auto writer = m_clientBox.Writer();
-		auto it = writer->begin();
-		auto end = writer->end();
-		for (; it != end; ++it)
-		{
-			(*it)->Close();
-			cg::Delete(__FUNCSTR__,*it);
-		}
-	}
-	{
-		auto writer = m_readyBox.Writer();
-		auto it = writer->begin();
-		auto end = writer->end();
-		for (; it != end; ++it)
-		{
-			(*it)->Close();
-			cg::Delete(__FUNCSTR__,*it);
-		}
+		s->Close();
+		cg::Delete(__FUNCSTR__, s);
 	}
+	m_clients.clear();
+	m_clientCount = 0;
 }
 
 void IServerMT::WaitForThreads()
@@ -178,37 +210,31 @@ void IServerMT::ScanForReadyLoop()
 {
 	while (m_run)
 	{
-		/*will wait for elements.*/
 		m_readyLimit();
-		auto writer = m_clientBox.Writer();
-		if (writer->empty())
-			continue;
-		auto it = writer->begin();
-		auto end = writer->end();
-		for (; it != end; ++it)
+		/*take in the new clients and the ones the data threads are done
+		with.*/
+		cg::net::Socket* sock = nullptr;
+		while (m_clientQueue.TryPop(sock))
+			m_clients.push_back(sock);
+		std::size_t i = 0;
+		while (i < m_clients.size())
 		{
-			int open = (*it)->IsOpen();
+			sock = m_clients[i];
+			int open = sock->IsOpen();
 			if (open != 1)
 			{
-				SocketClosed(**it, open == 0 ? true : false);
-				it = writer->erase(it);
-				if (it == end)
-					/*If it was the last thing in the list, it now equals .end
-					and we will break instead of trying to increment it.*/
-					break;
-				else
-					continue;
+				SocketClosed(*sock, open == 0 ? true : false);
+				cg::Delete(__FUNCSTR__, sock);
+				--m_clientCount;
 			}
-			if ((*it)->ReadReady())
+			else if (!sock->ReadReady() || !m_readyQueue.TryPush(sock))
 			{
-				m_readyBox.Writer()->push_back(*it);
-				it = writer->erase(it);
-				m_readyBox.Notify();
-				if (it == end)
-					/*If it was the last thing in the list, it now equals .end
-					and we will break instead of trying to increment it.*/
-					break;
+				++i;
+				continue;
 			}
+			/*the order does not matter, so fill the hole with the last one.*/
+			m_clients[i] = m_clients.back();
+			m_clients.pop_back();
 		}
 	}
 	m_readyScannerStopped = true;
@@ -221,13 +247,13 @@ void IServerMT::AcceptLoop()
 		m_acceptorLimit();
 		while (m_serverSocket.ReadReady())
 		{
-			auto writer = m_clientBox.Writer();
 			auto sock = cg::New<cg::net::Socket>(__FUNCSTR__);
 			auto accepted = m_serverSocket.Accept(*sock, false);
 			if (accepted)
 			{
-				SocketAccepted(*sock);
-				writer->push_back(sock);
+				/*the client list is not locked here, so a slow hand off will
+				not hold up the scanner.*/
+				Accepted(sock);
 			}
 			else
 			{
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <vector>
+
 #include "SocketRW.hpp"
 #include "../Timer.hpp"
 #include "../LockBox.hpp"
+#include "../MPMCQueue.hpp"
 #include "../Memory.hpp"
 
 namespace cg {
@@ -12,18 +15,20 @@ class IServerMT : public NetworkObject
 {
 public:
 	/**The type of list for the clients.*/
-	using ClientList = std::list<cg::net::Socket*>;
+	using ClientList = std::vector<cg::net::Socket*>;
 	/**Default construct
 	\param dataThreads The amount of threads that will receive and process
-	data from the clients.*/
-	IServerMT(int dataThreads = 5);
+	data from the clients.
+	\param maxClients The most clients that can be connected at once. The
+	queues that pass sockets between threads are made this big up front.*/
+	IServerMT(int dataThreads = 5, std::size_t maxClients = 4096);
 	/**Virt decon*/
 	virtual ~IServerMT();
 	/**Start the server.
 	\param port The port to start on.*/
 	void Start(uint16_t port);
 	/**Stop the server and wait for all the threads to stop.*/
-	void Stop();
+	virtual void Stop();
 	/**Wait untill the server stops on its own.*/
 	void Wait();
 	/**Notify all waiting things managed by this server.*/
@@ -51,6 +56,29 @@ protected:
 	\return True if the socket should stay in the list. False if it should be
 	closed and removed.*/
 	virtual bool SocketAccepted(cg::net::Socket& sock) = 0;
+	/**Hand off a socket that was just accepted.  The default runs 
+	SocketAccepted on the accept thread and adds the socket to the client list
+	if it returned true.  Override it to run slow per-connection setup on some
+	other thread. The override owns the socket and must finish with AddClient
+	or DropClient.
+	\param sock The socket that was just accepted.*/
+	virtual void Accepted(cg::net::Socket* sock);
+	/**Add an accepted socket to the client list so it gets scanned for data.
+	If the server filled up since the socket was accepted, it goes through
+	SocketClosed and is deleted, like any other accepted client.
+	\param sock The socket to add. The server owns it from now on.*/
+	void AddClient(cg::net::Socket* sock);
+	/**Close and delete a socket that never made it into the client list.
+	\param sock The socket to drop.*/
+	void DropClient(cg::net::Socket* sock);
+	/**Determine if the server has as many clients as it can hold.  Checked
+	before a socket is accepted, so no setup is wasted on one that would be
+	dropped anyway.
+	\return True if the server has maxClients clients.*/
+	bool Full() const;
+	/**Determine if the server is running.
+	\return True if the server is running.*/
+	bool Running() const;
 	/**Process a ready socket.
 	\param sock The socket that was reported ready
 	\return True if the socket should stay active, false if it should be
@@ -73,10 +101,19 @@ private:
 	/**The speed of the ready scanning loop. 100 is usually good unless it must
 	be faster (in FPS).*/
 	cg::SpeedLimit m_readyLimit;
-	/**The locked access box for the clients list.*/
-	cg::LockBox<ClientList> m_clientBox;
-	/**The locked access box for the ready list.*/
-	cg::LockBox<ClientList> m_readyBox;
+	/**Sockets on their way to the scanner: new clients, and clients that a
+	data thread is done with.*/
+	cg::MPMCQueue<cg::net::Socket*> m_clientQueue;
+	/**Sockets the scanner found ready, on their way to the data threads.*/
+	cg::MPMCQueue<cg::net::Socket*> m_readyQueue;
+	/**The clients waiting for data. Only the scanner thread touches it while
+	the server runs.*/
+	ClientList m_clients;
+	/**The most clients at once.  Every client is in one place at a time, so
+	neither queue can ever hold more than this.*/
+	std::size_t m_maxClients;
+	/**The amount of clients.*/
+	std::atomic<std::size_t> m_clientCount;
 	/**The initial server socket.*/
 	cg::net::Socket m_serverSocket;
 	/**The master loop controller.*/